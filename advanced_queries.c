@@ -1,6 +1,12 @@
 #include "advanced_queries.h"
+#include "bptree.h"
+#include "key_index.h"
+#include "station_columns.h"
+#include "geo_index.h"
 #include <stdlib.h>
+#include <string.h>
 #include <stdio.h>
+#include <limits.h>
 
 /*
  * ============================================================================
@@ -38,12 +44,276 @@ int si_range_ids(StationNode* r, int lo, int hi, int* out, int cap) {
     return range_rec(r, lo, hi, out, cap, 0);
 }
 
+int si_range_ids_idx(const StationIndex* idx, int lo, int hi, int* out, int cap) {
+    if (!out || cap <= 0) return 0;
+    if (idx->backend == SI_BACKEND_BPTREE) {
+        return idx->bp ? bp_range_ids(idx->bp, lo, hi, out, cap) : 0;
+    }
+    return si_range_ids(idx->root, lo, hi, out, cap);
+}
+
+/*
+ * Requêtes multi-plages : les plages sont triées et fusionnées (chevauchement
+ * ou contiguïté) en intervalles disjoints, puis un seul parcours ordonné de
+ * l'index écrit l'union dans l'arène. Les résultats d'une plage forment une
+ * tranche contiguë de cette union triée : les plages qui se recouvrent
+ * partagent leurs IDs dans l'arène, et aucun nœud n'est visité deux fois.
+ */
+
+/*
+ * Sortie du parcours : arène partagée, IDs comptés au-delà de sa capacité
+ */
+typedef struct {
+    int* arena;
+    int cap;
+    int written;
+    int total;
+} SweepOut;
+
+static void sweep_emit(SweepOut* o, int id) {
+    if (o->written < o->cap) o->arena[o->written++] = id;
+    o->total++;
+}
+
+/*
+ * Fonction auxiliaire : comparaison de plages (lo croissant)
+ */
+static int compare_ranges(const void* a, const void* b) {
+    const SiRange* ra = (const SiRange*)a;
+    const SiRange* rb = (const SiRange*)b;
+    if (ra->lo != rb->lo) return ra->lo < rb->lo ? -1 : 1;
+    return (ra->hi > rb->hi) - (ra->hi < rb->hi);
+}
+
+/*
+ * Fonctions auxiliaires : premier intervalle de [a, b) dont lo >= x / hi >= x
+ * (intervalles disjoints triés : lo et hi croissants)
+ */
+static int first_lo_ge(const SiRange* iv, int a, int b, int x) {
+    while (a < b) {
+        int m = a + (b - a) / 2;
+        if (iv[m].lo < x) a = m + 1; else b = m;
+    }
+    return a;
+}
+
+static int first_hi_ge(const SiRange* iv, int a, int b, int x) {
+    while (a < b) {
+        int m = a + (b - a) / 2;
+        if (iv[m].hi < x) a = m + 1; else b = m;
+    }
+    return a;
+}
+
+/*
+ * Fonction auxiliaire récursive : parcours AVL d'un seul intervalle
+ * (élagage comme range_rec)
+ */
+static void sweep_one(StationNode* r, int lo, int hi, SweepOut* o) {
+    while (r) {
+        if (r->station_id < lo) { r = r->right; continue; }
+        if (r->station_id > hi) { r = r->left; continue; }
+        sweep_one(r->left, lo, hi, o);
+        sweep_emit(o, r->station_id);
+        r = r->right;
+    }
+}
+
+/*
+ * Fonction auxiliaire récursive : parcours AVL multi-intervalles
+ * Chaque nœud ne reçoit que les intervalles qui peuvent toucher son
+ * sous-arbre : à gauche ceux qui commencent avant lui, à droite ceux qui
+ * finissent après lui. Un sous-arbre sans intervalle n'est pas visité ; avec
+ * un seul, le parcours simple prend le relais.
+ */
+static void sweep_avl(StationNode* r, const SiRange* iv, int a, int b, SweepOut* o) {
+    if (!r || a >= b) return;
+    if (b - a == 1) { sweep_one(r, iv[a].lo, iv[a].hi, o); return; }
+    int id = r->station_id;
+    int c = first_hi_ge(iv, a, b, id);   // seul intervalle pouvant contenir id
+
+    sweep_avl(r->left, iv, a, first_lo_ge(iv, a, b, id), o);
+    if (c < b && iv[c].lo <= id) sweep_emit(o, id);
+    sweep_avl(r->right, iv, c < b && iv[c].hi == id ? c + 1 : c, b, o);
+}
+
+/*
+ * Fonction auxiliaire : parcours B+ multi-intervalles
+ * Lecture des feuilles chaînées ; nouvelle descente seulement quand
+ * l'intervalle suivant commence au-delà de la feuille courante
+ */
+static void sweep_bp(const BPTree* t, const SiRange* iv, int m, SweepOut* o) {
+    BPNode* l = NULL;
+    int pos = 0;
+    for (int j = 0; j < m; j++) {
+        if (l && l->keys[l->nkeys - 1] >= iv[j].lo) {
+            while (l->keys[pos] < iv[j].lo) pos++;
+        }
+        else {
+            l = bp_seek(t, iv[j].lo, &pos);
+        }
+        while (l) {
+            if (pos >= l->nkeys) { l = l->leaf.next; pos = 0; continue; }
+            if (l->keys[pos] > iv[j].hi) break;
+            sweep_emit(o, l->keys[pos++]);
+        }
+        if (!l) return;   // plus aucune station au-delà
+    }
+}
+
+int si_range_ids_batch(const StationIndex* idx, const SiRange* ranges, int nranges,
+                       int* arena, int arena_cap, int* offsets, int* counts) {
+    if (nranges <= 0) return 0;
+    if (!arena) arena_cap = 0;
+
+    // Tri et fusion des plages non vides
+    SiRange* iv = (SiRange*)malloc(sizeof(SiRange) * nranges);
+    if (!iv) return -1;
+    int m = 0;
+    for (int i = 0; i < nranges; i++) {
+        if (ranges[i].lo <= ranges[i].hi) iv[m++] = ranges[i];
+    }
+    qsort(iv, m, sizeof(SiRange), compare_ranges);
+    int u = 0;
+    for (int i = 0; i < m; i++) {
+        // Chevauchement ou contiguïté (sans débordement de hi + 1)
+        if (u > 0 && (iv[u - 1].hi == INT_MAX || iv[i].lo <= iv[u - 1].hi + 1)) {
+            if (iv[i].hi > iv[u - 1].hi) iv[u - 1].hi = iv[i].hi;
+        }
+        else {
+            iv[u++] = iv[i];
+        }
+    }
+
+    // Parcours unique de l'union
+    SweepOut o = { arena, arena_cap < 0 ? 0 : arena_cap, 0, 0 };
+    if (idx->backend == SI_BACKEND_BPTREE) {
+        if (idx->bp) sweep_bp(idx->bp, iv, u, &o);
+    }
+    else {
+        sweep_avl(idx->root, iv, 0, u, &o);
+    }
+    free(iv);
+
+    // Tranche de chaque plage dans l'union triée (deux recherches dichotomiques)
+    for (int i = 0; i < nranges; i++) {
+        int lo = ranges[i].lo, hi = ranges[i].hi;
+        int a = 0, b = o.written;
+        while (a < b) { int mid = a + (b - a) / 2; if (arena[mid] < lo) a = mid + 1; else b = mid; }
+        int start = a;
+        b = o.written;
+        while (a < b) { int mid = a + (b - a) / 2; if (arena[mid] <= hi) a = mid + 1; else b = mid; }
+        if (offsets) offsets[i] = start;
+        if (counts) counts[i] = lo <= hi ? a - start : 0;
+    }
+    return o.total;
+}
+
+/*
+ * Fonction auxiliaire : subtree_size
+ */
+static int subtree_size(StationNode* n) {
+    return n ? n->size : 0;
+}
+
+int si_rank(StationNode* r, int id) {
+    int rank = 0;
+    while (r) {
+        if (id <= r->station_id) {
+            r = r->left;
+        } else {
+            // Le nœud et tout son sous-arbre gauche sont avant id
+            rank += subtree_size(r->left) + 1;
+            r = r->right;
+        }
+    }
+    return rank;
+}
+
+/*
+ * Fonction auxiliaire : count_le
+ * Nombre de stations d'ID <= id (évite le débordement de si_rank(id + 1))
+ */
+static int count_le(StationNode* r, int id) {
+    int count = 0;
+    while (r) {
+        if (id < r->station_id) {
+            r = r->left;
+        } else {
+            count += subtree_size(r->left) + 1;
+            r = r->right;
+        }
+    }
+    return count;
+}
+
+StationNode* si_select(StationNode* r, int i) {
+    if (i < 0 || i >= subtree_size(r)) return NULL;
+    while (r) {
+        int left = subtree_size(r->left);
+        if (i < left) {
+            r = r->left;
+        } else if (i == left) {
+            return r;
+        } else {
+            i -= left + 1;
+            r = r->right;
+        }
+    }
+    return NULL;
+}
+
+int si_count_range(StationNode* r, int lo, int hi) {
+    if (!r || lo > hi) return 0;
+    return count_le(r, hi) - si_rank(r, lo);
+}
+
+int si_range_page(StationNode* r, int lo, int hi, int offset, int* out, int cap) {
+    if (!r || !out || cap <= 0 || lo > hi || offset < 0) return 0;
+
+    int start = si_rank(r, lo) + offset;   // rang global du premier ID de la page
+    int end = count_le(r, hi);             // rang global après le dernier ID de [lo, hi]
+    if (start >= end) return 0;
+    int want = end - start < cap ? end - start : cap;
+
+    // Descente vers le rang start : on empile les ancêtres dont on visite
+    // encore le nœud et le sous-arbre droit (ceux où l'on part à gauche)
+    StationNode* stack[SI_MAX_DEPTH];
+    int top = 0;
+    int i = start;
+    StationNode* c = r;
+    while (c) {
+        int left = subtree_size(c->left);
+        if (i < left) {
+            stack[top++] = c;
+            c = c->left;
+        } else if (i == left) {
+            stack[top++] = c;
+            break;
+        } else {
+            i -= left + 1;
+            c = c->right;
+        }
+    }
+
+    // Parcours in-order à partir du nœud de rang start
+    int w = 0;
+    while (w < want && top > 0) {
+        StationNode* n = stack[--top];
+        out[w++] = n->station_id;
+        for (c = n->right; c; c = c->left) stack[top++] = c;
+    }
+    return w;
+}
+
 /*
  * Fonction auxiliaire récursive pour si_count_ge_power
  * Compte le nombre de stations avec power_kW >= P
+ * Élagage : un sous-arbre dont la puissance maximale est < P ne contient
+ * aucune station qualifiée
  */
 static int count_power_rec(StationNode* r, int P) {
-    if (!r) return 0;
+    if (!r || r->max_power < P) return 0;
 
     int count = 0;
 
@@ -63,6 +333,180 @@ int si_count_ge_power(StationNode* r, int P) {
     return count_power_rec(r, P);
 }
 
+/*
+ * Fonction auxiliaire : ajouter une station seule aux agrégats
+ */
+static void stats_add_node(RangeStats* st, StationNode* n) {
+    st->count++;
+    st->sum_slots += n->info.slots_free;
+    if (n->info.power_kW > st->max_power) st->max_power = n->info.power_kW;
+    if (n->info.price_cents < st->min_price) st->min_price = n->info.price_cents;
+}
+
+/*
+ * Fonction auxiliaire : ajouter un sous-arbre entier (agrégats stockés)
+ */
+static void stats_add_subtree(RangeStats* st, StationNode* n) {
+    if (!n) return;
+    st->count += n->size;
+    st->sum_slots += n->sum_slots;
+    if (n->max_power > st->max_power) st->max_power = n->max_power;
+    if (n->min_price < st->min_price) st->min_price = n->min_price;
+}
+
+int si_range_stats(StationNode* r, int lo, int hi, RangeStats* out) {
+    RangeStats st = { 0, 0, INT_MIN, INT_MAX };
+
+    // Descendre jusqu'au nœud de séparation (premier nœud dans [lo, hi])
+    while (r && (r->station_id < lo || r->station_id > hi)) {
+        r = r->station_id < lo ? r->right : r->left;
+    }
+
+    if (r && lo <= hi) {
+        stats_add_node(&st, r);
+
+        // Frontière gauche : nœuds >= lo du sous-arbre gauche
+        for (StationNode* c = r->left; c; ) {
+            if (c->station_id >= lo) {
+                stats_add_node(&st, c);
+                stats_add_subtree(&st, c->right);
+                c = c->left;
+            } else {
+                c = c->right;
+            }
+        }
+
+        // Frontière droite : nœuds <= hi du sous-arbre droit
+        for (StationNode* c = r->right; c; ) {
+            if (c->station_id <= hi) {
+                stats_add_node(&st, c);
+                stats_add_subtree(&st, c->left);
+                c = c->right;
+            } else {
+                c = c->left;
+            }
+        }
+    }
+
+    if (out) *out = st;
+    return st.count;
+}
+
+/*
+ * ============================================================================
+ * FILTRES PAR ATTRIBUT (PUISSANCE, PRIX)
+ * ============================================================================
+ */
+
+/*
+ * Fonction auxiliaire : attr_value
+ */
+static int attr_value(const StationInfo* in, SiAttr attr) {
+    return attr == SI_ATTR_POWER ? in->power_kW : in->price_cents;
+}
+
+/*
+ * Couple (valeur, ID) collecté par le parcours de repli
+ */
+typedef struct {
+    int key;
+    int id;
+} AttrPair;
+
+/*
+ * Collecteur du parcours de repli : compte, et range les couples si pairs != NULL
+ */
+typedef struct {
+    SiAttr attr;
+    int lo, hi;
+    AttrPair* pairs;
+    int count;
+} AttrScan;
+
+static void attr_scan_node(AttrScan* sc, int id, const StationInfo* in) {
+    int v = attr_value(in, sc->attr);
+    if (v < sc->lo || v > sc->hi) return;
+    if (sc->pairs) {
+        sc->pairs[sc->count].key = v;
+        sc->pairs[sc->count].id = id;
+    }
+    sc->count++;
+}
+
+/*
+ * Fonction auxiliaire récursive : attr_scan_avl
+ * Élagage : aucune station >= lo si max_power < lo (puissance),
+ *           aucune station <= hi si min_price > hi (prix)
+ */
+static void attr_scan_avl(AttrScan* sc, StationNode* r) {
+    if (!r) return;
+    if (sc->attr == SI_ATTR_POWER && r->max_power < sc->lo) return;
+    if (sc->attr == SI_ATTR_PRICE && r->min_price > sc->hi) return;
+    attr_scan_avl(sc, r->left);
+    attr_scan_node(sc, r->station_id, &r->info);
+    attr_scan_avl(sc, r->right);
+}
+
+/*
+ * Fonction auxiliaire : attr_scan
+ * Description : Parcours complet de l'index (AVL élagué ou feuilles B+)
+ */
+static void attr_scan(AttrScan* sc, const StationIndex* idx) {
+    if (idx->backend != SI_BACKEND_BPTREE) {
+        attr_scan_avl(sc, idx->root);
+        return;
+    }
+    BPNode* leaf = idx->bp ? idx->bp->root : NULL;
+    while (leaf && !leaf->is_leaf) leaf = leaf->children[0];
+    for (; leaf; leaf = leaf->leaf.next) {
+        for (int i = 0; i < leaf->nkeys; i++) {
+            attr_scan_node(sc, leaf->keys[i], &leaf->leaf.recs[i]->info);
+        }
+    }
+}
+
+/*
+ * Fonction auxiliaire : comparaison de couples (valeur, ID) pour qsort
+ */
+static int cmp_attr_pair(const void* a, const void* b) {
+    const AttrPair* x = (const AttrPair*)a;
+    const AttrPair* y = (const AttrPair*)b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    return (x->id > y->id) - (x->id < y->id);
+}
+
+int si_attr_count(const StationIndex* idx, SiAttr attr, int lo, int hi) {
+    if (lo > hi) return 0;
+    if (idx->attr) return ki_count_range(&idx->attr[attr], lo, hi);
+    AttrScan sc = { attr, lo, hi, NULL, 0 };
+    attr_scan(&sc, idx);
+    return sc.count;
+}
+
+int si_attr_range_ids(const StationIndex* idx, SiAttr attr, int lo, int hi, int* out, int cap) {
+    if (!out || cap <= 0 || lo > hi) return 0;
+    if (idx->attr) return ki_range_ids(&idx->attr[attr], lo, hi, out, cap);
+
+    // Repli : collecte des couples qualifiés puis tri par (valeur, ID)
+    int k = si_attr_count(idx, attr, lo, hi);
+    if (k == 0) return 0;
+    AttrPair* pairs = (AttrPair*)malloc(sizeof(AttrPair) * (size_t)k);
+    if (!pairs) return -1;
+    AttrScan sc = { attr, lo, hi, pairs, 0 };
+    attr_scan(&sc, idx);
+    qsort(pairs, (size_t)k, sizeof(AttrPair), cmp_attr_pair);
+    int w = k < cap ? k : cap;
+    for (int i = 0; i < w; i++) out[i] = pairs[i].id;
+    free(pairs);
+    return w;
+}
+
+int si_count_ge_power_idx(const StationIndex* idx, int P) {
+    if (idx->attr) return ki_count_range(&idx->attr[SI_ATTR_POWER], P, INT_MAX);
+    if (idx->backend != SI_BACKEND_BPTREE) return si_count_ge_power(idx->root, P);
+    return si_attr_count(idx, SI_ATTR_POWER, P, INT_MAX);
+}
+
 /*
  * ============================================================================
  * MODULE A2 : TOP-K PAR SCORE (MIN-HEAP LOCAL)
@@ -110,6 +554,15 @@ static void heap_swap(ScoredStation* a, ScoredStation* b) {
     *b = tmp;
 }
 
+/*
+ * Fonction auxiliaire : ordre du heap
+ * a est-il moins bon que b ? Score plus faible ou, à score égal, ID plus grand
+ * (classement déterministe : score décroissant puis ID croissant)
+ */
+static int heap_worse(const ScoredStation* a, const ScoredStation* b) {
+    return a->score < b->score || (a->score == b->score && a->station_id > b->station_id);
+}
+
 /*
  * Fonction auxiliaire : heapify vers le bas (pour maintenir propriété min-heap)
  */
@@ -118,10 +571,10 @@ static void heap_heapify_down(MinHeap* h, int i) {
     int left = 2 * i + 1;
     int right = 2 * i + 2;
 
-    if (left < h->size && h->data[left].score < h->data[smallest].score) {
+    if (left < h->size && heap_worse(&h->data[left], &h->data[smallest])) {
         smallest = left;
     }
-    if (right < h->size && h->data[right].score < h->data[smallest].score) {
+    if (right < h->size && heap_worse(&h->data[right], &h->data[smallest])) {
         smallest = right;
     }
 
@@ -137,7 +590,7 @@ static void heap_heapify_down(MinHeap* h, int i) {
 static void heap_heapify_up(MinHeap* h, int i) {
     if (i == 0) return;
     int parent = (i - 1) / 2;
-    if (h->data[i].score < h->data[parent].score) {
+    if (heap_worse(&h->data[i], &h->data[parent])) {
         heap_swap(&h->data[i], &h->data[parent]);
         heap_heapify_up(h, parent);
     }
@@ -156,6 +609,7 @@ static void heap_insert(MinHeap* h, int station_id, int score) {
         h->size++;
     }
     // Si le heap est plein mais le nouveau score est meilleur que le min
+    // (parcours par ID croissant : à score égal, la station déjà retenue gagne)
     else if (score > h->data[0].score) {
         // Remplacer la racine (minimum)
         h->data[0].station_id = station_id;
@@ -190,15 +644,138 @@ static void topk_traverse(StationNode* r, MinHeap* h, int alpha, int beta, int g
 }
 
 /*
- * Fonction auxiliaire : trier le heap par score décroissant pour l'extraction
+ * Fonction auxiliaire : trier le heap par score décroissant (puis ID
+ * croissant) pour l'extraction
  */
 static int compare_scored_desc(const void* a, const void* b) {
-    ScoredStation* sa = (ScoredStation*)a;
-    ScoredStation* sb = (ScoredStation*)b;
-    return sb->score - sa->score;  // Ordre décroissant
+    const ScoredStation* sa = (const ScoredStation*)a;
+    const ScoredStation* sb = (const ScoredStation*)b;
+    if (sa->score != sb->score) return sa->score > sb->score ? -1 : 1;
+    return (sa->station_id > sb->station_id) - (sa->station_id < sb->station_id);
 }
 
-int si_top_k_by_score(StationNode* r, int k, int* out_ids,
+/*
+ * ============================================================================
+ * TOP-K ÉLAGUÉ PAR BORNES (MEILLEUR D'ABORD)
+ * ============================================================================
+ *
+ * Borne supérieure du score d'un sous-arbre, tirée de ses agrégats :
+ *   alpha*max_slots + beta*max_power - gamma*min_price   (poids >= 0)
+ * File de priorité (max-heap) d'entrées « sous-arbre » (clé = borne) et
+ * « station » (clé = score exact). Une station sortie en tête bat tout ce
+ * qui reste : elle est la suivante du classement. Les k premières sorties
+ * forment le top-k ; les sous-arbres dont la borne reste sous le k-ième
+ * score ne sont jamais ouverts.
+ */
+
+typedef struct {
+    long long key;        // borne (sous-arbre) ou score exact (station)
+    long long lo;         // plus petit ID possible (station : son ID)
+    StationNode* node;
+    int exact;            // 1 : station seule, 0 : sous-arbre entier
+} BoundEntry;
+
+typedef struct {
+    BoundEntry* data;
+    int size;
+    int capacity;
+} BoundQueue;
+
+/*
+ * Fonction auxiliaire : ordre de la file
+ * a sort-il avant b ? Clé plus grande ; à clé égale, plus petit ID possible
+ * d'abord (départage du classement), un sous-arbre avant une station en cas
+ * d'égalité. Une station ne sort donc qu'une fois ouverts tous les
+ * sous-arbres pouvant contenir son score avec un ID plus petit, et les
+ * égalités massives se résolvent en descendant à gauche, sans tout ouvrir.
+ */
+static int bound_before(const BoundEntry* a, const BoundEntry* b) {
+    if (a->key != b->key) return a->key > b->key;
+    if (a->lo != b->lo) return a->lo < b->lo;
+    return !a->exact && b->exact;
+}
+
+static int bq_push(BoundQueue* q, long long key, long long lo, StationNode* node, int exact) {
+    if (q->size == q->capacity) {
+        int cap = q->capacity ? 2 * q->capacity : 64;
+        BoundEntry* d = (BoundEntry*)realloc(q->data, sizeof(BoundEntry) * cap);
+        if (!d) return 0;
+        q->data = d;
+        q->capacity = cap;
+    }
+    int i = q->size++;
+    q->data[i].key = key;
+    q->data[i].lo = lo;
+    q->data[i].node = node;
+    q->data[i].exact = exact;
+    while (i > 0) {
+        int p = (i - 1) / 2;
+        if (!bound_before(&q->data[i], &q->data[p])) break;
+        BoundEntry tmp = q->data[i]; q->data[i] = q->data[p]; q->data[p] = tmp;
+        i = p;
+    }
+    return 1;
+}
+
+static BoundEntry bq_pop(BoundQueue* q) {
+    BoundEntry top = q->data[0];
+    q->data[0] = q->data[--q->size];
+    int i = 0;
+    for (;;) {
+        int l = 2 * i + 1, r = l + 1, m = i;
+        if (l < q->size && bound_before(&q->data[l], &q->data[m])) m = l;
+        if (r < q->size && bound_before(&q->data[r], &q->data[m])) m = r;
+        if (m == i) break;
+        BoundEntry tmp = q->data[i]; q->data[i] = q->data[m]; q->data[m] = tmp;
+        i = m;
+    }
+    return top;
+}
+
+/*
+ * Fonction auxiliaire : borne supérieure du score d'un sous-arbre
+ * Un poids négatif demanderait l'agrégat opposé (min au lieu de max) : la
+ * borne devient alors +infini (sous-arbre toujours ouvert)
+ */
+static long long subtree_bound(const StationNode* n, int alpha, int beta, int gamma) {
+    if (alpha < 0 || beta < 0 || gamma < 0) return LLONG_MAX;
+    return (long long)alpha * n->max_slots + (long long)beta * n->max_power
+         - (long long)gamma * n->min_price;
+}
+
+int si_top_k_pruned(StationNode* r, int k, int* out_ids,
+                    int alpha, int beta, int gamma, int* visited) {
+    if (visited) *visited = 0;
+    if (!r || k <= 0 || !out_ids) return 0;
+
+    BoundQueue q = { NULL, 0, 0 };
+    int count = 0, opened = 0;
+    int ok = bq_push(&q, subtree_bound(r, alpha, beta, gamma), INT_MIN, r, 0);
+    while (ok && count < k && q.size > 0) {
+        BoundEntry e = bq_pop(&q);
+        if (e.exact) {
+            out_ids[count++] = e.node->station_id;
+            continue;
+        }
+        // Ouverture du sous-arbre : sa station (score exact) et ses deux enfants
+        // (IDs du sous-arbre droit : au-delà de celui de la station)
+        StationNode* n = e.node;
+        opened++;
+        ok = bq_push(&q, calculate_score(&n->info, alpha, beta, gamma), n->station_id, n, 1);
+        if (ok && n->left) ok = bq_push(&q, subtree_bound(n->left, alpha, beta, gamma), e.lo, n->left, 0);
+        if (ok && n->right) ok = bq_push(&q, subtree_bound(n->right, alpha, beta, gamma),
+                                         (long long)n->station_id + 1, n->right, 0);
+    }
+    free(q.data);
+    if (visited) *visited = opened;
+    return ok ? count : -1;
+}
+
+/*
+ * Fonction auxiliaire : top-k par parcours complet (poids négatifs : aucune
+ * borne exploitable ; ou repli si la file du parcours élagué ne peut grandir)
+ */
+static int top_k_full(StationNode* r, int k, int* out_ids,
                       int alpha, int beta, int gamma) {
     if (!r || k <= 0 || !out_ids) return 0;
 
@@ -220,4 +797,313 @@ int si_top_k_by_score(StationNode* r, int k, int* out_ids,
 
     heap_destroy(h);
     return count;
-}
\ No newline at end of file
+}
+
+int si_top_k_by_score(StationNode* r, int k, int* out_ids,
+                      int alpha, int beta, int gamma) {
+    if (alpha >= 0 && beta >= 0 && gamma >= 0) {
+        int count = si_top_k_pruned(r, k, out_ids, alpha, beta, gamma, NULL);
+        if (count >= 0) return count;
+    }
+    return top_k_full(r, k, out_ids, alpha, beta, gamma);
+}
+
+int si_top_k_idx(StationIndex* idx, int k, int* out_ids,
+                 int alpha, int beta, int gamma) {
+    if (k <= 0 || !out_ids) return 0;
+    StationColumns* c = idx->cols;
+    if (c && (!c->dirty || sc_rebuild(c, idx))) {
+        return sc_top_k(c, k, out_ids, alpha, beta, gamma);
+    }
+    if (idx->backend != SI_BACKEND_BPTREE) {
+        return si_top_k_by_score(idx->root, k, out_ids, alpha, beta, gamma);
+    }
+
+    // Backend B+ sans instantané : colonnes temporaires (lecture des feuilles)
+    StationColumns tmp;
+    sc_init(&tmp);
+    int count = sc_rebuild(&tmp, idx) ? sc_top_k(&tmp, k, out_ids, alpha, beta, gamma) : 0;
+    sc_clear(&tmp);
+    return count;
+}
+
+/*
+ * ============================================================================
+ * MODULE A2bis : TOP-K ET COMPTAGE PARALLÈLES (POOL DE THREADS)
+ * ============================================================================
+ *
+ * Le travail est découpé en tâches indépendantes (plus nombreuses que les
+ * threads, pour l'équilibrage) :
+ *   - instantané colonnaire actif : tranches de lignes contiguës ;
+ *   - AVL : sous-arbres disjoints d'une même profondeur, les nœuds au-dessus
+ *     (ancêtres) étant traités par l'appelant ;
+ *   - B+ : sous-arbres disjoints d'un même niveau.
+ * Chaque tâche tient son propre heap (ou compteur) ; la fusion trie les
+ * candidats selon le même ordre total (score décroissant, ID croissant) que la
+ * version séquentielle : le résultat est identique.
+ */
+
+#define PAR_TASKS_PER_THREAD 4   /* tâches par thread (équilibrage) */
+#define PAR_MIN_ROWS 4096        /* lignes minimum par tranche de colonnes */
+
+/*
+ * Découpage d'un index en tâches
+ */
+typedef struct {
+    int ntasks;
+    const StationColumns* cols;  // tranches de colonnes (ou NULL)
+    int rows_per_task;
+    StationNode** subtrees;      // sous-arbres AVL (ou NULL)
+    StationNode** singles;       // ancêtres AVL, traités par l'appelant
+    int nsingles;
+    BPNode** bp_nodes;           // sous-arbres B+ (ou NULL)
+} ParSplit;
+
+/*
+ * Contexte partagé par les tâches d'une requête
+ */
+typedef struct {
+    const ParSplit* sp;
+    int k, alpha, beta, gamma, P;
+    int* ids;      // top-k : k IDs par tâche
+    int* scores;   // top-k : k scores par tâche
+    int* counts;   // résultats par tâche (nombre d'IDs ou compte), -1 si échec
+} ParJob;
+
+/*
+ * Fonction auxiliaire : découpage de l'AVL
+ * Descente niveau par niveau jusqu'à obtenir au moins target sous-arbres ;
+ * les nœuds des niveaux développés deviennent des ancêtres isolés
+ */
+static int split_avl(StationNode* root, int target, ParSplit* sp) {
+    int cap = 4 * target + 2;
+    StationNode** level = (StationNode**)malloc(sizeof(StationNode*) * cap);
+    StationNode** next = (StationNode**)malloc(sizeof(StationNode*) * cap);
+    sp->singles = (StationNode**)malloc(sizeof(StationNode*) * cap);
+    if (!level || !next || !sp->singles) {
+        free(level); free(next); free(sp->singles);
+        sp->singles = NULL;
+        return 0;
+    }
+    int n = 0;
+    if (root) level[n++] = root;
+    sp->nsingles = 0;
+    while (n > 0 && n < target && sp->nsingles + n <= cap) {
+        int m = 0;
+        for (int i = 0; i < n; i++) {
+            sp->singles[sp->nsingles++] = level[i];
+            if (level[i]->left) next[m++] = level[i]->left;
+            if (level[i]->right) next[m++] = level[i]->right;
+        }
+        StationNode** tmp = level; level = next; next = tmp;
+        n = m;
+    }
+    free(next);
+    sp->subtrees = level;
+    sp->ntasks = n;
+    return 1;
+}
+
+/*
+ * Fonction auxiliaire : découpage du B+ (toutes les feuilles sont au même
+ * niveau : un niveau ne mélange pas feuilles et nœuds internes)
+ */
+static int split_bp(BPNode* root, int target, ParSplit* sp) {
+    int cap = target * (BP_ORDER + 1) + 1;
+    BPNode** level = (BPNode**)malloc(sizeof(BPNode*) * cap);
+    BPNode** next = (BPNode**)malloc(sizeof(BPNode*) * cap);
+    if (!level || !next) { free(level); free(next); return 0; }
+    int n = 0;
+    if (root) level[n++] = root;
+    while (n > 0 && n < target && !level[0]->is_leaf) {
+        int m = 0;
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j <= level[i]->nkeys; j++) next[m++] = level[i]->children[j];
+        }
+        BPNode** tmp = level; level = next; next = tmp;
+        n = m;
+    }
+    free(next);
+    sp->bp_nodes = level;
+    sp->ntasks = n;
+    return 1;
+}
+
+/*
+ * Fonction auxiliaire : découpage selon la représentation disponible
+ * (instantané colonnaire reconstruit si besoin)
+ */
+static int par_split(StationIndex* idx, ThreadPool* pool, ParSplit* sp) {
+    memset(sp, 0, sizeof(*sp));
+    int target = tp_threads(pool) * PAR_TASKS_PER_THREAD;
+    StationColumns* c = idx->cols;
+    if (c && (!c->dirty || sc_rebuild(c, idx))) {
+        int rows = (c->n + target - 1) / target;
+        if (rows < PAR_MIN_ROWS) rows = PAR_MIN_ROWS;
+        sp->cols = c;
+        sp->rows_per_task = rows;
+        sp->ntasks = (c->n + rows - 1) / rows;
+        return 1;
+    }
+    if (idx->backend == SI_BACKEND_BPTREE) return split_bp(idx->bp ? idx->bp->root : NULL, target, sp);
+    return split_avl(idx->root, target, sp);
+}
+
+static void par_split_free(ParSplit* sp) {
+    free(sp->subtrees);
+    free(sp->singles);
+    free(sp->bp_nodes);
+}
+
+/*
+ * Fonctions auxiliaires récursives : parcours d'un sous-arbre B+
+ */
+static void topk_traverse_bp(const BPNode* n, MinHeap* h, int alpha, int beta, int gamma) {
+    if (n->is_leaf) {
+        for (int i = 0; i < n->nkeys; i++) {
+            StationNode* s = n->leaf.recs[i];
+            heap_insert(h, s->station_id, calculate_score(&s->info, alpha, beta, gamma));
+        }
+        return;
+    }
+    for (int j = 0; j <= n->nkeys; j++) topk_traverse_bp(n->children[j], h, alpha, beta, gamma);
+}
+
+static int count_power_bp(const BPNode* n, int P) {
+    int count = 0;
+    if (n->is_leaf) {
+        for (int i = 0; i < n->nkeys; i++) count += n->leaf.recs[i]->info.power_kW >= P;
+        return count;
+    }
+    for (int j = 0; j <= n->nkeys; j++) count += count_power_bp(n->children[j], P);
+    return count;
+}
+
+/*
+ * Tâche top-k : top-k local de la partie t, dans ids/scores[t*k ...]
+ */
+static void par_topk_task(void* ctx, int t) {
+    ParJob* job = (ParJob*)ctx;
+    const ParSplit* sp = job->sp;
+    int* ids = job->ids + (size_t)t * job->k;
+    int* scores = job->scores + (size_t)t * job->k;
+    if (sp->cols) {
+        int lo = t * sp->rows_per_task;
+        job->counts[t] = sc_top_k_rows(sp->cols, lo, lo + sp->rows_per_task, job->k, ids, scores,
+                                       job->alpha, job->beta, job->gamma);
+        return;
+    }
+    MinHeap* h = heap_create(job->k);
+    if (!h) { job->counts[t] = -1; return; }
+    if (sp->subtrees) topk_traverse(sp->subtrees[t], h, job->alpha, job->beta, job->gamma);
+    else topk_traverse_bp(sp->bp_nodes[t], h, job->alpha, job->beta, job->gamma);
+    for (int i = 0; i < h->size; i++) {
+        ids[i] = h->data[i].station_id;
+        scores[i] = h->data[i].score;
+    }
+    job->counts[t] = h->size;
+    heap_destroy(h);
+}
+
+/*
+ * Tâche de comptage : stations de la partie t de puissance >= P
+ */
+static void par_count_task(void* ctx, int t) {
+    ParJob* job = (ParJob*)ctx;
+    const ParSplit* sp = job->sp;
+    if (sp->cols) {
+        int lo = t * sp->rows_per_task;
+        job->counts[t] = sc_count_ge_power_rows(sp->cols, lo, lo + sp->rows_per_task, job->P);
+    }
+    else if (sp->subtrees) job->counts[t] = count_power_rec(sp->subtrees[t], job->P);
+    else job->counts[t] = count_power_bp(sp->bp_nodes[t], job->P);
+}
+
+int si_top_k_par(StationIndex* idx, ThreadPool* pool, int k, int* out_ids,
+                 int alpha, int beta, int gamma) {
+    if (k <= 0 || !out_ids) return 0;
+    ParSplit sp;
+    if (!par_split(idx, pool, &sp)) return si_top_k_idx(idx, k, out_ids, alpha, beta, gamma);
+
+    // Résultats locaux : au plus k par tâche, plus les ancêtres AVL
+    size_t slots = (size_t)sp.ntasks * k;
+    ParJob job = { &sp, k, alpha, beta, gamma, 0, NULL, NULL, NULL };
+    job.ids = (int*)malloc(sizeof(int) * (slots + 1));
+    job.scores = (int*)malloc(sizeof(int) * (slots + 1));
+    job.counts = (int*)malloc(sizeof(int) * (sp.ntasks + 1));
+    ScoredStation* cand = (ScoredStation*)malloc(sizeof(ScoredStation) * (slots + sp.nsingles + 1));
+    int count = -1;
+    if (job.ids && job.scores && job.counts && cand) {
+        tp_run(pool, par_topk_task, &job, sp.ntasks);
+
+        // Fusion : candidats de toutes les tâches, classés selon l'ordre total
+        int m = 0;
+        for (int t = 0; t < sp.ntasks && m >= 0; t++) {
+            if (job.counts[t] < 0) { m = -1; break; }
+            for (int i = 0; i < job.counts[t]; i++) {
+                cand[m].station_id = job.ids[(size_t)t * k + i];
+                cand[m].score = job.scores[(size_t)t * k + i];
+                m++;
+            }
+        }
+        if (m >= 0) {
+            for (int i = 0; i < sp.nsingles; i++) {
+                cand[m].station_id = sp.singles[i]->station_id;
+                cand[m].score = calculate_score(&sp.singles[i]->info, alpha, beta, gamma);
+                m++;
+            }
+            qsort(cand, m, sizeof(ScoredStation), compare_scored_desc);
+            count = m < k ? m : k;
+            for (int i = 0; i < count; i++) out_ids[i] = cand[i].station_id;
+        }
+    }
+    free(job.ids);
+    free(job.scores);
+    free(job.counts);
+    free(cand);
+    par_split_free(&sp);
+
+    // Échec d'allocation : repli séquentiel
+    if (count < 0) return si_top_k_idx(idx, k, out_ids, alpha, beta, gamma);
+    return count;
+}
+
+int si_count_ge_power_par(StationIndex* idx, ThreadPool* pool, int P) {
+    if (idx->attr) return ki_count_range(&idx->attr[SI_ATTR_POWER], P, INT_MAX);
+    ParSplit sp;
+    if (!par_split(idx, pool, &sp)) return si_count_ge_power_idx(idx, P);
+    ParJob job = { &sp, 0, 0, 0, 0, P, NULL, NULL, NULL };
+    job.counts = (int*)malloc(sizeof(int) * (sp.ntasks + 1));
+    if (!job.counts) {
+        par_split_free(&sp);
+        return si_count_ge_power_idx(idx, P);
+    }
+    tp_run(pool, par_count_task, &job, sp.ntasks);
+
+    int count = 0;
+    for (int t = 0; t < sp.ntasks; t++) count += job.counts[t];
+    for (int i = 0; i < sp.nsingles; i++) count += sp.singles[i]->info.power_kW >= P;
+    free(job.counts);
+    par_split_free(&sp);
+    return count;
+}
+
+/*
+ * ============================================================================
+ * MODULE A3 : REQUÊTES GÉOGRAPHIQUES (ARBRE K-D)
+ * ============================================================================
+ */
+
+int si_nearest_idx(const StationIndex* idx, double lat, double lon, int k,
+                   int min_slots, int min_power, int* out_ids, double* out_km) {
+    if (!idx->geo) return -1;
+    return geo_nearest(idx->geo, lat, lon, -1.0, k, min_slots, min_power, out_ids, out_km);
+}
+
+int si_within_radius_idx(const StationIndex* idx, double lat, double lon, double radius_km,
+                         int min_slots, int min_power, int* out_ids, double* out_km, int cap) {
+    if (!idx->geo) return -1;
+    if (radius_km < 0) return 0;
+    // Rayon : la recherche des cap plus proches, bornée par la distance
+    return geo_nearest(idx->geo, lat, lon, radius_km, cap, min_slots, min_power, out_ids, out_km);
+}
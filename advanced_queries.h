@@ -2,6 +2,7 @@
 #define ADVANCED_QUERIES_H
 
 #include "station_index.h"
+#include "thread_pool.h"
 
 /*
  * ============================================================================
@@ -26,19 +27,207 @@
  */
 int si_range_ids(StationNode* r, int lo, int hi, int* out, int cap);
 
+/*
+ * Fonction : si_range_ids_idx
+ * Description : Identique à si_range_ids, quel que soit le backend de l'index
+ *               (AVL : parcours élagué ; B+ : lecture séquentielle des feuilles)
+ * Paramètres :
+ *   - idx : index des stations
+ *   - lo, hi, out, cap : comme si_range_ids
+ * Retour : Nombre d'IDs écrits dans le tableau
+ * Complexité temps : O(k + log n)
+ * Complexité espace : O(log n) pour l'AVL, O(1) pour le B+
+ */
+int si_range_ids_idx(const StationIndex* idx, int lo, int hi, int* out, int cap);
+
+/*
+ * Plage d'IDs [lo, hi] (bornes incluses) d'une requête multi-plages
+ */
+typedef struct SiRange {
+    int lo;
+    int hi;
+} SiRange;
+
+/*
+ * Fonction : si_range_ids_batch
+ * Description : Répond à un lot de plages en un seul parcours ordonné de
+ *               l'index (AVL ou B+) : les plages sont triées et fusionnées
+ *               (chevauchement ou contiguïté), l'union est écrite une fois,
+ *               triée et sans doublon, dans l'arène. La plage i occupe la
+ *               tranche arena[offsets[i] .. offsets[i] + counts[i]) : deux
+ *               plages qui se recouvrent partagent les mêmes cases, et aucun
+ *               nœud n'est visité deux fois.
+ * Paramètres :
+ *   - idx : index des stations
+ *   - ranges : plages, dans un ordre quelconque (lo > hi : plage vide)
+ *   - nranges : nombre de plages
+ *   - arena : arène de sortie partagée, arena_cap : sa capacité
+ *   - offsets, counts : tranche de chaque plage (tableaux de nranges cases)
+ * Retour : Taille de l'union (comme snprintf : si elle dépasse arena_cap,
+ *          seules les arena_cap premières cases sont écrites et les tranches
+ *          sont tronquées ; relancer avec une arène assez grande),
+ *          -1 si échec d'allocation
+ * Complexité temps : O(R log R + U + log n) où R = nombre de plages,
+ *                    U = taille de l'union ; plus O(log R) par nœud visité
+ * Complexité espace : O(R + log n)
+ */
+int si_range_ids_batch(const StationIndex* idx, const SiRange* ranges, int nranges,
+                       int* arena, int arena_cap, int* offsets, int* counts);
+
+/*
+ * Fonction : si_rank
+ * Description : Rang d'un ID = nombre de stations d'ID strictement inférieur
+ *               (position 0-based de la station si elle est présente)
+ *               Utilise la taille des sous-arbres stockée dans chaque nœud
+ * Paramètres :
+ *   - r : racine de l'arbre AVL
+ *   - id : identifiant (présent ou non dans l'index)
+ * Retour : Nombre de stations d'ID < id
+ * Complexité temps : O(log n) - Une seule descente
+ * Complexité espace : O(1)
+ */
+int si_rank(StationNode* r, int id);
+
+/*
+ * Fonction : si_select
+ * Description : Station de rang i (0-based) dans l'ordre des IDs
+ * Paramètres :
+ *   - r : racine de l'arbre AVL
+ *   - i : rang recherché
+ * Retour : Nœud de rang i, ou NULL si i hors de [0, n)
+ * Complexité temps : O(log n) - Une seule descente
+ * Complexité espace : O(1)
+ */
+StationNode* si_select(StationNode* r, int i);
+
+/*
+ * Fonction : si_count_range
+ * Description : Nombre de stations d'ID dans [lo, hi], sans les extraire
+ * Paramètres :
+ *   - r : racine de l'arbre AVL
+ *   - lo : borne inférieure (inclusive)
+ *   - hi : borne supérieure (inclusive)
+ * Retour : Nombre de stations dans l'intervalle
+ * Complexité temps : O(log n) - Deux descentes (rangs de lo et de hi)
+ * Complexité espace : O(1)
+ */
+int si_count_range(StationNode* r, int lo, int hi);
+
+/*
+ * Fonction : si_range_page
+ * Description : Page d'une range query : IDs de [lo, hi] à partir du
+ *               offset-ième (0-based), sans parcourir les précédents.
+ *               Le point de départ est atteint par rang (si_rank + sélection),
+ *               puis le parcours in-order continue avec une pile explicite.
+ * Paramètres :
+ *   - r : racine de l'arbre AVL
+ *   - lo, hi : intervalle d'IDs (inclusif)
+ *   - offset : nombre d'IDs de l'intervalle à sauter
+ *   - out : tableau destination
+ *   - cap : taille de la page (capacité du tableau)
+ * Retour : Nombre d'IDs écrits (0 si offset dépasse la fin de l'intervalle)
+ * Complexité temps : O(log n + cap) - Indépendant de offset
+ * Complexité espace : O(log n) - Pile explicite bornée (SI_MAX_DEPTH)
+ *
+ * Exemple : page p de 20 stations dans [lo, hi]
+ *   si_range_page(r, lo, hi, p*20, out, 20)
+ */
+int si_range_page(StationNode* r, int lo, int hi, int offset, int* out, int cap);
+
 /*
  * Fonction : si_count_ge_power
  * Description : Compte le nombre de stations avec puissance >= P
- *               Parcours complet de l'arbre pour compter
+ *               Les sous-arbres dont la puissance maximale (agrégat
+ *               max_power) est < P sont ignorés sans être parcourus
  * Paramètre :
  *   - r : racine de l'arbre AVL
  *   - P : seuil de puissance en kW
  * Retour : Nombre de stations satisfaisant la condition
- * Complexité temps : O(n) - Visite chaque nœud
+ * Complexité temps : O(n) au pire, O(1) si aucune station n'atteint P ;
+ *                    en général proportionnel aux sous-arbres contenant
+ *                    au moins une station >= P
  * Complexité espace : O(log n) - Pile de récursion
  */
 int si_count_ge_power(StationNode* r, int P);
 
+/*
+ * Structure d'agrégats sur une plage d'IDs
+ */
+typedef struct {
+    int count;            // Nombre de stations dans la plage
+    long long sum_slots;  // Total des places libres
+    int max_power;        // Puissance maximale (INT_MIN si plage vide)
+    int min_price;        // Prix minimal (INT_MAX si plage vide)
+} RangeStats;
+
+/*
+ * Fonction : si_range_stats
+ * Description : Agrégats (nombre, total des places libres, puissance max,
+ *               prix min) des stations d'ID dans [lo, hi], sans les parcourir.
+ *               On descend jusqu'au premier nœud dans [lo, hi], puis le long
+ *               des deux frontières : chaque sous-arbre entièrement inclus
+ *               contribue par ses agrégats stockés.
+ * Paramètres :
+ *   - r : racine de l'arbre AVL
+ *   - lo : borne inférieure (inclusive)
+ *   - hi : borne supérieure (inclusive)
+ *   - out : agrégats calculés
+ * Retour : Nombre de stations dans la plage (= out->count)
+ * Complexité temps : O(log n) - Trois descentes au plus
+ * Complexité espace : O(1)
+ *
+ * Exemple : places libres totales de la zone [1100, 1150]
+ *   RangeStats st; si_range_stats(r, 1100, 1150, &st); → st.sum_slots
+ */
+int si_range_stats(StationNode* r, int lo, int hi, RangeStats* out);
+
+/*
+ * Fonction : si_attr_count
+ * Description : Nombre de stations dont l'attribut (puissance ou prix) est
+ *               dans [lo, hi]. Utilise l'index secondaire (si_enable_attr_index)
+ *               s'il est actif, sinon un parcours de l'index (élagué par les
+ *               agrégats max_power / min_price pour l'AVL)
+ * Paramètres :
+ *   - idx : index des stations
+ *   - attr : SI_ATTR_POWER ou SI_ATTR_PRICE
+ *   - lo, hi : bornes incluses sur la valeur de l'attribut
+ * Retour : Nombre de stations
+ * Complexité temps : O(log n) avec index secondaire, O(n) au pire sinon
+ * Complexité espace : O(log n) - Pile de récursion
+ */
+int si_attr_count(const StationIndex* idx, SiAttr attr, int lo, int hi);
+
+/*
+ * Fonction : si_attr_range_ids
+ * Description : IDs des stations dont l'attribut est dans [lo, hi], triés par
+ *               (valeur de l'attribut, ID) croissants. Sans index secondaire,
+ *               même résultat par parcours complet puis tri des couples
+ * Paramètres :
+ *   - idx : index des stations
+ *   - attr : SI_ATTR_POWER ou SI_ATTR_PRICE
+ *   - lo, hi : bornes incluses sur la valeur de l'attribut
+ *   - out : tableau destination pour les IDs
+ *   - cap : capacité maximale du tableau (les cap premiers dans l'ordre)
+ * Retour : Nombre d'IDs écrits dans le tableau, -1 si échec d'allocation
+ * Complexité temps : O(log n + k) avec index secondaire,
+ *                    O(n + k log k) sinon
+ * Complexité espace : O(log n) avec index secondaire, O(k) sinon
+ *
+ * Exemple : les 10 stations de plus faible prix parmi celles à <= 250 centimes
+ *   si_attr_range_ids(&idx, SI_ATTR_PRICE, INT_MIN, 250, ids, 10);
+ */
+int si_attr_range_ids(const StationIndex* idx, SiAttr attr, int lo, int hi, int* out, int cap);
+
+/*
+ * Fonction : si_count_ge_power_idx
+ * Description : si_count_ge_power quel que soit le backend ; passe par l'index
+ *               secondaire (power_kW, ID) s'il est actif
+ * Retour : Nombre de stations avec power_kW >= P
+ * Complexité temps : O(log n) avec index secondaire, sinon comme si_count_ge_power
+ * Complexité espace : O(log n)
+ */
+int si_count_ge_power_idx(const StationIndex* idx, int P);
+
 /*
  * ============================================================================
  * MODULE A2 : TOP-K PAR SCORE (MIN-HEAP LOCAL)
@@ -57,7 +246,8 @@ typedef struct {
  * Fonction : si_top_k_by_score
  * Description : Trouve les K stations avec les meilleurs scores
  *               Score = slots_free*alpha + power_kW*beta - price_cents*gamma
- *               Utilise un min-heap de taille k pour efficacité
+ *               Poids >= 0 : parcours élagué par bornes (si_top_k_pruned) ;
+ *               sinon parcours complet avec un min-heap de taille k
  * Paramètres :
  *   - r : racine de l'arbre AVL
  *   - k : nombre de top stations à retourner
@@ -66,16 +256,138 @@ typedef struct {
  *   - beta : poids pour power_kW
  *   - gamma : poids pour price_cents (soustrait)
  * Retour : Nombre d'IDs écrits (min(k, nb_stations))
- * Complexité temps : O(n log k) - Parcours n stations, heap de taille k
- * Complexité espace : O(k + log n) - Heap de taille k + pile récursion
+ * Complexité temps : O(m log m) élagué (m = sous-arbres ouverts),
+ *                    O(n log k) en parcours complet
+ * Complexité espace : O(m) élagué, O(k + log n) en parcours complet
  * 
  * Exemple :
  *   alpha=2, beta=1, gamma=1
  *   Station A: slots=3, power=50, price=200 → score = 3*2 + 50*1 - 200*1 = -144
  *   Station B: slots=5, power=150, price=300 → score = 5*2 + 150*1 - 300*1 = -140
  *   → B meilleur que A
+ *
+ * Ordre : score décroissant, puis ID croissant à score égal (déterministe)
  */
 int si_top_k_by_score(StationNode* r, int k, int* out_ids,
                       int alpha, int beta, int gamma);
 
+/*
+ * Fonction : si_top_k_pruned
+ * Description : Top-k « meilleur d'abord » : chaque sous-arbre a une borne
+ *               supérieure de score tirée de ses agrégats
+ *               (alpha*max_slots + beta*max_power - gamma*min_price) ; une
+ *               file de priorité ouvre toujours l'entrée la plus prometteuse,
+ *               et une station qui arrive en tête est la suivante du
+ *               classement. Les sous-arbres dont la borne reste sous le
+ *               k-ième score ne sont jamais visités.
+ *               Même résultat, dans le même ordre, que si_top_k_by_score.
+ * Paramètres :
+ *   - r, k, out_ids, alpha, beta, gamma : comme si_top_k_by_score
+ *     (un poids négatif rend les bornes infinies : aucun élagage)
+ *   - visited : nombre de nœuds ouverts (métrique, NULL accepté)
+ * Retour : Nombre d'IDs écrits (min(k, nb_stations)), -1 si échec d'allocation
+ * Complexité temps : O(m log m) où m = nœuds ouverts (m <= n, m << n pour
+ *                    une requête sélective)
+ * Complexité espace : O(m) - File de priorité
+ */
+int si_top_k_pruned(StationNode* r, int k, int* out_ids,
+                    int alpha, int beta, int gamma, int* visited);
+
+/*
+ * Fonction : si_top_k_idx
+ * Description : si_top_k_by_score quel que soit le backend, sur l'instantané
+ *               colonnaire s'il est actif (si_enable_columns) : les scores sont
+ *               calculés par blocs de 8 (AVX2) ou 4 (SSE4.1) stations sur des
+ *               colonnes contiguës, et seules les stations qui dépassent le
+ *               k-ième meilleur score courant passent par le heap.
+ *               Même résultat, dans le même ordre, que si_top_k_by_score.
+ *               L'instantané est reconstruit ici s'il est marqué à reconstruire
+ *               (après si_build_sorted).
+ * Paramètres : comme si_top_k_by_score, avec l'index au lieu de la racine
+ * Retour : Nombre d'IDs écrits (min(k, nb_stations))
+ * Complexité temps : O(n + m log k) - m = stations retenues au passage,
+ *                    sans poursuite de pointeurs
+ * Complexité espace : O(k)
+ */
+int si_top_k_idx(StationIndex* idx, int k, int* out_ids,
+                 int alpha, int beta, int gamma);
+
+/*
+ * Fonction : si_top_k_par
+ * Description : si_top_k_idx réparti sur un pool de threads : tranches de
+ *               l'instantané colonnaire s'il est actif, sinon sous-arbres
+ *               disjoints (AVL ou B+) ; un heap local par tâche, puis fusion.
+ *               Résultat identique (mêmes IDs, même ordre) à si_top_k_idx.
+ * Paramètres :
+ *   - idx : index (non modifié pendant l'appel)
+ *   - pool : pool de threads (NULL : exécution séquentielle)
+ *   - k, out_ids, alpha, beta, gamma : comme si_top_k_by_score
+ * Retour : Nombre d'IDs écrits (min(k, nb_stations))
+ * Complexité temps : O(n / T + T·k log(T·k)), T = nombre de tâches
+ * Complexité espace : O(T·k)
+ */
+int si_top_k_par(StationIndex* idx, ThreadPool* pool, int k, int* out_ids,
+                 int alpha, int beta, int gamma);
+
+/*
+ * Fonction : si_count_ge_power_par
+ * Description : si_count_ge_power_idx réparti sur un pool de threads (un
+ *               compteur par tâche, additionnés). Avec l'index secondaire de
+ *               puissance, la réponse en O(log n) est renvoyée directement.
+ * Paramètres : idx, pool (NULL accepté), P : puissance minimale (kW)
+ * Retour : Nombre de stations avec power_kW >= P (identique au séquentiel)
+ * Complexité temps : O(n / T) par thread, O(log n) avec l'index secondaire
+ * Complexité espace : O(T)
+ */
+int si_count_ge_power_par(StationIndex* idx, ThreadPool* pool, int P);
+
+/*
+ * ============================================================================
+ * MODULE A3 : REQUÊTES GÉOGRAPHIQUES (ARBRE K-D)
+ * ============================================================================
+ */
+
+/*
+ * Fonction : si_nearest_idx
+ * Description : Les k stations les plus proches d'une position, parmi celles
+ *               qui ont au moins min_slots places libres et min_power kW ;
+ *               les filtres sont appliqués pendant la descente de l'arbre k-d
+ *               (un sous-arbre sans station assez libre ou assez puissante
+ *               n'est pas visité). Nécessite si_enable_geo.
+ * Paramètres :
+ *   - idx : index des stations
+ *   - lat, lon : position de l'utilisateur (degrés décimaux)
+ *   - k : nombre de stations voulues
+ *   - min_slots, min_power : filtres (INT_MIN : sans filtre)
+ *   - out_ids : tableau destination pour les IDs (taille >= k)
+ *   - out_km : distances orthodromiques en km (taille >= k, NULL accepté)
+ * Retour : Nombre d'IDs écrits (min(k, stations retenues)), triés par
+ *          distance croissante puis ID croissant ; -1 si l'index
+ *          géographique est inactif ou en cas d'échec d'allocation
+ * Complexité temps : O(log n + k log k) en moyenne
+ * Complexité espace : O(k + log n)
+ *
+ * Exemple : 5 stations d'au moins 50 kW avec une place libre, autour de Lyon
+ *   si_nearest_idx(&idx, 45.76, 4.84, 5, 1, 50, ids, km);
+ */
+int si_nearest_idx(const StationIndex* idx, double lat, double lon, int k,
+                   int min_slots, int min_power, int* out_ids, double* out_km);
+
+/*
+ * Fonction : si_within_radius_idx
+ * Description : Stations à au plus radius_km d'une position, avec les mêmes
+ *               filtres que si_nearest_idx, de la plus proche à la plus
+ *               éloignée (les cap plus proches si elles sont plus nombreuses)
+ * Paramètres :
+ *   - idx, lat, lon, min_slots, min_power, out_ids, out_km : comme si_nearest_idx
+ *   - radius_km : rayon (km, bord inclus)
+ *   - cap : capacité maximale des tableaux
+ * Retour : Nombre d'IDs écrits, -1 si l'index géographique est inactif ou en
+ *          cas d'échec d'allocation
+ * Complexité temps : O(log n + m log cap) en moyenne, m = stations du disque
+ * Complexité espace : O(cap + log n)
+ */
+int si_within_radius_idx(const StationIndex* idx, double lat, double lon, double radius_km,
+                         int min_slots, int min_power, int* out_ids, double* out_km, int cap);
+
 #endif
\ No newline at end of file
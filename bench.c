@@ -0,0 +1,1229 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "station_index.h"
+#include "advanced_queries.h"
+#include "station_columns.h"
+#include "topk_view.h"
+#include "rules.h"
+#include "query_cache.h"
+#include "rule_plan.h"
+#include "rule_batch.h"
+#include "rule_opt.h"
+#include "rule_sub.h"
+#include "csv_loader.h"
+
+/*
+ * ============================================================================
+ * BENCHMARK : INDEX DES STATIONS
+ * ============================================================================
+ *
+ * Mesure les coûts de chargement, de recherche et de libération de l'index
+ * sur un grand nombre de stations synthétiques.
+ *
+ * Usage : ./bench [nombre_de_stations] [section]   (défaut : 1 000 000, toutes)
+ * Sections : index, bulk, lookup, events, snapshot, attr, topk, prune, par, view, iter, batch, geo, cache, plan, rules, subs, csv
+ */
+
+/*
+ * Fonction auxiliaire : now_sec
+ * Description : Horloge murale en secondes (C11 timespec_get)
+ */
+static double now_sec(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/*
+ * Fonction auxiliaire : shuffle
+ * Description : Mélange de Fisher-Yates avec un générateur LCG déterministe
+ */
+static void shuffle(int* a, int n, unsigned seed) {
+    for (int i = n - 1; i > 0; i--) {
+        seed = seed * 1103515245u + 12345u;
+        int j = (int)((seed >> 8) % (unsigned)(i + 1));
+        int t = a[i]; a[i] = a[j]; a[j] = t;
+    }
+}
+
+static StationInfo make_info(int id) {
+    StationInfo in;
+    in.power_kW = 22 + (id * 37) % 328;
+    in.price_cents = 150 + (id * 13) % 400;
+    in.slots_free = id % 9;
+    in.last_ts = 0;
+    return in;
+}
+
+static void report(const char* what, double sec, int ops) {
+    printf("  %-28s %9.1f ms  %8.1f ns/op\n", what, sec * 1e3, sec * 1e9 / ops);
+}
+
+/*
+ * Section : chargement / recherche / parcours / libération d'un index
+ * (même scénario pour chaque backend, via les fonctions *_idx)
+ */
+static void bench_index(const int* ids, int n, const char* label, SiBackend backend) {
+    const char* name = backend == SI_BACKEND_BPTREE ? "B+ " : "AVL";
+    StationIndex idx;
+    si_init_backend(&idx, backend);
+
+    double t0 = now_sec();
+    for (int i = 0; i < n; i++) si_add(&idx, ids[i], make_info(ids[i]));
+    double t1 = now_sec();
+
+    long found = 0;
+    for (int i = 0; i < n; i++) found += si_find_idx(&idx, ids[i]) != NULL;
+    double t2 = now_sec();
+
+    /* Mise à jour des stations existantes (même clé, nouvelles infos) */
+    for (int i = 0; i < n; i++) si_add(&idx, ids[i], make_info(ids[i] + 1));
+    double t3 = now_sec();
+
+    /* Export trié complet puis 1000 plages de 1000 IDs */
+    int* out = (int*)malloc(sizeof(int) * n);
+    if (!out) { si_clear(&idx); return; }
+    int exported = si_to_array_idx(&idx, out, n);
+    double t4 = now_sec();
+    long in_ranges = 0;
+    for (int r = 0; r < 1000; r++) {
+        int lo = 1001 + (int)(((long)r * 7919) % n);
+        in_ranges += si_range_ids_idx(&idx, lo, lo + 999, out, n);
+    }
+    double t5 = now_sec();
+    free(out);
+
+    /* Suppression d'une station sur deux */
+    for (int i = 0; i < n; i += 2) si_delete(&idx, ids[i]);
+    double t6 = now_sec();
+
+    si_clear(&idx);
+    double t7 = now_sec();
+
+    printf("[%s] %s (n=%d, trouvees=%ld, exportees=%d, en plages=%ld)\n",
+           name, label, n, found, exported, in_ranges);
+    report("chargement (si_add)", t1 - t0, n);
+    report("recherche (si_find_idx)", t2 - t1, n);
+    report("mise a jour (si_add)", t3 - t2, n);
+    report("export trie (si_to_array)", t4 - t3, n);
+    report("1000 plages de 1000 IDs", t5 - t4, in_ranges > 0 ? (int)in_ranges : 1);
+    report("suppression (si_delete)", t6 - t5, (n + 1) / 2);
+    report("liberation (si_clear)", t7 - t6, n);
+}
+
+/*
+ * Section : chargement en masse (si_build_sorted) contre si_add ligne à ligne
+ */
+static void bench_bulk(const int* ids, int n, const char* label) {
+    StationEntry* rows = (StationEntry*)malloc(sizeof(StationEntry) * n);
+    if (!rows) return;
+    for (int i = 0; i < n; i++) {
+        rows[i].station_id = ids[i];
+        rows[i].info = make_info(ids[i]);
+    }
+
+    StationIndex a, b;
+    si_init(&a);
+    si_init(&b);
+
+    double t0 = now_sec();
+    for (int i = 0; i < n; i++) si_add(&a, rows[i].station_id, rows[i].info);
+    double t1 = now_sec();
+    si_build_sorted(&b, rows, n);
+    double t2 = now_sec();
+
+    printf("[BULK] %s (n=%d, hauteur si_add=%d, hauteur build=%d)\n",
+           label, n, a.root ? a.root->height : -1, b.root ? b.root->height : -1);
+    report("si_add x n", t1 - t0, n);
+    report("si_build_sorted", t2 - t1, n);
+
+    si_clear(&a);
+    si_clear(&b);
+    free(rows);
+}
+
+/*
+ * Section : recherche par ID via l'arbre contre la table de recherche
+ * (si_enable_lookup), puis coût de maintenance de la table
+ */
+static void bench_lookup(const int* ids, int n, const char* label) {
+    StationIndex idx;
+    si_init(&idx);
+    for (int i = 0; i < n; i++) si_add(&idx, ids[i], make_info(ids[i]));
+
+    double t0 = now_sec();
+    long found = 0;
+    for (int i = 0; i < n; i++) found += si_find_idx(&idx, ids[i]) != NULL;
+    double t1 = now_sec();
+    int ok = si_enable_lookup(&idx);
+    double t2 = now_sec();
+    for (int i = 0; i < n; i++) found += si_find_idx(&idx, ids[i]) != NULL;
+    double t3 = now_sec();
+    /* Suppression puis réinsertion d'une station sur deux (table tenue à jour) */
+    for (int i = 0; i < n; i += 2) si_delete(&idx, ids[i]);
+    for (int i = 0; i < n; i += 2) si_add(&idx, ids[i], make_info(ids[i]));
+    double t4 = now_sec();
+
+    printf("[LOOKUP] %s (n=%d, table=%s, trouvees=%ld)\n",
+           label, n, ok ? "active" : "echec", found);
+    report("si_find_idx (arbre)", t1 - t0, n);
+    report("si_enable_lookup", t2 - t1, n);
+    report("si_find_idx (table)", t3 - t2, n);
+    report("si_delete + si_add (table)", t4 - t3, n);
+    si_clear(&idx);
+}
+
+/*
+ * Section : filtres par attribut, parcours élagué contre index secondaires
+ * (si_enable_attr_index), et surcoût de maintenance à l'écriture
+ */
+static void bench_attr(const int* ids, int n) {
+    StationIndex idx;
+    si_init(&idx);
+    for (int i = 0; i < n; i++) si_add(&idx, ids[i], make_info(ids[i]));
+    int* out = (int*)malloc(sizeof(int) * 100);
+    if (!out) { si_clear(&idx); return; }
+
+    long c0 = 0, c1 = 0, r0 = 0, r1 = 0;
+    double t0 = now_sec();
+    for (int q = 0; q < 1000; q += 50) c0 += si_count_ge_power_idx(&idx, 22 + q % 328);
+    double t1 = now_sec();
+    for (int q = 0; q < 100; q += 10) r0 += si_attr_range_ids(&idx, SI_ATTR_PRICE, 150 + q, 160 + q, out, 100);
+    double t2 = now_sec();
+    int ok = si_enable_attr_index(&idx);
+    double t3 = now_sec();
+    for (int q = 0; q < 1000; q += 50) c1 += si_count_ge_power_idx(&idx, 22 + q % 328);
+    double t4 = now_sec();
+    for (int q = 0; q < 100; q += 10) r1 += si_attr_range_ids(&idx, SI_ATTR_PRICE, 150 + q, 160 + q, out, 100);
+    double t5 = now_sec();
+    /* Mise à jour de toutes les stations avec de nouvelles puissance et prix */
+    for (int i = 0; i < n; i++) si_add(&idx, ids[i], make_info(ids[i] + 1));
+    double t6 = now_sec();
+
+    printf("[ATTR] filtres puissance / prix (n=%d, index=%s, comptes %s, plages %s)\n",
+           n, ok ? "actifs" : "echec", c0 == c1 ? "identiques" : "DIFFERENTS",
+           r0 == r1 ? "identiques" : "DIFFERENTES");
+    report("power >= P (arbre)", t1 - t0, 20);
+    report("prix dans [a,a+10] (tri)", t2 - t1, 10);
+    report("si_enable_attr_index", t3 - t2, n);
+    report("power >= P (index)", t4 - t3, 20);
+    report("prix dans [a,a+10] (index)", t5 - t4, 10);
+    report("si_add changeant les attributs", t6 - t5, n);
+    free(out);
+    si_clear(&idx);
+}
+
+/*
+ * Top-K par score : parcours de l'arbre contre parcours colonnaire
+ * (scalaire, SSE4.1, AVX2), puis coût d'entretien des colonnes sur si_add
+ */
+static void bench_topk(const int* ids, int n) {
+    StationIndex idx;
+    si_init(&idx);
+    for (int i = 0; i < n; i++) si_add(&idx, ids[i], make_info(ids[i]));
+    enum { K = 10, Q = 20 };
+    int ref[K], out[K];
+    static const char* names[] = { "colonnes scalaire", "colonnes SSE4.1", "colonnes AVX2" };
+
+    double t0 = now_sec();
+    int cnt = 0;
+    for (int q = 0; q < Q; q++) cnt = si_top_k_by_score(idx.root, K, ref, 2, 1, 1);
+    double t1 = now_sec();
+    int ok = si_enable_columns(&idx);
+    double t2 = now_sec();
+    printf("[TOPK] top-%d par score (n=%d, colonnes=%s, SIMD max=%d)\n",
+           K, n, ok ? "actives" : "echec", (int)sc_simd_best());
+    report("arbre (si_top_k_by_score)", t1 - t0, Q);
+    report("si_enable_columns", t2 - t1, n);
+    if (!ok) { si_clear(&idx); return; }
+
+    for (int lv = SC_SIMD_SCALAR; lv <= (int)sc_simd_best(); lv++) {
+        int same = 1;
+        double a = now_sec();
+        for (int q = 0; q < Q; q++) {
+            int c = sc_top_k_level(idx.cols, K, out, 2, 1, 1, (ScSimd)lv);
+            same = same && c == cnt && memcmp(out, ref, sizeof(int) * (size_t)c) == 0;
+        }
+        double b = now_sec();
+        report(names[lv], b - a, Q);
+        if (!same) printf("  %-32s resultats DIFFERENTS\n", names[lv]);
+    }
+
+    /* Mise à jour de toutes les stations : ligne réécrite en place */
+    double t3 = now_sec();
+    for (int i = 0; i < n; i++) si_add(&idx, ids[i], make_info(ids[i] + 1));
+    double t4 = now_sec();
+    report("si_add avec colonnes", t4 - t3, n);
+    si_clear(&idx);
+}
+
+/*
+ * Top-K élagué par bornes de sous-arbre contre parcours complet de l'arbre
+ * (référence : curseur sur toutes les stations, k meilleurs en tableau trié)
+ */
+static void bench_prune(const int* ids, int n) {
+    StationIndex idx;
+    si_init(&idx);
+    for (int i = 0; i < n; i++) si_add(&idx, ids[i], make_info(ids[i]));
+    enum { KMAX = 100, Q = 5 };
+    static const int W[][3] = { { 10, 1, 1 }, { 2, 1, 1 }, { 0, 1, 0 }, { 1, 0, 0 } };
+    static const int KS[] = { 1, 10, 100 };
+    int ref[KMAX], rs[KMAX], out[KMAX];
+
+    printf("[PRUNE] top-k par bornes de sous-arbre (n=%d, AVL)\n", n);
+    printf("  %-18s %4s %10s %10s %12s %s\n", "poids (a,b,g)", "k", "complet ms", "elague ms", "noeuds ouv.", "");
+    for (size_t w = 0; w < sizeof(W) / sizeof(W[0]); w++) {
+        int a = W[w][0], b = W[w][1], g = W[w][2];
+        for (size_t j = 0; j < sizeof(KS) / sizeof(KS[0]); j++) {
+            int k = KS[j], cnt = 0, got = 0, visited = 0;
+            double t0 = now_sec();
+            for (int q = 0; q < Q; q++) {
+                SiIter it;
+                si_iter_seek(&it, &idx, INT_MIN, INT_MAX);
+                cnt = 0;
+                for (StationNode* s; (s = si_iter_next(&it)); ) {
+                    int sc = s->info.slots_free * a + s->info.power_kW * b - s->info.price_cents * g;
+                    if (cnt == k && sc <= rs[k - 1]) continue;
+                    int p = cnt < k ? cnt++ : k - 1;
+                    // IDs croissants : à score égal, la station déjà retenue reste devant
+                    while (p > 0 && rs[p - 1] < sc) { rs[p] = rs[p - 1]; ref[p] = ref[p - 1]; p--; }
+                    rs[p] = sc; ref[p] = s->station_id;
+                }
+            }
+            double t1 = now_sec();
+            for (int q = 0; q < Q; q++) got = si_top_k_pruned(idx.root, k, out, a, b, g, &visited);
+            double t2 = now_sec();
+            int same = got == cnt && memcmp(out, ref, sizeof(int) * (size_t)cnt) == 0;
+            char wl[24];
+            snprintf(wl, sizeof(wl), "(%d,%d,%d)", a, b, g);
+            printf("  %-18s %4d %10.2f %10.3f %12d %s\n", wl, k, (t1 - t0) * 1e3 / Q,
+                   (t2 - t1) * 1e3 / Q, visited, same ? "" : "DIFFERENTS");
+        }
+    }
+    si_clear(&idx);
+}
+
+/*
+ * Plus proches voisins : arbre k-d contre balayage de toutes les positions
+ * (stations réparties sur la France métropolitaine, requêtes aux mêmes points)
+ */
+static void bench_geo(const int* ids, int n) {
+    StationIndex idx;
+    si_init(&idx);
+    si_enable_lookup(&idx);
+    for (int i = 0; i < n; i++) si_add(&idx, ids[i], make_info(ids[i]));
+    GeoPoint* pts = (GeoPoint*)malloc(sizeof(GeoPoint) * n);
+    double* xyz = (double*)malloc(sizeof(double) * 3 * (size_t)n);
+    if (!pts || !xyz) { free(pts); free(xyz); si_clear(&idx); return; }
+    unsigned seed = 7u;
+    for (int i = 0; i < n; i++) {
+        seed = seed * 1103515245u + 12345u;
+        pts[i].station_id = ids[i];
+        pts[i].lat = 42.3 + (double)(seed >> 8) / (1u << 24) * 8.8;
+        seed = seed * 1103515245u + 12345u;
+        pts[i].lon = -4.8 + (double)(seed >> 8) / (1u << 24) * 13.0;
+        double a = pts[i].lat * 0.017453292519943295, b = pts[i].lon * 0.017453292519943295;
+        xyz[3 * i] = cos(a) * cos(b); xyz[3 * i + 1] = cos(a) * sin(b); xyz[3 * i + 2] = sin(a);
+    }
+    double t0 = now_sec();
+    int ok = si_enable_geo(&idx, pts, n);
+    double t1 = now_sec();
+    printf("[GEO] plus proches stations (n=%d, arbre k-d %s)\n", n, ok ? "actif" : "ECHEC");
+    report("si_enable_geo", t1 - t0, n);
+    if (!ok) { free(pts); free(xyz); si_clear(&idx); return; }
+
+    enum { K = 10, Q = 200, SCANS = 5 };
+    static const int F[][2] = { { INT_MIN, INT_MIN }, { 5, 150 }, { 8, 340 } };
+    static const char* fnames[] = { "sans filtre", "slots>=5, power>=150", "slots>=8, power>=340" };
+    int out[K], ref[K];
+    double rd[K];
+    for (int f = 0; f < 3; f++) {
+        int ms = F[f][0], mp = F[f][1], same = 1;
+        double t2 = now_sec();
+        for (int q = 0; q < SCANS; q++) {
+            const double* c = &xyz[3 * (size_t)((q * 7919) % n)];
+            int cnt = 0;
+            for (int i = 0; i < n; i++) {
+                StationInfo in = make_info(pts[i].station_id);
+                if (in.slots_free < ms || in.power_kW < mp) continue;
+                double dx = xyz[3 * i] - c[0], dy = xyz[3 * i + 1] - c[1], dz = xyz[3 * i + 2] - c[2];
+                double d = dx * dx + dy * dy + dz * dz;
+                if (cnt == K && d >= rd[K - 1]) continue;
+                int p = cnt < K ? cnt++ : K - 1;
+                while (p > 0 && rd[p - 1] > d) { rd[p] = rd[p - 1]; ref[p] = ref[p - 1]; p--; }
+                rd[p] = d; ref[p] = pts[i].station_id;
+            }
+            const GeoPoint* g = &pts[(q * 7919) % n];
+            int got = si_nearest_idx(&idx, g->lat, g->lon, K, ms, mp, out, NULL);
+            same = same && got == cnt && memcmp(out, ref, sizeof(int) * (size_t)cnt) == 0;
+        }
+        double t3 = now_sec();
+        for (int q = 0; q < Q; q++) {
+            const GeoPoint* g = &pts[(q * 7919) % n];
+            si_nearest_idx(&idx, g->lat, g->lon, K, ms, mp, out, NULL);
+        }
+        double t4 = now_sec();
+        printf("  top-%d %s%s\n", K, fnames[f], same ? "" : " : resultats DIFFERENTS");
+        report("  balayage complet", t3 - t2, SCANS);
+        report("  si_nearest_idx", t4 - t3, Q);
+    }
+
+    int* buf = (int*)malloc(sizeof(int) * n);
+    if (buf) {
+        long long found = 0;
+        double t5 = now_sec();
+        for (int q = 0; q < Q; q++) {
+            const GeoPoint* g = &pts[(q * 7919) % n];
+            found += si_within_radius_idx(&idx, g->lat, g->lon, 5.0, 1, INT_MIN, buf, NULL, n);
+        }
+        double t6 = now_sec();
+        printf("  rayon 5 km, slots>=1 : %.1f stations en moyenne\n", (double)found / Q);
+        report("  si_within_radius_idx", t6 - t5, Q);
+        free(buf);
+    }
+
+    /* Événements : la mise à jour réécrit aussi les maxima du chemin k-d */
+    double t7 = now_sec();
+    for (int i = 0; i < n; i++) si_add(&idx, ids[i], make_info(ids[i] + 1));
+    double t8 = now_sec();
+    report("si_add avec index geo", t8 - t7, n);
+    free(pts);
+    free(xyz);
+    si_clear(&idx);
+}
+
+/*
+ * Top-K et comptage parallèles : courbe d'accélération selon le nombre de
+ * threads du pool (arbre AVL, puis instantané colonnaire)
+ */
+static void bench_par(const int* ids, int n) {
+    StationIndex idx;
+    si_init(&idx);
+    for (int i = 0; i < n; i++) si_add(&idx, ids[i], make_info(ids[i]));
+    enum { K = 10, Q = 5 };
+    int ref[K], out[K];
+    static const int threads[] = { 1, 2, 4, 8, 16, 32 };
+
+    printf("[PAR] top-%d / power >= P sur un pool de threads (n=%d)\n", K, n);
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 1 && !si_enable_columns(&idx)) break;
+        int cnt = si_top_k_idx(&idx, K, ref, 2, 1, 1);
+        int ref_count = si_count_ge_power_idx(&idx, 200);
+        double base_topk = 0, base_count = 0;
+        printf("  %s\n", pass ? "colonnes" : "arbre AVL");
+        printf("  %8s %14s %9s %14s %9s\n", "threads", "top-k ms/op", "acc.", "count ms/op", "acc.");
+        for (int t = 0; t < (int)(sizeof(threads) / sizeof(threads[0])); t++) {
+            ThreadPool* pool = tp_create(threads[t]);
+            if (!pool) break;
+            int same = 1;
+            double a = now_sec();
+            for (int q = 0; q < Q; q++) {
+                int c = si_top_k_par(&idx, pool, K, out, 2, 1, 1);
+                same = same && c == cnt && memcmp(out, ref, sizeof(int) * (size_t)c) == 0;
+            }
+            double b = now_sec();
+            for (int q = 0; q < Q; q++) same = same && si_count_ge_power_par(&idx, pool, 200) == ref_count;
+            double c = now_sec();
+            tp_destroy(pool);
+            double topk = (b - a) * 1e3 / Q, count = (c - b) * 1e3 / Q;
+            if (t == 0) { base_topk = topk; base_count = count; }
+            printf("  %8d %14.2f %8.2fx %14.2f %8.2fx%s\n", threads[t], topk, base_topk / topk,
+                   count, base_count / count, same ? "" : "  resultats DIFFERENTS");
+        }
+    }
+    si_clear(&idx);
+}
+
+/*
+ * Fonction auxiliaire : apply_plug
+ * Description : Modification appliquée par un événement de branchement /
+ *               débranchement (ctx : action, 1 = branchement)
+ */
+static void apply_plug(StationInfo* info, void* ctx) {
+    int action = *(const int*)ctx;
+    if (action == 1) { if (info->slots_free > 0) info->slots_free--; }
+    else info->slots_free++;
+}
+
+/*
+ * Section : rejeu d'événements type heure de pointe
+ * si_find + copie + si_add (avant) contre si_update en place
+ */
+static void bench_events(const int* ids, int n) {
+    StationIndex idx;
+    si_init(&idx);
+    for (int i = 0; i < n; i++) si_add(&idx, ids[i], make_info(ids[i]));
+
+    int events = 2 * n;
+    StationInfo dflt = make_info(0);
+
+    double t0 = now_sec();
+    for (int i = 0; i < events; i++) {
+        int id = ids[(int)(((long)i * 7919) % n)], action = i % 3 != 0;
+        StationNode* sn = si_find(idx.root, id);
+        StationInfo info = sn ? sn->info : dflt;
+        apply_plug(&info, &action);
+        si_add(&idx, id, info);
+    }
+    double t1 = now_sec();
+    for (int i = 0; i < events; i++) {
+        int id = ids[(int)(((long)i * 7919) % n)], action = i % 3 != 0;
+        si_update(&idx, id, &dflt, apply_plug, &action);
+    }
+    double t2 = now_sec();
+
+    printf("[EVENTS] rejeu de %d evenements sur %d stations\n", events, n);
+    report("si_find + si_add", t1 - t0, events);
+    report("si_update (en place)", t2 - t1, events);
+    si_clear(&idx);
+}
+
+/*
+ * Parcours complet et pagination : tableau d'IDs + si_find_idx contre curseur
+ * (les deux backends)
+ */
+static void bench_iter(const int* ids, int n, SiBackend backend) {
+    StationIndex idx;
+    si_init_backend(&idx, backend);
+    for (int i = 0; i < n; i++) si_add(&idx, ids[i], make_info(ids[i]));
+    enum { PAGE = 50, PAGES = 10000 };
+    int* buf = (int*)malloc(sizeof(int) * n);
+    if (!buf) { si_clear(&idx); return; }
+
+    long long s0 = 0, s1 = 0, p0 = 0, p1 = 0;
+    double t0 = now_sec();
+    int m = si_to_array_idx(&idx, buf, n);
+    for (int i = 0; i < m; i++) s0 += si_find_idx(&idx, buf[i])->info.slots_free;
+    double t1 = now_sec();
+    SiIter it;
+    si_iter_seek(&it, &idx, INT_MIN, INT_MAX);
+    for (StationNode* s; (s = si_iter_next(&it)); ) s1 += s->info.slots_free;
+    double t2 = now_sec();
+    /* Pages de 50 stations à des positions dispersées */
+    for (int p = 0; p < PAGES; p++) {
+        int lo = 1001 + (int)(((long)p * 7919) % n), got = si_range_ids_idx(&idx, lo, INT_MAX, buf, PAGE);
+        for (int i = 0; i < got; i++) p0 += si_find_idx(&idx, buf[i])->info.slots_free;
+    }
+    double t3 = now_sec();
+    for (int p = 0; p < PAGES; p++) {
+        si_iter_seek(&it, &idx, 1001 + (int)(((long)p * 7919) % n), INT_MAX);
+        StationNode* s;
+        for (int i = 0; i < PAGE && (s = si_iter_next(&it)); i++) p1 += s->info.slots_free;
+    }
+    double t4 = now_sec();
+
+    printf("[ITER] parcours par ID croissant (n=%d, %s, resultats %s)\n", n,
+           backend == SI_BACKEND_BPTREE ? "B+" : "AVL", s0 == s1 && p0 == p1 ? "identiques" : "DIFFERENTS");
+    report("si_to_array_idx + si_find_idx", t1 - t0, m);
+    report("si_iter_next", t2 - t1, m);
+    report("page: si_range_ids_idx + find", t3 - t2, PAGES);
+    report("page: si_iter_seek + next", t4 - t3, PAGES);
+    free(buf);
+    si_clear(&idx);
+}
+
+/*
+ * Lot de plages (tableau de bord) : une requête par plage contre un parcours
+ * unique de l'union (plages qui se chevauchent deux à deux)
+ */
+static void bench_batch(const int* ids, int n, SiBackend backend) {
+    StationIndex idx;
+    si_init_backend(&idx, backend);
+    for (int i = 0; i < n; i++) si_add(&idx, ids[i], make_info(ids[i]));
+    enum { R = 48, Q = 100 };
+    SiRange rg[R];
+    int off[R], cnt[R];
+    int width = n / 200 > 10 ? n / 200 : 10;
+    for (int i = 0; i < R; i++) {
+        rg[i].lo = 1001 + (int)(((long)i * 7919 * 13) % n);
+        rg[i].hi = rg[i].lo + width;
+        if (i % 2) { rg[i].lo = rg[i - 1].lo + width / 2; rg[i].hi = rg[i].lo + width; }
+    }
+    int* arena = (int*)malloc(sizeof(int) * (size_t)R * (width + 1));
+    int* out = (int*)malloc(sizeof(int) * (size_t)(width + 1));
+    if (!arena || !out) { free(arena); free(out); si_clear(&idx); return; }
+
+    long long sep = 0, bat = 0;
+    double t0 = now_sec();
+    for (int q = 0; q < Q; q++)
+        for (int i = 0; i < R; i++) sep += si_range_ids_idx(&idx, rg[i].lo, rg[i].hi, out, width + 1);
+    double t1 = now_sec();
+    int total = 0;
+    for (int q = 0; q < Q; q++) {
+        total = si_range_ids_batch(&idx, rg, R, arena, R * (width + 1), off, cnt);
+        for (int i = 0; i < R; i++) bat += cnt[i];
+    }
+    double t2 = now_sec();
+
+    printf("[BATCH] %d plages de %d IDs, chevauchantes (n=%d, %s, union=%d, resultats %s)\n",
+           R, width + 1, n, backend == SI_BACKEND_BPTREE ? "B+" : "AVL", total,
+           sep == bat ? "identiques" : "DIFFERENTS");
+    report("si_range_ids_idx x plages", t1 - t0, Q);
+    report("si_range_ids_batch", t2 - t1, Q);
+    free(arena);
+    free(out);
+    si_clear(&idx);
+}
+
+/*
+ * Vue top-k maintenue : rafales d'événements suivies d'une lecture du top-5,
+ * contre un recalcul complet après chaque rafale
+ */
+static void bench_view(const int* ids, int n) {
+    StationIndex idx;
+    si_init(&idx);
+    for (int i = 0; i < n; i++) si_add(&idx, ids[i], make_info(ids[i]));
+    enum { K = 5, BURSTS = 20, BURST = 1000 };
+    int ref[K], out[K];
+    StationInfo dflt = make_info(0);
+
+    /* Référence : mêmes événements sans vue enregistrée */
+    double s0 = now_sec();
+    for (int e = 0; e < BURSTS * BURST; e++) {
+        int id = ids[(int)(((long)e * 7919) % n)], action = e % 3 == 0;
+        si_update(&idx, id, &dflt, apply_plug, &action);
+    }
+    double t0 = now_sec();
+    TopKView* view = si_view_register(&idx, K, 2, 1, 1);
+    double t1 = now_sec();
+    if (!view) { si_clear(&idx); return; }
+
+    double ev = 0, rd = 0, full = 0;
+    int same = 1;
+    for (int b = 0; b < BURSTS; b++) {
+        double a = now_sec();
+        for (int i = 0; i < BURST; i++) {
+            int e = b * BURST + i;
+            int id = ids[(int)(((long)e * 7919) % n)], action = e % 3 != 0;
+            si_update(&idx, id, &dflt, apply_plug, &action);
+        }
+        double c = now_sec();
+        int cnt = si_view_read(&idx, view, out);
+        double d = now_sec();
+        int cref = si_top_k_by_score(idx.root, K, ref, 2, 1, 1);
+        double e = now_sec();
+        same = same && cnt == cref && memcmp(out, ref, sizeof(int) * (size_t)cnt) == 0;
+        ev += c - a; rd += d - c; full += e - d;
+    }
+
+    printf("[VIEW] top-%d maintenu, %d rafales de %d evenements (n=%d, resultats %s)\n",
+           K, BURSTS, BURST, n, same ? "identiques" : "DIFFERENTS");
+    report("si_update (sans vue)", t0 - s0, BURSTS * BURST);
+    report("si_view_register", t1 - t0, n);
+    report("si_update (vue a jour)", ev, BURSTS * BURST);
+    report("si_view_read", rd, BURSTS);
+    report("si_top_k_by_score (recalcul)", full, BURSTS);
+    si_clear(&idx);
+}
+
+/*
+ * Cache de résultats : mêmes requêtes répétées, entre lesquelles un
+ * événement touche une station hors de la plage des règles
+ */
+static void bench_cache(const int* ids, int n) {
+    StationIndex idx;
+    si_init(&idx);
+    si_enable_lookup(&idx);
+    for (int i = 0; i < n; i++) si_add(&idx, ids[i], make_info(ids[i]));
+    QueryCache qc;
+    if (!qc_init(&qc, 256)) { si_clear(&idx); return; }
+    enum { K = 10, CAP = 50, Q = 2000 };
+    char* rule[] = { "slots", "4", ">=", "power", "300", ">=", "&&" };
+    int lo = 1001, hi = 1001 + n / 2, far = n / 2 + n / 4;
+    int out[CAP], ref[CAP], same = 1;
+    StationInfo dflt = make_info(0);
+
+    double t[8];
+    t[0] = now_sec();
+    for (int q = 0; q < Q; q++) si_rule_ids(&idx, rule, 7, lo + q % 64, hi, ref, CAP);
+    t[1] = now_sec();
+    for (int q = 0; q < 64; q++) qc_rule_ids(&qc, &idx, rule, 7, lo + q, hi, out, CAP);
+    double warm = now_sec();
+    for (int q = 0; q < Q; q++) qc_rule_ids(&qc, &idx, rule, 7, lo + q % 64, hi, out, CAP);
+    t[2] = now_sec();
+    /* Événement hors plage entre deux requêtes : seules les versions de
+     * plage gardent le résultat valide */
+    for (int q = 0; q < Q; q++) {
+        int id = 1001 + far + q % (n / 8), action = q % 2;
+        si_update(&idx, id, &dflt, apply_plug, &action);
+        int c = qc_rule_ids(&qc, &idx, rule, 7, lo + q % 64, hi, out, CAP);
+        if (q % 97 == 0) {
+            int cr = si_rule_ids(&idx, rule, 7, lo + q % 64, hi, ref, CAP);
+            same = same && c == cr && memcmp(out, ref, sizeof(int) * (size_t)c) == 0;
+        }
+    }
+    t[3] = now_sec();
+    long long rule_hits = qc.hits, rule_misses = qc.misses;
+
+    qc.hits = qc.misses = 0;
+    t[4] = now_sec();
+    for (int q = 0; q < Q / 20; q++) si_top_k_idx(&idx, K, ref, 2, 1, 1);
+    qc_top_k(&qc, &idx, K, out, 2, 1, 1);
+    t[5] = now_sec();
+    for (int q = 0; q < Q; q++) {
+        int c = qc_top_k(&qc, &idx, K, out, 4 - 2 * (q % 2), 2 - (q % 2), 2 - (q % 2));
+        same = same && c == K && memcmp(out, ref, sizeof(int) * K) == 0;
+    }
+    t[6] = now_sec();
+    /* Top-k : toute écriture peut changer le classement, l'entrée expire */
+    for (int q = 0; q < Q / 20; q++) {
+        int id = 1001 + far + q, action = q % 2;
+        si_update(&idx, id, &dflt, apply_plug, &action);
+        qc_top_k(&qc, &idx, K, out, 2, 1, 1);
+    }
+    t[7] = now_sec();
+
+    printf("[CACHE] requetes repetees (n=%d, resultats %s)\n", n, same ? "identiques" : "DIFFERENTS");
+    report("regle: si_rule_ids", t[1] - t[0], Q);
+    report("regle: qc_rule_ids (succes)", t[2] - warm, Q);
+    report("regle: ecriture hors plage+qc", t[3] - t[2], Q);
+    printf("  %-28s %lld succes / %lld echecs\n", "regle: cache", rule_hits, rule_misses);
+    report("top-k: si_top_k_idx", t[5] - t[4], Q / 20);
+    report("top-k: qc_top_k (succes)", t[6] - t[5], Q);
+    report("top-k: ecriture+qc_top_k", t[7] - t[6], Q / 20);
+    printf("  %-28s %lld succes / %lld echecs\n", "top-k: cache", qc.hits, qc.misses);
+    qc_clear(&qc);
+    si_clear(&idx);
+}
+
+/*
+ * Évaluation d'une règle sur chaque station : tokens (compilés à chaque
+ * appel par eval_rule_postfix), programme compilé une fois, puis blocs de
+ * 64 stations sur l'instantané colonnaire (bitmap ou simple comptage)
+ */
+static void bench_rules(int n) {
+    StationInfo* infos = (StationInfo*)malloc(sizeof(StationInfo) * (size_t)n);
+    StationColumns cols;
+    sc_init(&cols);
+    if (!infos) return;
+    for (int i = 0; i < n; i++) {
+        infos[i] = make_info(1001 + i);
+        sc_set(&cols, 1001 + i, &infos[i]);
+    }
+    static char* R0[] = { "slots", "1", ">=", "power", "50", ">=", "&&" };
+    static char* R1[] = { "slots", "1", ">=", "power", "50", ">=", "&&", "price", "400", "<=", "&&",
+                          "power", "300", "<", "slots", "6", ">", "||", "&&", "price", "150", ">", "&&",
+                          "50", "power", "<=", "price", "200", ">=", "||", "&&" };
+    static char* R2[] = { "power", "price", "<", "slots", "3", "==", "||" };
+    static char* R3[] = { "price", "150", ">=", "power", "22", ">=", "&&", "slots", "0", ">=", "&&",
+                          "price", "549", "<=", "&&", "power", "349", "<=", "&&", "slots", "8", "<=", "&&",
+                          "price", "100", ">", "&&", "power", "0", ">", "&&", "slots", "9", "<", "&&",
+                          "power", "340", ">=", "&&" };
+    static struct { char** t; int n; } RULES[] = { { R0, 7 }, { R1, 31 }, { R2, 7 }, { R3, 39 } };
+    static const char* LEVELS[] = { "scalaire", "SSE4.1", "AVX2" };
+    RuleBitmap bm;
+    rb_init(&bm);
+
+    printf("[RULES] evaluation d'une regle sur chaque station (n=%d, SIMD max : %s)\n",
+           n, LEVELS[sc_simd_best()]);
+    for (size_t r = 0; r < sizeof(RULES) / sizeof(RULES[0]); r++) {
+        char** t = RULES[r].t;
+        int tn = RULES[r].n, a = 0, b = 0, same = 1;
+        RuleProgram prog;
+        double t0 = now_sec();
+        for (int i = 0; i < n; i++) a += eval_rule_postfix(t, tn, &infos[i]);
+        double t1 = now_sec();
+        rule_compile(t, tn, &prog);
+        for (int i = 0; i < n; i++) b += rule_eval(&prog, &infos[i]);
+        double t2 = now_sec();
+        char what[64];
+        snprintf(what, sizeof(what), "%d tokens: eval_rule_postfix", tn);
+        report(what, t1 - t0, n);
+        snprintf(what, sizeof(what), "%d tokens: rule_eval (%d ins.)", tn, prog.len);
+        report(what, t2 - t1, n);
+        RuleOpt opt;
+        ro_build(&opt, &prog);
+        int o = 0;
+        double to = now_sec();
+        for (int i = 0; i < n; i++) o += ro_eval(&opt, &infos[i]);
+        double to2 = now_sec();
+        snprintf(what, sizeof(what), "%d tokens: ro_eval", tn);
+        report(what, to2 - to, n);
+        char ex[320];
+        ro_explain(&opt, ex, (int)sizeof(ex));
+        printf("    %s\n", ex);
+        for (int l = SC_SIMD_SCALAR; l <= (int)sc_simd_best(); l++) {
+            double t3 = now_sec();
+            rb_eval_level(&bm, &prog, &cols, (ScSimd)l);
+            double t4 = now_sec();
+            snprintf(what, sizeof(what), "%d tokens: rb_eval %s", tn, LEVELS[l]);
+            report(what, t4 - t3, n);
+            same = same && rb_count(&bm) == b;
+        }
+        double t5 = now_sec();
+        int c = rb_count_rule(&prog, &cols);
+        double t6 = now_sec();
+        snprintf(what, sizeof(what), "%d tokens: rb_count_rule", tn);
+        report(what, t6 - t5, n);
+        same = same && a == b && c == b && o == b;
+        printf("  %-28s %d / %d %s\n", "stations retenues", b, n, same ? "" : "DIFFERENTS");
+    }
+    rb_clear(&bm);
+    sc_clear(&cols);
+    free(infos);
+}
+
+/* Événement de la section subs : branchement ou nouveau prix, état précédent gardé */
+typedef struct SubEvent {
+    int price;              /* 0 : branchement / débranchement selon plug */
+    int plug;
+    StationInfo old;
+} SubEvent;
+
+static void apply_sub_event(StationInfo* info, void* ctx) {
+    SubEvent* e = (SubEvent*)ctx;
+    e->old = *info;
+    if (e->price) info->price_cents = e->price;
+    else apply_plug(info, &e->plug);
+}
+
+/* Notification d'abonnement : solde entrées - sorties de chaque règle */
+static void count_notify(void* ctx, const RuleSub* sub, int station_id, int entered) {
+    (void)sub; (void)station_id;
+    *(int*)ctx += entered ? 1 : -1;
+}
+
+/*
+ * Abonnements : S règles permanentes tenues à jour à chaque événement
+ * (branchements : places libres ; un sur dix : prix), contre la réévaluation
+ * de toutes les règles sur la station modifiée, avant et après l'événement
+ */
+static void bench_subs(const int* ids, int n) {
+    enum { S = 120, E = 200000 };
+    StationIndex idx;
+    si_init(&idx);
+    si_enable_lookup(&idx);
+    for (int i = 0; i < n; i++) si_add(&idx, ids[i], make_info(ids[i]));
+    static char num[S][2][12];
+    static char* toks[S][7];
+    static RuleProgram progs[S];
+    static int balance[S], start[S];
+    StationInfo dflt = make_info(0);
+
+    // Un tiers des règles lit les places libres, les autres la puissance et le prix
+    for (int r = 0; r < S; r++) {
+        snprintf(num[r][0], 12, "%d", 22 + (r * 97) % 320);
+        snprintf(num[r][1], 12, "%d", r % 3 == 0 ? 1 + r % 8 : 150 + (r * 53) % 400);
+        char** t = toks[r];
+        t[0] = "power"; t[1] = num[r][0]; t[2] = ">=";
+        t[3] = r % 3 == 0 ? "slots" : "price"; t[4] = num[r][1]; t[5] = r % 3 == 0 ? ">=" : "<="; t[6] = "&&";
+        rule_compile(t, 7, &progs[r]);
+    }
+
+    // Références : événements seuls, puis réévaluation de toutes les règles sur la station modifiée
+    double tb = now_sec();
+    for (int e = 0; e < E; e++) {
+        int id = ids[(int)(((long)e * 7919) % n)];
+        SubEvent ev = { e % 10 ? 0 : 150 + (e * 7) % 400, e % 3 == 0, make_info(0) };
+        si_update(&idx, id, &dflt, apply_sub_event, &ev);
+    }
+    double t0 = now_sec();
+    long long moves = 0;
+    for (int e = 0; e < E; e++) {
+        int id = ids[(int)(((long)e * 7919) % n)];
+        SubEvent ev = { e % 10 ? 0 : 150 + (e * 31) % 400, e % 3 == 0, make_info(0) };
+        StationNode* s = si_update(&idx, id, &dflt, apply_sub_event, &ev);
+        for (int r = 0; r < S; r++) moves += rule_eval(&progs[r], &ev.old) != rule_eval(&progs[r], &s->info);
+    }
+    double t1 = now_sec();
+
+    RuleSub* subs[S];
+    for (int r = 0; r < S; r++) {
+        subs[r] = si_sub_register(&idx, toks[r], 7, count_notify, &balance[r]);
+        if (!subs[r]) { si_clear(&idx); return; }
+        start[r] = si_sub_count(&idx, subs[r]);
+    }
+    double t2 = now_sec();
+    for (int e = 0; e < E; e++) {
+        int id = ids[(int)(((long)e * 7919) % n)];
+        SubEvent ev = { e % 10 ? 0 : 150 + (e * 17) % 400, e % 3 != 0, make_info(0) };
+        si_update(&idx, id, &dflt, apply_sub_event, &ev);
+    }
+    double t3 = now_sec();
+
+    // Contrôle : ensemble = état initial + entrées - sorties = recalcul complet
+    int same = 1;
+    for (int r = 0; r < S; r++) same = same && si_sub_count(&idx, subs[r]) == start[r] + balance[r];
+    double t4 = now_sec();
+    for (int r = 0; r < S; r += S / 10) same = same && si_sub_count(&idx, subs[r]) == si_rule_count(&idx, toks[r], 7);
+    double t5 = now_sec();
+
+    printf("[SUBS] %d regles abonnees, %d evenements (n=%d, ensembles %s)\n",
+           S, E, n, same ? "identiques" : "DIFFERENTS");
+    report("si_update (sans regle)", t0 - tb, E);
+    report("si_update + 2S rule_eval", t1 - t0, E);
+    report("si_sub_register", t2 - t1, S);
+    report("si_update (abonnements)", t3 - t2, E);
+    report("si_rule_count (recalcul)", t5 - t4, 10);
+    printf("  regles reevaluees par evenement : %d (places), %d (prix) sur %d ; %lld entrees / sorties (reference)\n",
+           idx.subs->ndep[RULE_SLOTS], idx.subs->ndep[RULE_PRICE], S, moves);
+    si_clear(&idx);
+}
+
+// Empreinte du contenu d'un index : (ID, StationInfo) de chaque station, par ID croissant
+static unsigned long long index_digest(const StationIndex* idx) {
+    unsigned long long h = 1469598103934665603ULL;
+    SiIter it;
+    si_iter_seek(&it, idx, INT_MIN, INT_MAX);
+    for (StationNode* s; (s = si_iter_next(&it)); ) {
+        int v[5] = { s->station_id, s->info.power_kW, s->info.price_cents, s->info.slots_free, s->info.last_ts };
+        for (int i = 0; i < 5; i++) h = (h ^ (unsigned)v[i]) * 1099511628211ULL;
+    }
+    return h;
+}
+
+/*
+ * Contrôle des chargeurs mmap et parallèle sur un fichier de plusieurs
+ * morceaux : champs entre guillemets avec virgules, "" et retours à la ligne,
+ * fins de ligne \r\n, lignes courtes (ignorées), guillemet isolé hors
+ * RFC 4180, IDs répétés dans tout le fichier (la dernière ligne gagne, même
+ * à cheval sur les coupes) ; puis fichier réduit à l'en-tête et fichier vide
+ */
+static void bench_csv_check(void) {
+    enum { ROWS = 20000, IDS = 5000 };
+    static const char* const ADDR[] = { "1 rue de la Paix", "\"12, rue des Lilas\"", "\"dit \"\"Le Relais\"\"\"",
+                                        "\"bat. B\nau fond, a gauche\"", "8 place Bellecour", "2 allee \"Verte" };
+    static int expect[IDS];
+    int kept = 0;
+    const char* path = "bench_fixture.csv";
+    FILE* out = fopen(path, "wb");
+    if (!out) return;
+    memset(expect, 0, sizeof(expect));
+    fputs("id_station_itinerance,nom_operateur,nom_station,\"adresse,\nstation\",code_insee_commune,"
+          "puissance_nominale,nbre_pdc,condition_acces,latitude,longitude\n", out);
+    for (int i = 0; i < ROWS; i++) {
+        int id = (int)((i * 7919LL) % IDS), power = 1 + i % 997, k = i % 6;
+        if (i % 30 == 5) { fprintf(out, "FRIZI_%d,IZIVIA,court,%s\n", id, ADDR[1]); continue; }
+        fprintf(out, "FRIZI_%d,IZIVIA,Station %d,%s,42000,%d,%d,ACCES_LIBRE,%.5f,%.5f%s", id, i, ADDR[k], power,
+                i % 9, 45 + (i % 100) * 0.01, 4 + (i % 70) * 0.01, k == 4 ? "\r\n" : "\n");
+        expect[id] = power;
+        kept++;
+    }
+    long size = ftell(out);
+    fclose(out);
+
+    StationIndex ref;
+    si_init(&ref);
+    int cr = ds_load_stations_from_csv_mmap(path, &ref);
+    int ok = cr == kept;
+    for (int id = 0; id < IDS && ok; id++) {
+        StationNode* n = si_find_idx(&ref, id);
+        ok = expect[id] ? n && n->info.power_kW == expect[id] : !n;
+    }
+    unsigned long long h = index_digest(&ref);
+    si_clear(&ref);
+    static const int threads[] = { 0, 1, 2, 4 };   // 0 : sans pool
+    for (int t = 0; t < 4; t++) {
+        ThreadPool* pool = threads[t] ? tp_create(threads[t]) : NULL;
+        StationIndex d;
+        si_init(&d);
+        int cd = ds_load_stations_from_csv_par(path, &d, pool);
+        if (cd != cr || index_digest(&d) != h) ok = 0;
+        si_clear(&d);
+        tp_destroy(pool);
+    }
+
+    // En-tête seul : aucune station ; fichier vide : échec des deux chargeurs
+    static const char* const SMALL[] = { "id,a,b,c,d,power,slots,e,lat,lon\r\n", "" };
+    for (int f = 0; f < 2; f++) {
+        out = fopen(path, "wb");
+        if (!out) break;
+        fputs(SMALL[f], out);
+        fclose(out);
+        StationIndex a, b;
+        si_init(&a);
+        si_init(&b);
+        int ca = ds_load_stations_from_csv_mmap(path, &a), cb = ds_load_stations_from_csv_par(path, &b, NULL);
+        if (ca != (f ? -1 : 0) || cb != ca || a.root || b.root) ok = 0;
+        si_clear(&a);
+        si_clear(&b);
+    }
+    remove(path);
+    printf("  controle mmap / parallele (%ld Ko, 0 a 4 threads, cas limites) : %s\n", size / 1024,
+           ok ? "identiques" : "DIFFERENTS");
+}
+
+/*
+ * Chargement CSV : fichier synthétique de rows lignes (lignes de
+ * izivia_tp_subset.csv recopiées en boucle, IDs renumérotés), chargé par
+ * fgets + strtok puis par projection mémoire
+ */
+static void bench_csv(int rows) {
+    const char* src = "izivia_tp_subset.csv", * path = "bench_stations.csv";
+    FILE* in = fopen(src, "r");
+    if (!in) { printf("[CSV] %s introuvable\n", src); return; }
+    static char lines[512][512];
+    char header[512];
+    int nl = 0;
+    if (!fgets(header, sizeof(header), in)) { fclose(in); return; }
+    while (nl < 512 && fgets(lines[nl], sizeof(lines[nl]), in)) {
+        if (strchr(lines[nl], ',')) nl++;
+    }
+    fclose(in);
+    FILE* out = fopen(path, "w");
+    if (!out || nl == 0) { if (out) fclose(out); return; }
+
+    double t0 = now_sec();
+    fputs(header, out);
+    // IDs renumérotés ; positions décalées à chaque tour (points distincts)
+    for (int i = 0; i < rows; i++) {
+        char row[512], * col[10];
+        int nc = 0, k = i / nl;
+        strcpy(row, strchr(lines[i % nl], ',') + 1);
+        for (char* tok = strtok(row, ",\r\n"); tok && nc < 10; tok = strtok(NULL, ",\r\n")) col[nc++] = tok;
+        if (nc < 9) continue;
+        fprintf(out, "FRIZI_%d,%s,%s,%s,%s,%s,%s,%s,%.6f,%.6f\n", 1 + i, col[0], col[1], col[2], col[3], col[4],
+                col[5], col[6], atof(col[7]) + (k % 1000) * 1e-4, atof(col[8]) + (k / 1000) * 1e-4);
+    }
+    long size = ftell(out);
+    fclose(out);
+    double t1 = now_sec();
+
+    StationIndex a, b, c;
+    si_init(&a);
+    int ca = ds_load_stations_from_csv(path, &a);
+    double t2 = now_sec();
+    si_clear(&a);
+    double t3 = now_sec();
+    si_init(&b);
+    int cb = ds_load_stations_from_csv_mmap(path, &b);
+    double t4 = now_sec();
+    unsigned long long hb = index_digest(&b);
+    si_clear(&b);
+
+    // Lecture seule, puis construction seule (commune aux deux chargeurs)
+    StationEntry* entries = NULL;
+    GeoPoint* pts = NULL;
+    int located = 0;
+    double t5 = now_sec();
+    int cr = ds_read_stations_csv(path, &entries, &pts, &located);
+    double t6 = now_sec();
+    si_init(&c);
+    if (cr >= 0 && si_build_sorted(&c, entries, cr) >= 0) si_enable_geo(&c, pts, located);
+    double t7 = now_sec();
+    si_clear(&c);
+    free(entries);
+    free(pts);
+
+    // Chargeur parallèle : tranches alignées sur les lignes, un seul si_build_sorted
+    static const int threads[] = { 1, 2, 4 };
+    double tpar[3];
+    int same = 1;
+    for (int t = 0; t < 3; t++) {
+        ThreadPool* pool = tp_create(threads[t]);
+        StationIndex d;
+        si_init(&d);
+        double s = now_sec();
+        int cd = ds_load_stations_from_csv_par(path, &d, pool);
+        tpar[t] = now_sec() - s;
+        if (cd != cr || !d.geo || index_digest(&d) != hb) same = 0;
+        si_clear(&d);
+        tp_destroy(pool);
+    }
+    remove(path);
+
+    double build = t7 - t6;
+    printf("[CSV] %d lignes, %.0f Mo (generation %.1f s, resultats %s)\n",
+           rows, size / 1e6, t1 - t0, ca == cb && cb == cr && ca == rows ? "identiques" : "DIFFERENTS");
+    report("fgets + strtok + atoi", t2 - t1, rows);
+    report("mmap, une passe", t4 - t3, rows);
+    report("ds_read_stations_csv", t6 - t5, rows);
+    report("construction (index + geo)", build, rows);
+    printf("  %-28s %9.2f M lignes/s -> %.2f M lignes/s (chargement complet %.2f -> %.2f)\n", "lecture seule",
+           rows / (t2 - t1 - build) / 1e6, rows / (t6 - t5) / 1e6, rows / (t2 - t1) / 1e6, rows / (t4 - t3) / 1e6);
+    for (int t = 0; t < 3; t++) {
+        char label[64];
+        snprintf(label, sizeof(label), "parallele, %d thread(s)", threads[t]);
+        report(label, tpar[t], rows);
+    }
+    printf("  chargeur parallele : resultats %s\n", same ? "identiques" : "DIFFERENTS");
+    bench_csv_check();
+}
+
+/*
+ * Planification des règles : curseur naïf (toutes les stations lues jusqu'au
+ * N-ième résultat) contre le plan de si_rule_ids, index secondaires actifs
+ */
+static void bench_plan(const int* ids, int n) {
+    StationIndex idx;
+    si_init(&idx);
+    si_enable_lookup(&idx);
+    for (int i = 0; i < n; i++) si_add(&idx, ids[i], make_info(ids[i]));
+    si_enable_attr_index(&idx);
+    enum { CAP = 1000, Q = 20 };
+    static char* R0[] = { "slots", "1", ">=", "power", "22", ">=", "&&" };
+    static char* R1[] = { "power", "349", ">=", "price", "200", "<=", "&&" };
+    static char* R2[] = { "slots", "8", "==", "power", "340", ">=", "&&" };
+    static char* R3[] = { "price", "548", ">", "power", "30", "<", "||", "slots", "0", ">", "&&" };
+    static char* R4[] = { "power", "100", "<", "100", "power", "<", "&&" };
+    static char* R5[] = { "power", "347", ">=", "slots", "4", "<", "&&" };
+    static struct { char** t; int n; int lo, hi, cap; } RULES[] = {
+        { R0, 7, INT_MIN, INT_MAX, 10 }, { R1, 7, INT_MIN, INT_MAX, 10 }, { R2, 7, INT_MIN, INT_MAX, 10 },
+        { R3, 11, INT_MIN, INT_MAX, 10 }, { R1, 7, 500000, 600000, 10 }, { R4, 7, INT_MIN, INT_MAX, 10 },
+        { R5, 7, INT_MIN, INT_MAX, 10 }, { R5, 7, INT_MIN, INT_MAX, CAP },
+    };
+    int out[CAP], ref[CAP];
+
+    printf("[PLAN] regles postfix, premiers resultats par ID (n=%d, AVL)\n", n);
+    for (size_t r = 0; r < sizeof(RULES) / sizeof(RULES[0]); r++) {
+        char** t = RULES[r].t;
+        int tn = RULES[r].n, lo = RULES[r].lo, hi = RULES[r].hi, cap = RULES[r].cap, cnt = 0, got = 0;
+        double t0 = now_sec();
+        for (int q = 0; q < Q; q++) {
+            SiIter it;
+            si_iter_seek(&it, &idx, lo, hi);
+            cnt = 0;
+            for (StationNode* s; cnt < cap && (s = si_iter_next(&it)); )
+                if (eval_rule_postfix(t, tn, &s->info)) ref[cnt++] = s->station_id;
+        }
+        double t1 = now_sec();
+        for (int q = 0; q < Q; q++) got = si_rule_ids(&idx, t, tn, lo, hi, out, cap);
+        double t2 = now_sec();
+        RulePlan plan;
+        char ex[256];
+        rule_plan(&idx, t, tn, lo, hi, cap, &plan);
+        rule_explain(&plan, ex, (int)sizeof(ex));
+        int same = got == cnt && memcmp(out, ref, sizeof(int) * (size_t)cnt) == 0;
+        printf("  regle %zu : curseur %9.3f ms, plan %9.3f ms, %d resultats%s\n", r,
+               (t1 - t0) * 1e3 / Q, (t2 - t1) * 1e3 / Q, got, same ? "" : " DIFFERENTS");
+        printf("    %s\n", ex);
+    }
+    si_clear(&idx);
+}
+
+/*
+ * Lecteur concurrent : snapshots successifs et requête de plage sur chacun
+ */
+typedef struct SnapReader {
+    StationIndex* idx;
+    int n;
+    atomic_int* stop;
+    long queries;
+} SnapReader;
+
+static void* snap_reader(void* arg) {
+    SnapReader* r = (SnapReader*)arg;
+    unsigned seed = (unsigned)(size_t)r;
+    while (!atomic_load(r->stop)) {
+        SiSnapshot snap;
+        StationNode* root = si_snapshot_acquire(r->idx, &snap);
+        seed = seed * 1103515245u + 12345u;
+        int lo = 1001 + (int)((seed >> 8) % (unsigned)r->n);
+        RangeStats st;
+        si_range_stats(root, lo, lo + 999, &st);
+        si_snapshot_release(r->idx, &snap);
+        r->queries++;
+    }
+    return NULL;
+}
+
+/*
+ * Section : mode persistant (si_enable_persistent)
+ * Rejeu d'événements par l'écrivain (publication tous les 64 événements),
+ * seul puis avec 1 à 3 threads lecteurs sur des snapshots
+ */
+static void bench_snapshot(const int* ids, int n) {
+    int events = 2 * n;
+    StationInfo dflt = make_info(0);
+    printf("[SNAPSHOT] %d evenements sur %d stations, publication tous les 64\n", events, n);
+
+    for (int mode = 0; mode < 5; mode++) {
+        int persistent = mode > 0, readers = mode > 1 ? mode - 1 : 0;
+        StationIndex idx;
+        si_init(&idx);
+        for (int i = 0; i < n; i++) si_add(&idx, ids[i], make_info(ids[i]));
+        if (persistent) { si_enable_persistent(&idx); si_publish(&idx); }
+
+        atomic_int stop;
+        atomic_init(&stop, 0);
+        SnapReader rd[3];
+        pthread_t th[3];
+        for (int t = 0; t < readers; t++) {
+            rd[t].idx = &idx; rd[t].n = n; rd[t].stop = &stop; rd[t].queries = 0;
+            pthread_create(&th[t], NULL, snap_reader, &rd[t]);
+        }
+
+        double t0 = now_sec();
+        for (int i = 0; i < events; i++) {
+            int id = ids[(int)(((long)i * 7919) % n)], action = i % 3 != 0;
+            si_update(&idx, id, &dflt, apply_plug, &action);
+            if ((i & 63) == 63) si_publish(&idx);
+        }
+        si_publish(&idx);
+        double t1 = now_sec();
+
+        atomic_store(&stop, 1);
+        long queries = 0;
+        for (int t = 0; t < readers; t++) { pthread_join(th[t], NULL); queries += rd[t].queries; }
+
+        char what[64];
+        if (!persistent) snprintf(what, sizeof what, "si_update (mode normal)");
+        else snprintf(what, sizeof what, "persistant, %d lecteur(s)", readers);
+        report(what, t1 - t0, events);
+        if (readers > 0)
+            printf("  %-28s %9.0f requetes/s\n", "  plages lues (snapshots)", queries / (t1 - t0));
+        si_clear(&idx);
+    }
+}
+
+/*
+ * Fonction auxiliaire : want
+ * Description : Vrai si la section doit être exécutée (aucun filtre, ou filtre égal)
+ */
+static int want(const char* only, const char* section) {
+    return !only || strcmp(only, section) == 0;
+}
+
+int main(int argc, char** argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 1000000;
+    const char* only = argc > 2 ? argv[2] : NULL;
+    if (n <= 0) return 1;
+
+    int* ids = (int*)malloc(sizeof(int) * n);
+    if (!ids) return 1;
+    for (int i = 0; i < n; i++) ids[i] = 1001 + i;
+
+    if (want(only, "index")) {
+        bench_index(ids, n, "IDs tries", SI_BACKEND_AVL);
+        bench_index(ids, n, "IDs tries", SI_BACKEND_BPTREE);
+    }
+    if (want(only, "bulk")) bench_bulk(ids, n, "IDs tries");
+    if (want(only, "lookup")) bench_lookup(ids, n, "IDs tries");
+    shuffle(ids, n, 42u);
+    if (want(only, "index")) {
+        bench_index(ids, n, "IDs melanges", SI_BACKEND_AVL);
+        bench_index(ids, n, "IDs melanges", SI_BACKEND_BPTREE);
+    }
+    if (want(only, "bulk")) bench_bulk(ids, n, "IDs melanges");
+    if (want(only, "lookup")) bench_lookup(ids, n, "IDs melanges");
+    if (want(only, "events")) bench_events(ids, n);
+    if (want(only, "snapshot")) bench_snapshot(ids, n);
+    if (want(only, "attr")) bench_attr(ids, n);
+    if (want(only, "topk")) bench_topk(ids, n);
+    if (want(only, "prune")) bench_prune(ids, n);
+    if (want(only, "par")) bench_par(ids, n);
+    if (want(only, "view")) bench_view(ids, n);
+    if (want(only, "geo")) bench_geo(ids, n);
+    if (want(only, "cache")) bench_cache(ids, n);
+    if (want(only, "plan")) bench_plan(ids, n);
+    if (want(only, "rules")) bench_rules(n);
+    if (want(only, "subs")) bench_subs(ids, n);
+    if (want(only, "csv")) bench_csv(10 * n);
+    if (want(only, "batch")) {
+        bench_batch(ids, n, SI_BACKEND_AVL);
+        bench_batch(ids, n, SI_BACKEND_BPTREE);
+    }
+    if (want(only, "iter")) {
+        bench_iter(ids, n, SI_BACKEND_AVL);
+        bench_iter(ids, n, SI_BACKEND_BPTREE);
+    }
+
+    free(ids);
+    return 0;
+}
@@ -0,0 +1,505 @@
+#include "bptree.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Nombre minimal de clés d'un nœud non racine */
+#define BP_MIN (BP_ORDER/2)
+
+/*
+ * Profondeur maximale : avec un facteur de branchement d'au moins BP_MIN+1,
+ * 16 niveaux dépassent largement 2^31 enregistrements.
+ */
+#define BP_MAX_DEPTH 16
+
+/*
+ * Fonction auxiliaire : bp_node
+ * Description : Alloue un nœud vide (feuille ou interne)
+ * Complexité temps : O(1) - Complexité espace : O(BP_ORDER)
+ */
+static BPNode* bp_node(int is_leaf){
+    BPNode* n=(BPNode*)calloc(1,sizeof*n);
+    if(n) n->is_leaf=is_leaf;
+    return n;
+}
+
+/*
+ * Fonction auxiliaire : child_index
+ * Description : Indice du fils à suivre dans un nœud interne
+ *               (fils i = clés dans [keys[i-1], keys[i]) ), recherche dichotomique
+ * Complexité temps : O(log BP_ORDER) - Complexité espace : O(1)
+ */
+static int child_index(const BPNode* n, int id){
+    int lo=0, hi=n->nkeys;
+    while(lo<hi){
+        int m=(lo+hi)/2;
+        if(n->keys[m]<=id) lo=m+1; else hi=m;
+    }
+    return lo;
+}
+
+/*
+ * Fonction auxiliaire : leaf_pos
+ * Description : Première position d'une feuille dont la clé est >= id
+ * Complexité temps : O(log BP_ORDER) - Complexité espace : O(1)
+ */
+static int leaf_pos(const BPNode* n, int id){
+    int lo=0, hi=n->nkeys;
+    while(lo<hi){
+        int m=(lo+hi)/2;
+        if(n->keys[m]<id) lo=m+1; else hi=m;
+    }
+    return lo;
+}
+
+/*
+ * Fonction auxiliaire : find_leaf
+ * Description : Descend jusqu'à la feuille pouvant contenir id
+ * Complexité temps : O(log n) - Complexité espace : O(1)
+ */
+static BPNode* find_leaf(const BPTree* t, int id){
+    BPNode* n=t->root;
+    while(n && !n->is_leaf) n=n->children[child_index(n,id)];
+    return n;
+}
+
+/*
+ * Fonction : bp_init
+ * Description : Initialise un arbre B+ vide
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+void bp_init(BPTree* t){ t->root=0; t->count=0; }
+
+/*
+ * Fonction : bp_find
+ * Description : Recherche d'un enregistrement par ID
+ *               Chaque niveau est un bloc contigu de clés : peu de défauts de cache
+ * Retour : Enregistrement trouvé, ou NULL
+ * Complexité temps : O(log n) - log_{BP_ORDER}(n) nœuds visités
+ * Complexité espace : O(1)
+ */
+StationNode* bp_find(const BPTree* t, int id){
+    BPNode* l=find_leaf(t,id);
+    if(!l) return 0;
+    int p=leaf_pos(l,id);
+    return (p<l->nkeys && l->keys[p]==id) ? l->leaf.recs[p] : 0;
+}
+
+/*
+ * Fonction : bp_insert
+ * Description : Insère un enregistrement dont l'ID n'est pas encore présent
+ *               Descente unique en mémorisant le chemin ; une feuille pleine est
+ *               coupée en deux et la première clé de la moitié droite remonte.
+ *               Les éclatements se propagent tant que le parent est plein.
+ *               Tous les nœuds nécessaires sont alloués avant toute modification :
+ *               un échec d'allocation laisse l'arbre intact.
+ * Paramètres :
+ *   - t : arbre B+
+ *   - rec : enregistrement à insérer (rec->station_id absent de l'arbre)
+ * Retour : 1 si inséré, 0 si échec d'allocation
+ * Complexité temps : O(log n) - O(BP_ORDER) par niveau éclaté
+ * Complexité espace : O(1) - Chemin de taille bornée BP_MAX_DEPTH
+ */
+int bp_insert(BPTree* t, StationNode* rec){
+    int id=rec->station_id;
+    if(!t->root){
+        t->root=bp_node(1);
+        if(!t->root) return 0;
+    }
+
+    BPNode* path[BP_MAX_DEPTH];
+    int cidx[BP_MAX_DEPTH];
+    int depth=0;
+    BPNode* n=t->root;
+    while(!n->is_leaf){
+        int c=child_index(n,id);
+        path[depth]=n; cidx[depth]=c; depth++;
+        n=n->children[c];
+    }
+    int pos=leaf_pos(n,id);
+
+    // Cas simple : la feuille a de la place
+    if(n->nkeys<BP_ORDER){
+        memmove(&n->keys[pos+1],&n->keys[pos],sizeof(int)*(size_t)(n->nkeys-pos));
+        memmove(&n->leaf.recs[pos+1],&n->leaf.recs[pos],sizeof(StationNode*)*(size_t)(n->nkeys-pos));
+        n->keys[pos]=id; n->leaf.recs[pos]=rec; n->nkeys++;
+        t->count++;
+        return 1;
+    }
+
+    // Pré-allocation : une feuille + un nœud par ancêtre plein (+ nouvelle racine)
+    BPNode* spare[BP_MAX_DEPTH+2];
+    int need=1, ns=0;
+    int d=depth;
+    while(d>0 && path[d-1]->nkeys==BP_ORDER){ need++; d--; }
+    if(d==0) need++;
+    for(ns=0; ns<need; ns++){
+        spare[ns]=bp_node(ns==0);
+        if(!spare[ns]){ while(ns>0) free(spare[--ns]); return 0; }
+    }
+    int sp=0;
+
+    // Éclatement de la feuille : [0, nl) reste, [nl, BP_ORDER+1) part à droite
+    int keys[BP_ORDER+1];
+    StationNode* recs[BP_ORDER+1];
+    memcpy(keys,n->keys,sizeof(int)*(size_t)pos);
+    memcpy(recs,n->leaf.recs,sizeof(StationNode*)*(size_t)pos);
+    keys[pos]=id; recs[pos]=rec;
+    memcpy(&keys[pos+1],&n->keys[pos],sizeof(int)*(size_t)(BP_ORDER-pos));
+    memcpy(&recs[pos+1],&n->leaf.recs[pos],sizeof(StationNode*)*(size_t)(BP_ORDER-pos));
+
+    int total=BP_ORDER+1, nl=(total+1)/2;
+    BPNode* right=spare[sp++];
+    memcpy(n->keys,keys,sizeof(int)*(size_t)nl);
+    memcpy(n->leaf.recs,recs,sizeof(StationNode*)*(size_t)nl);
+    n->nkeys=nl;
+    memcpy(right->keys,&keys[nl],sizeof(int)*(size_t)(total-nl));
+    memcpy(right->leaf.recs,&recs[nl],sizeof(StationNode*)*(size_t)(total-nl));
+    right->nkeys=total-nl;
+    right->leaf.next=n->leaf.next;
+    n->leaf.next=right;
+    t->count++;
+
+    int sep=right->keys[0];
+    BPNode* child=right;
+
+    // Remontée : insérer (sep, child) dans les parents successifs
+    while(depth>0){
+        BPNode* p=path[--depth];
+        int c=cidx[depth];
+        if(p->nkeys<BP_ORDER){
+            memmove(&p->keys[c+1],&p->keys[c],sizeof(int)*(size_t)(p->nkeys-c));
+            memmove(&p->children[c+2],&p->children[c+1],sizeof(BPNode*)*(size_t)(p->nkeys-c));
+            p->keys[c]=sep; p->children[c+1]=child; p->nkeys++;
+            return 1;
+        }
+        // Éclatement du nœud interne : la clé médiane remonte
+        int ik[BP_ORDER+1];
+        BPNode* ic[BP_ORDER+2];
+        memcpy(ik,p->keys,sizeof(int)*(size_t)c);
+        ik[c]=sep;
+        memcpy(&ik[c+1],&p->keys[c],sizeof(int)*(size_t)(BP_ORDER-c));
+        memcpy(ic,p->children,sizeof(BPNode*)*(size_t)(c+1));
+        ic[c+1]=child;
+        memcpy(&ic[c+2],&p->children[c+1],sizeof(BPNode*)*(size_t)(BP_ORDER-c));
+
+        int mid=(BP_ORDER+1)/2;
+        BPNode* r2=spare[sp++];
+        memcpy(p->keys,ik,sizeof(int)*(size_t)mid);
+        memcpy(p->children,ic,sizeof(BPNode*)*(size_t)(mid+1));
+        p->nkeys=mid;
+        r2->nkeys=BP_ORDER-mid;
+        memcpy(r2->keys,&ik[mid+1],sizeof(int)*(size_t)r2->nkeys);
+        memcpy(r2->children,&ic[mid+1],sizeof(BPNode*)*(size_t)(r2->nkeys+1));
+        sep=ik[mid];
+        child=r2;
+    }
+
+    // La racine a éclaté : nouvelle racine à deux fils
+    BPNode* root=spare[sp++];
+    root->keys[0]=sep;
+    root->children[0]=t->root;
+    root->children[1]=child;
+    root->nkeys=1;
+    t->root=root;
+    return 1;
+}
+
+/*
+ * Fonction auxiliaire : remove_entry
+ * Description : Retire la clé ki et le fils ci d'un nœud interne
+ * Complexité temps : O(BP_ORDER) - Complexité espace : O(1)
+ */
+static void remove_entry(BPNode* p, int ki, int ci){
+    memmove(&p->keys[ki],&p->keys[ki+1],sizeof(int)*(size_t)(p->nkeys-ki-1));
+    memmove(&p->children[ci],&p->children[ci+1],sizeof(BPNode*)*(size_t)(p->nkeys-ci));
+    p->nkeys--;
+}
+
+/*
+ * Fonction : bp_delete
+ * Description : Retire un ID de l'arbre B+
+ *               Un nœud qui passe sous BP_MIN clés emprunte une entrée à un
+ *               frère voisin qui en a assez, sinon fusionne avec lui ; la
+ *               fusion retire une entrée du parent et peut se propager.
+ *               Une racine interne sans clé est remplacée par son unique fils.
+ * Paramètres :
+ *   - t : arbre B+
+ *   - id : identifiant à retirer
+ * Retour : Enregistrement retiré (à libérer par l'appelant), ou NULL si absent
+ * Complexité temps : O(log n) - O(BP_ORDER) par niveau rééquilibré
+ * Complexité espace : O(1) - Chemin de taille bornée BP_MAX_DEPTH
+ */
+StationNode* bp_delete(BPTree* t, int id){
+    if(!t->root) return 0;
+    BPNode* path[BP_MAX_DEPTH];
+    int cidx[BP_MAX_DEPTH];
+    int depth=0;
+    BPNode* n=t->root;
+    while(!n->is_leaf){
+        int c=child_index(n,id);
+        path[depth]=n; cidx[depth]=c; depth++;
+        n=n->children[c];
+    }
+    int pos=leaf_pos(n,id);
+    if(pos>=n->nkeys || n->keys[pos]!=id) return 0;
+
+    StationNode* rec=n->leaf.recs[pos];
+    memmove(&n->keys[pos],&n->keys[pos+1],sizeof(int)*(size_t)(n->nkeys-pos-1));
+    memmove(&n->leaf.recs[pos],&n->leaf.recs[pos+1],sizeof(StationNode*)*(size_t)(n->nkeys-pos-1));
+    n->nkeys--;
+    t->count--;
+
+    BPNode* cur=n;
+    while(depth>0 && cur->nkeys<BP_MIN){
+        BPNode* p=path[--depth];
+        int c=cidx[depth];
+        BPNode* L= c>0 ? p->children[c-1] : 0;
+        BPNode* R= c<p->nkeys ? p->children[c+1] : 0;
+
+        if(cur->is_leaf){
+            // Emprunt au frère gauche
+            if(L && L->nkeys>BP_MIN){
+                memmove(&cur->keys[1],&cur->keys[0],sizeof(int)*(size_t)cur->nkeys);
+                memmove(&cur->leaf.recs[1],&cur->leaf.recs[0],sizeof(StationNode*)*(size_t)cur->nkeys);
+                L->nkeys--;
+                cur->keys[0]=L->keys[L->nkeys];
+                cur->leaf.recs[0]=L->leaf.recs[L->nkeys];
+                cur->nkeys++;
+                p->keys[c-1]=cur->keys[0];
+                break;
+            }
+            // Emprunt au frère droit
+            if(R && R->nkeys>BP_MIN){
+                cur->keys[cur->nkeys]=R->keys[0];
+                cur->leaf.recs[cur->nkeys]=R->leaf.recs[0];
+                cur->nkeys++;
+                R->nkeys--;
+                memmove(&R->keys[0],&R->keys[1],sizeof(int)*(size_t)R->nkeys);
+                memmove(&R->leaf.recs[0],&R->leaf.recs[1],sizeof(StationNode*)*(size_t)R->nkeys);
+                p->keys[c]=R->keys[0];
+                break;
+            }
+            // Fusion avec un frère (le nœud de droite disparaît)
+            BPNode* a= L ? L : cur;
+            BPNode* b= L ? cur : R;
+            memcpy(&a->keys[a->nkeys],b->keys,sizeof(int)*(size_t)b->nkeys);
+            memcpy(&a->leaf.recs[a->nkeys],b->leaf.recs,sizeof(StationNode*)*(size_t)b->nkeys);
+            a->nkeys+=b->nkeys;
+            a->leaf.next=b->leaf.next;
+            free(b);
+            if(L) remove_entry(p,c-1,c); else remove_entry(p,c,c+1);
+        }
+        else {
+            // Rotation depuis le frère gauche (la clé du parent descend)
+            if(L && L->nkeys>BP_MIN){
+                memmove(&cur->keys[1],&cur->keys[0],sizeof(int)*(size_t)cur->nkeys);
+                memmove(&cur->children[1],&cur->children[0],sizeof(BPNode*)*(size_t)(cur->nkeys+1));
+                cur->keys[0]=p->keys[c-1];
+                cur->children[0]=L->children[L->nkeys];
+                cur->nkeys++;
+                p->keys[c-1]=L->keys[L->nkeys-1];
+                L->nkeys--;
+                break;
+            }
+            // Rotation depuis le frère droit
+            if(R && R->nkeys>BP_MIN){
+                cur->keys[cur->nkeys]=p->keys[c];
+                cur->children[cur->nkeys+1]=R->children[0];
+                cur->nkeys++;
+                p->keys[c]=R->keys[0];
+                memmove(&R->keys[0],&R->keys[1],sizeof(int)*(size_t)(R->nkeys-1));
+                memmove(&R->children[0],&R->children[1],sizeof(BPNode*)*(size_t)R->nkeys);
+                R->nkeys--;
+                break;
+            }
+            // Fusion : a + clé séparatrice du parent + b
+            BPNode* a= L ? L : cur;
+            BPNode* b= L ? cur : R;
+            int ki= L ? c-1 : c;
+            a->keys[a->nkeys]=p->keys[ki];
+            memcpy(&a->keys[a->nkeys+1],b->keys,sizeof(int)*(size_t)b->nkeys);
+            memcpy(&a->children[a->nkeys+1],b->children,sizeof(BPNode*)*(size_t)(b->nkeys+1));
+            a->nkeys+=1+b->nkeys;
+            free(b);
+            remove_entry(p,ki,ki+1);
+        }
+        cur=p;
+    }
+
+    // Ajustement de la racine
+    BPNode* r=t->root;
+    if(!r->is_leaf && r->nkeys==0){ t->root=r->children[0]; free(r); }
+    else if(r->is_leaf && r->nkeys==0){ t->root=0; free(r); }
+    return rec;
+}
+
+/*
+ * Fonction : bp_build
+ * Description : Construit l'arbre niveau par niveau depuis des enregistrements
+ *               triés strictement par ID : feuilles remplies de façon
+ *               homogène (chacune >= BP_MIN), chaînées, puis chaque niveau
+ *               interne regroupe jusqu'à BP_ORDER+1 fils. La clé séparatrice
+ *               d'un fils est la plus petite clé de son sous-arbre.
+ * Paramètres :
+ *   - t : arbre B+ vide
+ *   - recs : enregistrements triés par ID
+ *   - n : nombre d'enregistrements
+ * Retour : 1 si construit, 0 si échec d'allocation (arbre laissé vide)
+ * Complexité temps : O(n) - Complexité espace : O(n / BP_ORDER)
+ */
+int bp_build(BPTree* t, StationNode** recs, int n){
+    if(n<=0) return 1;
+    int nleaves=(n+BP_ORDER-1)/BP_ORDER;
+    // Nœuds de tous les niveaux (< 2 * nleaves + BP_MAX_DEPTH) et leurs clés minimales
+    int maxn=2*nleaves+BP_MAX_DEPTH;
+    BPNode** all=(BPNode**)malloc(sizeof(BPNode*)*(size_t)maxn);
+    int* mins=(int*)malloc(sizeof(int)*(size_t)nleaves);
+    if(!all || !mins){ free(all); free(mins); return 0; }
+    int na=0;
+
+    // Niveau des feuilles
+    int base=n/nleaves, extra=n%nleaves, k=0;
+    for(int i=0;i<nleaves;i++){
+        BPNode* l=bp_node(1);
+        if(!l) goto fail;
+        all[na++]=l;
+        int cnt=base+(i<extra);
+        for(int j=0;j<cnt;j++,k++){ l->keys[j]=recs[k]->station_id; l->leaf.recs[j]=recs[k]; }
+        l->nkeys=cnt;
+        mins[i]=l->keys[0];
+        if(i>0) all[na-2]->leaf.next=l;
+    }
+
+    // Niveaux internes jusqu'à la racine
+    int level=0, width=nleaves;
+    while(width>1){
+        int np=(width+BP_ORDER)/(BP_ORDER+1);
+        int b2=width/np, e2=width%np, c=0;
+        int start=na;
+        for(int i=0;i<np;i++){
+            BPNode* p=bp_node(0);
+            if(!p) goto fail;
+            all[na++]=p;
+            int cnt=b2+(i<e2);
+            int first=c;
+            for(int j=0;j<cnt;j++,c++){
+                p->children[j]=all[level+c];
+                if(j>0) p->keys[j-1]=mins[c];
+            }
+            p->nkeys=cnt-1;
+            mins[i]=mins[first];
+        }
+        level=start;
+        width=np;
+    }
+    t->root=all[na-1];
+    t->count=n;
+    free(all); free(mins);
+    return 1;
+
+fail:
+    while(na>0) free(all[--na]);
+    free(all); free(mins);
+    return 0;
+}
+
+/*
+ * Fonction auxiliaire : leftmost_leaf
+ * Complexité temps : O(log n) - Complexité espace : O(1)
+ */
+static BPNode* leftmost_leaf(const BPTree* t){
+    BPNode* n=t->root;
+    while(n && !n->is_leaf) n=n->children[0];
+    return n;
+}
+
+/*
+ * Fonction : bp_to_array
+ * Description : Exporte les IDs par ordre croissant en suivant le chaînage
+ *               des feuilles (lecture séquentielle des tableaux de clés)
+ * Retour : Nombre d'IDs écrits (au plus cap)
+ * Complexité temps : O(n) - Complexité espace : O(1)
+ */
+int bp_to_array(const BPTree* t, int* ids, int cap){
+    int w=0;
+    for(BPNode* l=leftmost_leaf(t); l && w<cap; l=l->leaf.next){
+        int c= l->nkeys<cap-w ? l->nkeys : cap-w;
+        memcpy(&ids[w],l->keys,sizeof(int)*(size_t)c);
+        w+=c;
+    }
+    return w;
+}
+
+/*
+ * Fonction : bp_range_ids
+ * Description : IDs dans [lo, hi] : une descente vers la feuille de lo,
+ *               puis parcours séquentiel des feuilles jusqu'à dépasser hi
+ * Retour : Nombre d'IDs écrits (au plus cap)
+ * Complexité temps : O(log n + k) - Complexité espace : O(1)
+ */
+int bp_range_ids(const BPTree* t, int lo, int hi, int* out, int cap){
+    BPNode* l=find_leaf(t,lo);
+    if(!l) return 0;
+    int w=0, i=leaf_pos(l,lo);
+    while(l && w<cap){
+        for(; i<l->nkeys && w<cap; i++){
+            if(l->keys[i]>hi) return w;
+            out[w++]=l->keys[i];
+        }
+        l=l->leaf.next;
+        i=0;
+    }
+    return w;
+}
+
+/*
+ * Fonction : bp_seek
+ * Description : Feuille et position du premier enregistrement d'ID >= lo
+ *               (*pos peut valoir nkeys : le suivant est alors en tête de la
+ *               feuille suivante)
+ * Retour : Feuille, ou NULL si l'arbre est vide
+ * Complexité temps : O(log n) - Complexité espace : O(1)
+ */
+BPNode* bp_seek(const BPTree* t, int lo, int* pos){
+    BPNode* l=find_leaf(t,lo);
+    *pos= l ? leaf_pos(l,lo) : 0;
+    return l;
+}
+
+/*
+ * Fonctions : bp_min / bp_max
+ * Description : Enregistrements extrêmes (feuille la plus à gauche / à droite)
+ * Complexité temps : O(log n) - Complexité espace : O(1)
+ */
+StationNode* bp_min(const BPTree* t){
+    BPNode* l=leftmost_leaf(t);
+    return l && l->nkeys ? l->leaf.recs[0] : 0;
+}
+
+StationNode* bp_max(const BPTree* t){
+    BPNode* n=t->root;
+    while(n && !n->is_leaf) n=n->children[n->nkeys];
+    return n && n->nkeys ? n->leaf.recs[n->nkeys-1] : 0;
+}
+
+/*
+ * Fonction auxiliaire récursive : free_nodes
+ * Complexité temps : O(n / BP_ORDER) - Complexité espace : O(log n)
+ */
+static void free_nodes(BPNode* n){
+    if(!n) return;
+    if(!n->is_leaf)
+        for(int i=0;i<=n->nkeys;i++) free_nodes(n->children[i]);
+    free(n);
+}
+
+/*
+ * Fonction : bp_clear
+ * Description : Libère tous les nœuds de l'arbre (les enregistrements
+ *               appartiennent à l'allocateur de l'index)
+ * Complexité temps : O(n / BP_ORDER) - Complexité espace : O(log n)
+ */
+void bp_clear(BPTree* t){
+    free_nodes(t->root);
+    bp_init(t);
+}
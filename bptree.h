@@ -0,0 +1,75 @@
+#ifndef DS_BPTREE_H
+#define DS_BPTREE_H
+#include "station_index.h"
+
+/*
+ * ============================================================================
+ * ARBRE B+ : BACKEND ALTERNATIF DE L'INDEX DES STATIONS
+ * ============================================================================
+ *
+ * Nœuds larges (BP_ORDER clés contiguës) : une recherche ne touche que
+ * log_{BP_ORDER}(n) nœuds au lieu de log2(n) pour l'AVL.
+ * Les feuilles sont chaînées : parcours in-order et range queries deviennent
+ * des lectures séquentielles de feuilles.
+ * Les enregistrements (StationNode, left/right inutilisés) sont alloués par
+ * l'index : l'arbre B+ ne stocke que leurs adresses, qui restent stables.
+ */
+
+/* Nombre maximal de clés par nœud (minimum BP_ORDER/2 hors racine) */
+#define BP_ORDER 32
+
+/* Nœud de l'arbre B+ (interne ou feuille) */
+typedef struct BPNode {
+    int is_leaf;                             /* 1 = feuille, 0 = nœud interne */
+    int nkeys;                               /* nombre de clés utilisées */
+    int keys[BP_ORDER];                      /* clés triées */
+    union {
+        struct BPNode* children[BP_ORDER+1]; /* nœud interne : nkeys+1 fils */
+        struct {
+            StationNode* recs[BP_ORDER];     /* feuille : enregistrements */
+            struct BPNode* next;             /* feuille suivante (ordre croissant) */
+        } leaf;
+    };
+} BPNode;
+
+/* Arbre B+ */
+typedef struct BPTree {
+    BPNode* root;   /* racine (NULL si vide) */
+    int count;      /* nombre d'enregistrements */
+} BPTree;
+
+/* Initialisation d'un arbre vide - O(1) */
+void bp_init(BPTree* t);
+
+/* Recherche d'un enregistrement par ID - O(log n) */
+StationNode* bp_find(const BPTree* t, int id);
+
+/* Insertion d'un enregistrement dont l'ID est absent - O(log n)
+ * Retour : 1 si inséré, 0 si échec d'allocation */
+int bp_insert(BPTree* t, StationNode* rec);
+
+/* Suppression par ID - O(log n). Retour : l'enregistrement retiré, ou NULL */
+StationNode* bp_delete(BPTree* t, int id);
+
+/* Construction depuis des enregistrements triés strictement (arbre vide) - O(n)
+ * Retour : 1 si construit, 0 si échec d'allocation (arbre laissé vide) */
+int bp_build(BPTree* t, StationNode** recs, int n);
+
+/* Export des IDs par ordre croissant (parcours des feuilles) - O(n) */
+int bp_to_array(const BPTree* t, int* ids, int cap);
+
+/* IDs dans [lo, hi] par ordre croissant - O(log n + k) */
+int bp_range_ids(const BPTree* t, int lo, int hi, int* out, int cap);
+
+/* Feuille et position du premier enregistrement d'ID >= lo (parcours par
+ * le chaînage des feuilles ; *pos peut valoir nkeys) - O(log n) */
+BPNode* bp_seek(const BPTree* t, int lo, int* pos);
+
+/* Enregistrements d'ID minimum / maximum - O(log n) */
+StationNode* bp_min(const BPTree* t);
+StationNode* bp_max(const BPTree* t);
+
+/* Libération des nœuds de l'arbre (pas des enregistrements) - O(n / BP_ORDER) */
+void bp_clear(BPTree* t);
+
+#endif
@@ -1,7 +1,13 @@
 #include "csv_loader.h"
+#include "thread_pool.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 static int parse_station_id(const char* s){
     if(!s) return -1;
@@ -10,6 +16,13 @@ static int parse_station_id(const char* s){
     return atoi(p+1);
 }
 
+/* Coordonnée en degrés décimaux ; 0 si le champ n'est pas un nombre complet */
+static int parse_coord(const char* s, double* out){
+    char* end;
+    *out = strtod(s, &end);
+    return end != s && *end == '\0';
+}
+
 static int split_csv_line(char* line, char* out[], int max_cols){
     int n = 0;
     char* tok = strtok(line, ",");
@@ -29,7 +42,13 @@ int ds_load_stations_from_csv(const char* path, StationIndex* idx){
     char buf[2048];
     if(!fgets(buf, sizeof buf, f)){ fclose(f); return -1; }
 
-    int inserted = 0;
+    /* Les lignes sont accumulées puis chargées en une seule construction */
+    int cap = 1024;
+    StationEntry* rows = (StationEntry*)malloc(sizeof(StationEntry) * cap);
+    GeoPoint* pts = (GeoPoint*)malloc(sizeof(GeoPoint) * cap);
+    if(!rows || !pts){ free(rows); free(pts); fclose(f); return -1; }
+
+    int inserted = 0, located = 0;
     while(fgets(buf, sizeof buf, f)){
         char* cols[16];
         int n = split_csv_line(buf, cols, 16);
@@ -44,9 +63,539 @@ int ds_load_stations_from_csv(const char* path, StationIndex* idx){
         info.slots_free  = atoi(cols[6]);
         info.last_ts     = 0;
 
-        si_add(idx, station_id, info);
+        if(inserted == cap){
+            StationEntry* grown = (StationEntry*)realloc(rows, sizeof(StationEntry) * cap * 2);
+            if(grown) rows = grown;
+            GeoPoint* grown_pts = grown ? (GeoPoint*)realloc(pts, sizeof(GeoPoint) * cap * 2) : NULL;
+            if(!grown_pts){ free(rows); free(pts); fclose(f); return -1; }
+            pts = grown_pts;
+            cap *= 2;
+        }
+        rows[inserted].station_id = station_id;
+        rows[inserted].info = info;
         inserted++;
+
+        /* Colonnes 8 et 9 : latitude, longitude (ligne gardée sans position) */
+        GeoPoint* p = &pts[located];
+        if(parse_coord(cols[8], &p->lat) && parse_coord(cols[9], &p->lon)){
+            p->station_id = station_id;
+            located++;
+        }
     }
     fclose(f);
-    return inserted;
+
+    int built = si_build_sorted(idx, rows, inserted);
+    free(rows);
+    /* Index géographique : facultatif, un échec n'annule pas le chargement */
+    if(built >= 0) si_enable_geo(idx, pts, located);
+    free(pts);
+    return built < 0 ? -1 : inserted;
+}
+
+/* ======================================================================
+ * Chargement sans copie : fichier projeté en mémoire (mmap), une passe
+ * ====================================================================== */
+
+/* Colonnes retenues d'une ligne (les suivantes sont comptées, pas gardées) */
+#define CSV_MAX_COLS 16
+
+/* Champ d'une ligne : octets [b, e) du fichier, guillemets englobants retirés */
+typedef struct CsvField {
+    const char* b;
+    const char* e;
+} CsvField;
+
+/* Lignes accumulées avant la construction de l'index */
+typedef struct CsvRows {
+    StationEntry* rows;
+    GeoPoint* pts;
+    int count, located, cap;
+    int open;               /* 1 : dernière ligne arrêtée dans un champ entre guillemets */
+} CsvRows;
+
+/*
+ * Fonction auxiliaire : scan_line
+ * Description : Découpe la ligne qui commence en p (RFC 4180) : séparateur
+ *               ',', champ entre guillemets pouvant contenir ',', '\n' et
+ *               '""' (guillemet échappé, laissé tel quel dans le champ),
+ *               fin de ligne '\n' ou "\r\n". Aucune copie : les champs
+ *               désignent le fichier.
+ * Paramètres :
+ *   - p, end : position courante et fin du fichier
+ *   - f : champs des CSV_MAX_COLS premières colonnes
+ *   - ncols : nombre total de colonnes de la ligne
+ *   - open : mis à 1 si la ligne s'arrête à end dans un champ entre
+ *            guillemets non fermé, à 0 sinon (NULL : non renseigné)
+ * Retour : Début de la ligne suivante (end à la fin du fichier)
+ * Complexité temps : O(longueur de la ligne) - Complexité espace : O(1)
+ */
+static const char* scan_line(const char* p, const char* end, CsvField* f, int* ncols, int* open){
+    int n = 0;
+    if(open) *open = 0;
+    for(;;){
+        const char* b = p;
+        const char* e;
+        if(p < end && *p == '"'){
+            b = ++p;
+            for(;;){
+                const char* q = memchr(p, '"', (size_t)(end - p));
+                if(!q){
+                    p = e = end;
+                    if(open) *open = 1;
+                    break;
+                }
+                if(q + 1 < end && q[1] == '"'){ p = q + 2; continue; }
+                e = q;
+                p = q + 1;
+                break;
+            }
+            while(p < end && *p != ',' && *p != '\n') p++; /* texte après le guillemet fermant : ignoré */
+        } else {
+            while(p < end && *p != ',' && *p != '\n') p++;
+            e = p;
+            if(e > b && e[-1] == '\r' && (p == end || *p == '\n')) e--;
+        }
+        if(n < CSV_MAX_COLS){ f[n].b = b; f[n].e = e; }
+        n++;
+        if(p < end && *p == ','){ p++; continue; }
+        if(p < end) p++;
+        *ncols = n;
+        return p;
+    }
+}
+
+/* Entier comme atoi (espaces, signe, chiffres jusqu'au premier autre octet),
+ * borné à [INT_MIN, INT_MAX], sans appel à la libc */
+static int span_int(const char* b, const char* e){
+    while(b < e && (*b == ' ' || (*b >= '\t' && *b <= '\r'))) b++;
+    int neg = 0;
+    if(b < e && (*b == '-' || *b == '+')) neg = *b++ == '-';
+    long long v = 0;
+    for(; b < e && (unsigned)(*b - '0') < 10u; b++)
+        if(v <= INT_MAX) v = v * 10 + (*b - '0');
+    if(neg) return v > (long long)INT_MAX + 1 ? INT_MIN : (int)-v;
+    return v > INT_MAX ? INT_MAX : (int)v;
+}
+
+/* ID après le dernier '_' du champ (comme parse_station_id), -1 sinon */
+static int span_station_id(const char* b, const char* e){
+    const char* u = e;
+    while(u > b && u[-1] != '_') u--;
+    if(u == b || u == e) return -1;
+    return span_int(u, e);
+}
+
+/* Coordonnée : champ entier en décimal simple ([espaces][signe]chiffres[.chiffres],
+ * au plus 15 chiffres significatifs et 22 décimales : une division
+ * correctement arrondie, même valeur que strtod), sinon repli sur strtod.
+ * Retour : 1 si le champ est un nombre complet, 0 sinon */
+static int span_coord(const char* b, const char* e, double* out){
+    static const double POW10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    const char* p = b;
+    while(p < e && (*p == ' ' || (*p >= '\t' && *p <= '\r'))) p++;
+    int neg = 0;
+    if(p < e && (*p == '-' || *p == '+')) neg = *p++ == '-';
+    unsigned long long m = 0;
+    int nd = 0, sig = 0, frac = 0, dot = 0;
+    for(; p < e && sig <= 15 && frac <= 22; p++){
+        if((unsigned)(*p - '0') < 10u){
+            nd++;
+            if(m || *p != '0') sig++;
+            m = m * 10 + (unsigned)(*p - '0');
+            frac += dot;
+        } else if(*p == '.' && !dot) dot = 1;
+        else break;
+    }
+    if(p == e && nd > 0 && sig <= 15 && frac <= 22){
+        double v = (double)m / POW10[frac];
+        *out = neg ? -v : v;
+        return 1;
+    }
+    char buf[64];
+    size_t len = (size_t)(e - b);
+    if(len == 0 || len >= sizeof buf) return 0;
+    memcpy(buf, b, len);
+    buf[len] = '\0';
+    return parse_coord(buf, out);
+}
+
+/*
+ * Fonction auxiliaire : rows_push
+ * Description : Ajoute la station d'une ligne découpée (ID, puissance et
+ *               places en colonnes 0, 5 et 6, position en colonnes 8 et 9),
+ *               mêmes règles que ds_load_stations_from_csv
+ * Retour : 1 si réussi (ou ligne ignorée), 0 si échec d'allocation
+ * Complexité temps : O(1) amorti - Complexité espace : O(1) amorti
+ */
+static int rows_push(CsvRows* r, const CsvField* f){
+    int station_id = span_station_id(f[0].b, f[0].e);
+    if(station_id < 0) return 1;
+    if(r->count == r->cap){
+        int cap = r->cap ? r->cap * 2 : 1024;
+        StationEntry* grown = (StationEntry*)realloc(r->rows, sizeof(StationEntry) * (size_t)cap);
+        if(!grown) return 0;
+        r->rows = grown;
+        GeoPoint* grown_pts = (GeoPoint*)realloc(r->pts, sizeof(GeoPoint) * (size_t)cap);
+        if(!grown_pts) return 0;
+        r->pts = grown_pts;
+        r->cap = cap;
+    }
+    StationEntry* row = &r->rows[r->count++];
+    row->station_id = station_id;
+    row->info.power_kW    = span_int(f[5].b, f[5].e);
+    row->info.price_cents = 300;
+    row->info.slots_free  = span_int(f[6].b, f[6].e);
+    row->info.last_ts     = 0;
+
+    GeoPoint* p = &r->pts[r->located];
+    if(span_coord(f[8].b, f[8].e, &p->lat) && span_coord(f[9].b, f[9].e, &p->lon)){
+        p->station_id = station_id;
+        r->located++;
+    }
+    return 1;
+}
+
+/*
+ * Fonction auxiliaire : scan_rows
+ * Description : Lignes de données de [p, end) (sans en-tête) ajoutées à r ;
+ *               une ligne de moins de 10 colonnes est ignorée
+ * Retour : 1 si réussi, 0 si échec d'allocation
+ * Complexité temps : O(end - p) - Complexité espace : O(lignes)
+ */
+static int scan_rows(const char* p, const char* end, CsvRows* r){
+    CsvField f[CSV_MAX_COLS];
+    while(p < end){
+        int n;
+        p = scan_line(p, end, f, &n, &r->open);
+        if(n >= 10 && !rows_push(r, f)) return 0;
+    }
+    return 1;
+}
+
+/* Projection du fichier en lecture ; NULL si inaccessible ou vide */
+static const char* map_file(const char* path, size_t* len){
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) return NULL;
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size <= 0){ close(fd); return NULL; }
+    void* m = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); /* la projection reste valide */
+    if(m == MAP_FAILED) return NULL;
+    *len = (size_t)st.st_size;
+    return (const char*)m;
+}
+
+/*
+ * Fonction : ds_read_stations_csv
+ * Description : Projection du fichier, en-tête sauté, lignes de données
+ *               converties en entrées et positions (sans construction)
+ * Complexité temps : O(F) - Complexité espace : O(N)
+ */
+int ds_read_stations_csv(const char* path, StationEntry** rows, GeoPoint** pts, int* located){
+    size_t len;
+    const char* data = map_file(path, &len);
+    if(!data) return -1;
+    const char* end = data + len;
+
+    /* En-tête : une ligne (RFC 4180 : elle peut contenir des guillemets) */
+    CsvField f[CSV_MAX_COLS];
+    int n;
+    const char* p = scan_line(data, end, f, &n, NULL);
+
+    CsvRows r = { NULL, NULL, 0, 0, 0, 0 };
+    int ok = scan_rows(p, end, &r);
+    munmap((void*)data, len);
+    if(!ok){ free(r.rows); free(r.pts); return -1; }
+    *rows = r.rows;
+    *pts = r.pts;
+    *located = r.located;
+    return r.count;
+}
+
+/*
+ * Fonction : ds_load_stations_from_csv_mmap
+ * Description : Lecture par ds_read_stations_csv (une passe sur le fichier
+ *               projeté, champs désignant directement le fichier, entiers
+ *               convertis sans appel à la libc), puis mêmes entrées et même
+ *               index géographique que ds_load_stations_from_csv,
+ *               construction par si_build_sorted
+ * Complexité temps : O(F + N log N) - F = taille du fichier
+ * Complexité espace : O(N) - plus la projection du fichier (pages partagées
+ *                     avec le cache du système)
+ */
+int ds_load_stations_from_csv_mmap(const char* path, StationIndex* idx){
+    StationEntry* rows = NULL;
+    GeoPoint* pts = NULL;
+    int located = 0;
+    int count = ds_read_stations_csv(path, &rows, &pts, &located);
+    if(count < 0) return -1;
+
+    int built = si_build_sorted(idx, rows, count);
+    free(rows);
+    /* Index géographique : facultatif, un échec n'annule pas le chargement */
+    if(built >= 0) si_enable_geo(idx, pts, located);
+    free(pts);
+    return built < 0 ? -1 : count;
+}
+
+/* ======================================================================
+ * Chargement parallèle : morceaux alignés sur les fins de ligne
+ * ====================================================================== */
+
+#define CSV_TASKS_PER_THREAD 4      /* morceaux par thread (équilibrage) */
+#define CSV_MIN_CHUNK (1 << 16)     /* octets minimum par morceau */
+
+/* Lot d'un chargement parallèle */
+typedef struct CsvJob {
+    const char* data;       /* début des lignes de données */
+    const char* end;        /* fin du fichier */
+    int k;                  /* nombre de morceaux */
+    int* quotes;            /* guillemets de chaque tranche brute (parité) */
+    const char** cut;       /* morceau t : [cut[t], cut[t + 1]) */
+    CsvRows* part;          /* lignes lues par morceau, dans l'ordre du fichier */
+    int* failed;            /* 1 : échec d'allocation du morceau */
+    StationEntry* all;      /* entrées de tous les morceaux ... */
+    StationEntry* tmp;      /* ... et tampon de fusion */
+    GeoPoint* pts;          /* positions, dans l'ordre du fichier */
+    int* off;               /* entrées du morceau t : all[off[t], off[t + 1]) */
+    int* poff;              /* positions du morceau t : pts[poff[t] ...] */
+    int runs;               /* séquences triées de la passe de fusion courante */
+} CsvJob;
+
+/* Tranche brute t (découpage en octets, avant alignement) */
+static const char* raw_cut(const CsvJob* job, int t){
+    return job->data + (size_t)(job->end - job->data) / (size_t)job->k * (size_t)t;
+}
+
+/* Tâche 1 : guillemets de la tranche brute t */
+static void csv_quote_task(void* ctx, int t){
+    CsvJob* job = (CsvJob*)ctx;
+    const char* p = raw_cut(job, t);
+    const char* e = t + 1 < job->k ? raw_cut(job, t + 1) : job->end;
+    int n = 0;
+    while(p < e && (p = memchr(p, '"', (size_t)(e - p))) != NULL){ n++; p++; }
+    job->quotes[t] = n;
+}
+
+/* Tâche 2 : lignes du morceau t dans son tampon local */
+static void csv_parse_task(void* ctx, int t){
+    CsvJob* job = (CsvJob*)ctx;
+    job->failed[t] = !scan_rows(job->cut[t], job->cut[t + 1], &job->part[t]);
+}
+
+/*
+ * Fonction auxiliaire récursive : sort_entries
+ * Description : Tri fusion stable par ID (doublons dans l'ordre du fichier),
+ *               O(n) si les entrées sont déjà triées
+ * Complexité temps : O(n log n) - Complexité espace : O(log n) (tampon fourni)
+ */
+static void sort_entries(StationEntry* e, StationEntry* tmp, int n){
+    if(n < 2) return;
+    int m = n / 2;
+    sort_entries(e, tmp, m);
+    sort_entries(e + m, tmp, n - m);
+    if(e[m-1].station_id <= e[m].station_id) return;
+    int i = 0, j = m, k = 0;
+    while(i < m && j < n) tmp[k++] = e[j].station_id < e[i].station_id ? e[j++] : e[i++];
+    while(i < m) tmp[k++] = e[i++];
+    while(j < n) tmp[k++] = e[j++];
+    memcpy(e, tmp, sizeof(StationEntry) * (size_t)n);
+}
+
+/* Tâche 3 : morceau t recopié à sa place puis trié, tampon local libéré */
+static void csv_gather_task(void* ctx, int t){
+    CsvJob* job = (CsvJob*)ctx;
+    CsvRows* r = &job->part[t];
+    StationEntry* e = job->all + job->off[t];
+    if(r->count) memcpy(e, r->rows, sizeof(StationEntry) * (size_t)r->count);
+    if(r->located) memcpy(job->pts + job->poff[t], r->pts, sizeof(GeoPoint) * (size_t)r->located);
+    free(r->rows); free(r->pts);
+    r->rows = NULL; r->pts = NULL;
+    sort_entries(e, job->tmp + job->off[t], r->count);
+}
+
+/* Tâche 4 : fusion stable des séquences 2p et 2p + 1 de all dans tmp
+ * (à égalité, la séquence de gauche, plus tôt dans le fichier, d'abord) */
+static void csv_merge_task(void* ctx, int p){
+    CsvJob* job = (CsvJob*)ctx;
+    int a = 2 * p, lo = job->off[a], mid = job->off[a + 1];
+    int hi = a + 2 <= job->runs ? job->off[a + 2] : mid;   /* dernière séquence seule : recopiée */
+    const StationEntry* x = job->all;
+    StationEntry* out = job->tmp;
+    int i = lo, j = mid, k = lo;
+    while(i < mid && j < hi) out[k++] = x[j].station_id < x[i].station_id ? x[j++] : x[i++];
+    while(i < mid) out[k++] = x[i++];
+    while(j < hi) out[k++] = x[j++];
+}
+
+/* Début de la ligne qui suit p (p dans un champ entre guillemets si inq),
+ * chaque guillemet ouvrant ou fermant un champ ; end si aucune fin de
+ * ligne hors guillemets */
+static const char* next_line(const char* p, const char* end, int inq){
+    for(;;){
+        if(inq){
+            p = memchr(p, '"', (size_t)(end - p));
+            if(!p) return end;
+            p++;
+            inq = 0;
+            continue;
+        }
+        while(p < end && *p != '\n' && *p != '"') p++;
+        if(p == end) return end;
+        if(*p == '\n') return p + 1;
+        p++;
+        inq = 1;
+    }
+}
+
+/*
+ * Fonction auxiliaire : split_chunks
+ * Description : Découpe [data, end) en job->k morceaux qui commencent en
+ *               début de ligne : la parité des guillemets comptés avant
+ *               chaque coupe brute (tâches parallèles, somme préfixe) dit si
+ *               la coupe tombe dans un champ entre guillemets ; la coupe
+ *               avance jusqu'au premier '\n' hors guillemets. La parité
+ *               suppose un fichier conforme à RFC 4180 : un guillemet isolé
+ *               dans un champ sans guillemets (export courant) l'inverse pour
+ *               toutes les coupes suivantes. Une coupe de parité impaire qui
+ *               atteint la fin du fichier est donc reprise hors guillemets,
+ *               et la parité repart de cette coupe ; les coupes restent à
+ *               vérifier (cuts_valid)
+ * Complexité temps : O(F / threads + k + longueur des lignes coupées)
+ * Complexité espace : O(k)
+ */
+static void split_chunks(ThreadPool* pool, CsvJob* job){
+    tp_run(pool, csv_quote_task, job, job->k);
+    job->cut[0] = job->data;
+    int inq = 0;    /* coupe brute t supposée dans un champ entre guillemets */
+    for(int t = 1; t < job->k; t++){
+        inq ^= job->quotes[t-1] & 1;
+        const char* p = raw_cut(job, t);
+        if(p < job->cut[t-1]){ job->cut[t] = job->cut[t-1]; continue; } /* coupe précédente au-delà : morceau vide */
+        const char* q = next_line(p, job->end, inq);
+        if(q == job->end && inq){
+            inq = 0;
+            q = next_line(p, job->end, 0);
+        }
+        job->cut[t] = q;
+    }
+    job->cut[job->k] = job->end;
+}
+
+/* Coupes justes : chaque morceau lu depuis un début de ligne (le premier
+ * l'est) qui ne s'arrête pas dans un champ entre guillemets laisse le
+ * suivant en début de ligne, comme une lecture séquentielle */
+static int cuts_valid(const CsvJob* job){
+    for(int t = 0; t + 1 < job->k; t++)
+        if(job->part[t].open) return 0;
+    return 1;
+}
+
+/* Compacte des entrées triées en gardant la dernière occurrence de chaque ID */
+static int keep_last(StationEntry* e, int n){
+    int w = 0;
+    for(int i = 0; i < n; i++){
+        if(w > 0 && e[w-1].station_id == e[i].station_id) e[w-1] = e[i];
+        else e[w++] = e[i];
+    }
+    return w;
+}
+
+/*
+ * Fonction : ds_load_stations_from_csv_par
+ * Description : Chargement parallèle du fichier projeté :
+ *               1) morceaux alignés sur les fins de ligne (hors guillemets)
+ *               2) chaque morceau lu par un thread dans son propre tampon ;
+ *                  un morceau arrêté dans un champ entre guillemets trahit
+ *                  une coupe fausse (guillemets hors RFC 4180) : le fichier
+ *                  est alors relu en entier par l'appelant
+ *               3) chaque tampon recopié à sa place et trié par ID (stable)
+ *               4) fusions deux à deux en parallèle, à égalité d'ID le
+ *                  morceau le plus tôt dans le fichier d'abord
+ *               5) dernière occurrence de chaque ID gardée, construction
+ *                  en une passe (si_build_sorted), positions dans l'ordre
+ *                  du fichier (si_enable_geo garde aussi la dernière)
+ * Complexité temps : O((F + N log N) / threads + N log k) + construction
+ * Complexité espace : O(N) - entrées, tampon de fusion, positions
+ */
+int ds_load_stations_from_csv_par(const char* path, StationIndex* idx, ThreadPool* pool){
+    size_t len;
+    const char* map = map_file(path, &len);
+    if(!map) return -1;
+    CsvField f[CSV_MAX_COLS];
+    int nf;
+    CsvJob job;
+    memset(&job, 0, sizeof job);
+    job.end = map + len;
+    job.data = scan_line(map, job.end, f, &nf, NULL);
+
+    /* Morceaux : CSV_TASKS_PER_THREAD par thread, CSV_MIN_CHUNK octets au moins */
+    long long bytes = job.end - job.data;
+    long long k = (long long)tp_threads(pool) * CSV_TASKS_PER_THREAD;
+    if(k > bytes / CSV_MIN_CHUNK) k = bytes / CSV_MIN_CHUNK;
+    job.k = k < 1 ? 1 : (int)k;
+    job.quotes = (int*)malloc(sizeof(int) * (size_t)job.k);
+    job.cut = (const char**)malloc(sizeof(const char*) * (size_t)(job.k + 1));
+    job.part = (CsvRows*)calloc((size_t)job.k, sizeof(CsvRows));
+    job.failed = (int*)calloc((size_t)job.k, sizeof(int));
+    job.off = (int*)malloc(sizeof(int) * (size_t)(job.k + 1));
+    job.poff = (int*)malloc(sizeof(int) * (size_t)(job.k + 1));
+    int count = -1, ok = job.quotes && job.cut && job.part && job.failed && job.off && job.poff;
+
+    if(ok){
+        split_chunks(pool, &job);
+        tp_run(pool, csv_parse_task, &job, job.k);
+        if(!cuts_valid(&job)){
+            /* Coupe au milieu d'une ligne (guillemets hors RFC 4180) : relecture séquentielle */
+            for(int t = 0; t < job.k; t++){
+                free(job.part[t].rows); free(job.part[t].pts);
+                memset(&job.part[t], 0, sizeof(CsvRows));
+            }
+            job.k = 1;
+            job.cut[1] = job.end;
+            csv_parse_task(&job, 0);
+        }
+        long long total = 0, located = 0;
+        job.off[0] = job.poff[0] = 0;
+        for(int t = 0; t < job.k; t++){
+            ok = ok && !job.failed[t];
+            total += job.part[t].count;
+            located += job.part[t].located;
+            if(total > INT_MAX) ok = 0;
+            job.off[t+1] = (int)total;
+            job.poff[t+1] = (int)located;
+        }
+        if(ok){
+            job.all = (StationEntry*)malloc(sizeof(StationEntry) * (size_t)(total ? total : 1));
+            job.tmp = (StationEntry*)malloc(sizeof(StationEntry) * (size_t)(total ? total : 1));
+            job.pts = (GeoPoint*)malloc(sizeof(GeoPoint) * (size_t)(located ? located : 1));
+            ok = job.all && job.tmp && job.pts;
+        }
+        if(ok){
+            count = (int)total;
+            tp_run(pool, csv_gather_task, &job, job.k);
+            /* Fusions deux à deux : all -> tmp, puis échange des tampons */
+            for(job.runs = job.k; job.runs > 1; ){
+                int next = (job.runs + 1) / 2;
+                tp_run(pool, csv_merge_task, &job, next);
+                StationEntry* swap = job.all; job.all = job.tmp; job.tmp = swap;
+                for(int p = 0; p <= next; p++) job.off[p] = job.off[2 * p < job.runs ? 2 * p : job.runs];
+                job.runs = next;
+            }
+        }
+    }
+    munmap((void*)map, len);
+    for(int t = 0; job.part && t < job.k; t++){ free(job.part[t].rows); free(job.part[t].pts); }
+    free(job.tmp);
+    if(count >= 0){
+        int distinct = keep_last(job.all, count);
+        int built = si_build_sorted(idx, job.all, distinct);
+        /* Index géographique : facultatif, un échec n'annule pas le chargement */
+        if(built >= 0) si_enable_geo(idx, job.pts, job.poff[job.k]);
+        else count = -1;
+    }
+    free(job.all); free(job.pts);
+    free(job.quotes); free(job.cut); free(job.part); free(job.failed); free(job.off); free(job.poff);
+    return count;
 }
@@ -1,18 +1,79 @@
 #ifndef DS_CSV_LOADER_H
 #define DS_CSV_LOADER_H
 #include "station_index.h"
+#include "thread_pool.h"
 
 /*
  * @brief Charge les stations depuis un fichier CSV et les insère dans l'index AVL.
  * @details Lit le fichier ligne par ligne, ignore l'en-tête et parse les données utiles.
+ * Les positions (latitude, longitude : colonnes 8 et 9) alimentent l'index géographique
+ * de l'index (si_enable_geo), interrogé par si_nearest_idx / si_within_radius_idx ;
+ * une ligne sans position valide est chargée sans être localisée.
  * @param  Chemin vers le fichier CSV (ex: "izivia_tp_subset.csv")[cite: 93].
  * @param   Pointeur vers l'index AVL où stocker les stations.
  * @return     Le nombre de stations insérées, ou -1 si le fichier est inaccessible.
- * * Complexité Temps : O(N * log S) - Où N est le nombre de lignes du CSV et S le nombre
- * de stations dans l'AVL. Chaque insertion est en O(log S).
- * Complexité Espace : O(L + log S) - L est la taille du buffer de ligne, log S est la pile
- * de récursion de l'insertion AVL.
+ * * Complexité Temps : O(N log N) - Les lignes sont accumulées puis chargées en une
+ * seule passe par si_build_sorted (O(N) si les IDs arrivent triés), l'arbre k-d des
+ * positions est construit en O(N log N).
+ * Complexité Espace : O(N + L) - N entrées (ID, StationInfo) et N positions en attente
+ * de construction, L est la taille du buffer de ligne.
  */
 int ds_load_stations_from_csv(const char* path, StationIndex* idx);
 
+/*
+ * @brief Même chargement que ds_load_stations_from_csv, fichier projeté en mémoire (mmap).
+ * @details Une seule passe sur le fichier, sans copie de ligne : les champs sont des
+ * plages d'octets du fichier, les colonnes inutiles sont sautées, les entiers sont lus
+ * sans appel à la libc (les coordonnées aussi, sauf forme inhabituelle : repli sur strtod).
+ * Découpage RFC 4180 : un champ entre guillemets peut contenir des virgules (ex :
+ * adresse_station), des retours à la ligne et des guillemets doublés ; fins de ligne
+ * "\n" ou "\r\n". Une ligne de moins de 10 colonnes est ignorée.
+ * @param  Chemin vers le fichier CSV (fichier ordinaire, non vide).
+ * @param   Pointeur vers l'index où stocker les stations.
+ * @return     Le nombre de stations insérées, ou -1 si le fichier est inaccessible
+ * ou si la mémoire manque.
+ * * Complexité Temps : O(F + N log N) - F = taille du fichier, lu une fois ; la
+ * construction est celle de ds_load_stations_from_csv.
+ * Complexité Espace : O(N) - entrées et positions en attente ; le fichier projeté
+ * n'est pas copié.
+ */
+int ds_load_stations_from_csv_mmap(const char* path, StationIndex* idx);
+
+/*
+ * @brief Lecture seule du chargement ds_load_stations_from_csv_mmap, sans construction.
+ * @details Mêmes lignes retenues et mêmes positions, dans l'ordre du fichier ;
+ * *rows et *pts sont alloués par la fonction (free par l'appelant, même si vides).
+ * @param  Chemin vers le fichier CSV.
+ * @param   Entrées (ID, StationInfo) lues, positions lues et leur nombre.
+ * @return     Le nombre d'entrées, ou -1 si le fichier est inaccessible ou si la
+ * mémoire manque (rien n'est alloué).
+ * * Complexité Temps : O(F) - F = taille du fichier.
+ * Complexité Espace : O(N).
+ */
+int ds_read_stations_csv(const char* path, StationEntry** rows, GeoPoint** pts, int* located);
+
+/*
+ * @brief Même chargement que ds_load_stations_from_csv_mmap, réparti sur les threads d'un pool.
+ * @details Le fichier projeté est découpé en morceaux qui commencent en début de ligne
+ * (une fin de ligne dans un champ entre guillemets n'est pas une coupe : fichier
+ * conforme à RFC 4180) ; chaque morceau est lu par une tâche dans son propre tampon
+ * (ID, StationInfo), trié par ID, puis les tampons sont fusionnés deux à deux et l'index
+ * est construit en une passe (si_build_sorted). Même résultat qu'un chargement
+ * séquentiel : pour un ID présent plusieurs fois, la dernière ligne du fichier gagne.
+ * Limite : les coupes se fient à la parité des guillemets. Un guillemet isolé dans un
+ * champ sans guillemets (hors RFC 4180) la fausse ; la parité est resynchronisée quand
+ * une coupe atteint la fin du fichier, et si une coupe tombe quand même au milieu d'une
+ * ligne (détecté à la lecture), le fichier est relu séquentiellement : résultat
+ * identique, sans parallélisme.
+ * @param  Chemin vers le fichier CSV.
+ * @param   Pointeur vers l'index où stocker les stations.
+ * @param   Pool de threads (tp_create) ; NULL : tâches exécutées par l'appelant.
+ * @return     Le nombre de lignes de stations lues, ou -1 si le fichier est inaccessible
+ * ou si la mémoire manque (index vide inchangé ; index déjà rempli : voir si_build_sorted).
+ * * Complexité Temps : O((F + N log N) / T + N log k) puis la construction - T = threads,
+ * k = morceaux (CSV_TASKS_PER_THREAD par thread).
+ * Complexité Espace : O(N) - tampons des morceaux, entrées fusionnées et tampon de fusion.
+ */
+int ds_load_stations_from_csv_par(const char* path, StationIndex* idx, ThreadPool* pool);
+
 #endif
@@ -0,0 +1,377 @@
+#include "geo_index.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+
+#define GEO_PI 3.14159265358979323846
+
+/*
+ * Fonction : geo_init
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+void geo_init(GeoIndex* g){
+    memset(g,0,sizeof*g);
+}
+
+/*
+ * Fonction auxiliaire : to_unit
+ * Description : Position (degrés) vers point de la sphère unité
+ */
+static void to_unit(double lat, double lon, double* x, double* y, double* z){
+    double a=lat*(GEO_PI/180.0), b=lon*(GEO_PI/180.0);
+    *x=cos(a)*cos(b); *y=cos(a)*sin(b); *z=sin(a);
+}
+
+/* Point en cours de construction : ID et rang dans le tableau d'entrée */
+typedef struct GeoSrc {
+    int id;
+    int rank;
+} GeoSrc;
+
+static int src_cmp(const void* a, const void* b){
+    const GeoSrc* p=(const GeoSrc*)a; const GeoSrc* q=(const GeoSrc*)b;
+    if(p->id!=q->id) return p->id<q->id ? -1 : 1;
+    return (p->rank>q->rank)-(p->rank<q->rank);
+}
+
+/* Point en cours de rangement : position et rang de son ID (permuté en
+ * place : la sélection lit des enregistrements contigus) */
+typedef struct GeoTmp {
+    double c[3];
+    int rank;
+} GeoTmp;
+
+/*
+ * Fonction auxiliaire : select_mid
+ * Description : Place en p[mid] le point de rang mid sur l'axe ax (les
+ *               coordonnées inférieures avant, les supérieures après) ;
+ *               sélection rapide, pivot médian de trois
+ * Complexité temps : O(hi - lo) en moyenne - Complexité espace : O(1)
+ */
+static void select_mid(GeoTmp* p, int ax, int lo, int hi, int mid){
+    hi--;
+    while(lo<hi){
+        int m=lo+(hi-lo)/2;
+        double a=p[lo].c[ax], b=p[m].c[ax], d=p[hi].c[ax];
+        double pv= a<b ? (b<d ? b : (a<d ? d : a)) : (a<d ? a : (b<d ? d : b));
+        int i=lo, j=hi;
+        while(i<=j){
+            while(p[i].c[ax]<pv) i++;
+            while(p[j].c[ax]>pv) j--;
+            if(i<=j){ GeoTmp t=p[i]; p[i]=p[j]; p[j]=t; i++; j--; }
+        }
+        if(mid<=j) hi=j;
+        else if(mid>=i) lo=i;
+        else return;
+    }
+}
+
+/*
+ * Fonction auxiliaire récursive : build_rec
+ * Description : Range p[lo, hi) en arbre k-d : coupe à la médiane de l'axe
+ *               le plus étendu, racine en (lo + hi) / 2
+ * Complexité temps : O(n log n) - Complexité espace : O(log n)
+ */
+static void build_rec(GeoTmp* p, unsigned char* axis, int lo, int hi){
+    if(hi-lo<=GEO_LEAF) return;
+    double mn[3], mx[3];
+    for(int a=0;a<3;a++) mn[a]=mx[a]=p[lo].c[a];
+    for(int i=lo+1;i<hi;i++)
+        for(int a=0;a<3;a++){
+            double v=p[i].c[a];
+            if(v<mn[a]) mn[a]=v;
+            if(v>mx[a]) mx[a]=v;
+        }
+    int ax=0;
+    for(int a=1;a<3;a++) if(mx[a]-mn[a]>mx[ax]-mn[ax]) ax=a;
+    int mid=lo+(hi-lo)/2;
+    select_mid(p,ax,lo,hi,mid);
+    axis[mid]=(unsigned char)ax;
+    build_rec(p,axis,lo,mid);
+    build_rec(p,axis,mid+1,hi);
+}
+
+/*
+ * Fonction auxiliaire : range_max
+ * Description : Recalcule les maxima du sous-arbre [lo, hi) (non vide) à
+ *               partir de ses points (feuille) ou de sa racine et de ses enfants
+ * Complexité temps : O(GEO_LEAF) - Complexité espace : O(1)
+ */
+static void range_max(GeoIndex* g, int lo, int hi){
+    int mid=lo+(hi-lo)/2, ms=INT_MIN, mp=INT_MIN;
+    if(hi-lo<=GEO_LEAF){
+        for(int i=lo;i<hi;i++){
+            if(g->st[i].slots>ms) ms=g->st[i].slots;
+            if(g->st[i].power>mp) mp=g->st[i].power;
+        }
+    }
+    else {
+        ms=g->st[mid].slots; mp=g->st[mid].power;
+        const GeoStat* l=&g->st[lo+(mid-lo)/2];
+        const GeoStat* r=&g->st[mid+1+(hi-mid-1)/2];
+        if(mid>lo){ if(l->max_slots>ms) ms=l->max_slots; if(l->max_power>mp) mp=l->max_power; }
+        if(hi>mid+1){ if(r->max_slots>ms) ms=r->max_slots; if(r->max_power>mp) mp=r->max_power; }
+    }
+    g->st[mid].max_slots=ms;
+    g->st[mid].max_power=mp;
+}
+
+/*
+ * Fonction auxiliaire récursive : max_rec
+ * Description : Maxima de tous les sous-arbres, des feuilles vers la racine
+ * Complexité temps : O(n) - Complexité espace : O(log n)
+ */
+static void max_rec(GeoIndex* g, int lo, int hi){
+    if(lo>=hi) return;
+    if(hi-lo>GEO_LEAF){
+        int mid=lo+(hi-lo)/2;
+        max_rec(g,lo,mid);
+        max_rec(g,mid+1,hi);
+    }
+    range_max(g,lo,hi);
+}
+
+/*
+ * Fonction : geo_build
+ * Description : 1) Trie les positions valides par ID (la dernière gagne)
+ *               2) Projette sur la sphère unité et range en arbre k-d
+ *               3) Recopie places libres et puissance depuis l'index
+ * Retour : 1 si réussi, 0 si échec d'allocation (g inchangé)
+ * Complexité temps : O(n log n) - Complexité espace : O(n) - 53 octets par point
+ */
+int geo_build(GeoIndex* g, const GeoPoint* pts, int n, const StationIndex* idx){
+    if(n<0) n=0;
+    size_t cnt=(size_t)n+1;
+    GeoIndex t;
+    geo_init(&t);
+    GeoSrc* src=(GeoSrc*)malloc(sizeof(GeoSrc)*cnt);
+    GeoTmp* tmp=(GeoTmp*)malloc(sizeof(GeoTmp)*cnt);
+    t.id=(int*)malloc(sizeof(int)*cnt);
+    t.x=(double*)malloc(sizeof(double)*cnt);
+    t.y=(double*)malloc(sizeof(double)*cnt);
+    t.z=(double*)malloc(sizeof(double)*cnt);
+    t.st=(GeoStat*)malloc(sizeof(GeoStat)*cnt);
+    t.axis=(unsigned char*)calloc(cnt,1);
+    t.sorted_id=(int*)malloc(sizeof(int)*cnt);
+    t.by_id=(int*)malloc(sizeof(int)*cnt);
+    if(!src || !tmp || !t.id || !t.x || !t.y || !t.z || !t.st || !t.axis
+       || !t.sorted_id || !t.by_id){
+        free(src); free(tmp);
+        geo_clear(&t);
+        return 0;
+    }
+
+    // Positions hors bornes (ou NaN) ignorées
+    int v=0;
+    for(int i=0;i<n;i++){
+        const GeoPoint* p=&pts[i];
+        if(!(p->lat>=-90 && p->lat<=90 && p->lon>=-180 && p->lon<=180)) continue;
+        src[v].id=p->station_id; src[v].rank=i; v++;
+    }
+    qsort(src,(size_t)v,sizeof(GeoSrc),src_cmp);
+    int m=0;
+    for(int i=0;i<v;i++){
+        if(i+1<v && src[i+1].id==src[i].id) continue;
+        src[m++]=src[i];
+    }
+
+    // Projection sur la sphère, puis rangement en arbre
+    for(int i=0;i<m;i++){
+        const GeoPoint* p=&pts[src[i].rank];
+        to_unit(p->lat,p->lon,&tmp[i].c[0],&tmp[i].c[1],&tmp[i].c[2]);
+        tmp[i].rank=i;
+    }
+    build_rec(tmp,t.axis,0,m);
+
+    t.n=m;
+    for(int i=0;i<m;i++){
+        int s=tmp[i].rank;
+        t.id[i]=src[s].id;
+        t.x[i]=tmp[i].c[0]; t.y[i]=tmp[i].c[1]; t.z[i]=tmp[i].c[2];
+        const StationNode* st=si_find_idx(idx,t.id[i]);
+        t.st[i].slots= st ? st->info.slots_free : INT_MIN;
+        t.st[i].power= st ? st->info.power_kW : INT_MIN;
+        t.sorted_id[s]=t.id[i];
+        t.by_id[s]=i;
+    }
+    max_rec(&t,0,m);
+    free(src); free(tmp);
+
+    geo_clear(g);
+    *g=t;
+    return 1;
+}
+
+/*
+ * Fonction : geo_set
+ * Description : Réécrit le point de la station (recherche dichotomique par
+ *               ID) puis les maxima des sous-arbres qui le contiennent, de la
+ *               feuille vers la racine, tant qu'ils changent
+ * Complexité temps : O(log n + GEO_LEAF) - Complexité espace : O(1)
+ */
+void geo_set(GeoIndex* g, int id, const StationInfo* in){
+    int lo=0, hi=g->n;
+    while(lo<hi){
+        int mid=lo+(hi-lo)/2;
+        if(g->sorted_id[mid]<id) lo=mid+1; else hi=mid;
+    }
+    if(lo>=g->n || g->sorted_id[lo]!=id) return;
+    int pos=g->by_id[lo];
+    int ns= in ? in->slots_free : INT_MIN, np= in ? in->power_kW : INT_MIN;
+    if(g->st[pos].slots==ns && g->st[pos].power==np) return;
+    g->st[pos].slots=ns;
+    g->st[pos].power=np;
+
+    // Chemin de la racine au point (hauteur < 64 pour n < 2^31), calculé sans
+    // lecture ; remontée arrêtée au premier sous-arbre aux maxima inchangés
+    int plo[64], phi[64], d=0;
+    lo=0; hi=g->n;
+    for(;;){
+        plo[d]=lo; phi[d]=hi; d++;
+        int mid=lo+(hi-lo)/2;
+        if(hi-lo<=GEO_LEAF || mid==pos) break;
+        if(pos<mid) hi=mid; else lo=mid+1;
+    }
+    while(d>0){
+        d--;
+        const GeoStat* r=&g->st[plo[d]+(phi[d]-plo[d])/2];
+        int ms=r->max_slots, mp=r->max_power;
+        range_max(g,plo[d],phi[d]);
+        if(r->max_slots==ms && r->max_power==mp) return;
+    }
+}
+
+/* Candidat retenu : corde au carré et ID */
+typedef struct GeoHit {
+    double d2;
+    int id;
+} GeoHit;
+
+/* État d'une recherche : point cherché, filtres et tas des k meilleurs
+ * (racine = PIRE candidat retenu : plus loin ; à égalité, ID le plus grand) */
+typedef struct GeoSearch {
+    const GeoIndex* g;
+    double q[3];
+    double lim;             /* corde maximale au carré */
+    int min_slots, min_power;
+    GeoHit* h;
+    int size, cap;
+} GeoSearch;
+
+static int farther(const GeoHit* a, const GeoHit* b){
+    return a->d2>b->d2 || (a->d2==b->d2 && a->id>b->id);
+}
+
+static void hit_down(GeoSearch* s, int i){
+    for(;;){
+        int l=2*i+1, r=l+1, m=i;
+        if(l<s->size && farther(&s->h[l],&s->h[m])) m=l;
+        if(r<s->size && farther(&s->h[r],&s->h[m])) m=r;
+        if(m==i) return;
+        GeoHit x=s->h[i]; s->h[i]=s->h[m]; s->h[m]=x;
+        i=m;
+    }
+}
+
+/*
+ * Fonction auxiliaire : offer
+ * Description : Propose le point i (filtres, limite de distance, tas plein)
+ * Complexité temps : O(log k) si retenu, O(1) sinon
+ */
+static void offer(GeoSearch* s, int i){
+    const GeoIndex* g=s->g;
+    if(g->st[i].slots<s->min_slots || g->st[i].power<s->min_power) return;
+    double dx=g->x[i]-s->q[0], dy=g->y[i]-s->q[1], dz=g->z[i]-s->q[2];
+    GeoHit c={ dx*dx+dy*dy+dz*dz, g->id[i] };
+    if(c.d2>s->lim) return;
+    if(s->size<s->cap){
+        int j=s->size++;
+        s->h[j]=c;
+        while(j>0 && farther(&s->h[j],&s->h[(j-1)/2])){
+            GeoHit x=s->h[j]; s->h[j]=s->h[(j-1)/2]; s->h[(j-1)/2]=x;
+            j=(j-1)/2;
+        }
+        return;
+    }
+    if(!farther(&s->h[0],&c)) return;
+    s->h[0]=c;
+    hit_down(s,0);
+}
+
+/*
+ * Fonction auxiliaire récursive : search
+ * Description : Descente côté du point cherché d'abord ; l'autre côté n'est
+ *               visité que si le plan de coupe est plus proche que le pire
+ *               candidat retenu (ou la limite, tas incomplet). Un sous-arbre
+ *               dont les maxima échouent aux filtres est écarté entier.
+ * Complexité temps : O(log n + k) en moyenne - Complexité espace : O(log n)
+ */
+static void search(GeoSearch* s, int lo, int hi){
+    if(lo>=hi) return;
+    const GeoIndex* g=s->g;
+    int mid=lo+(hi-lo)/2;
+    if(g->st[mid].max_slots<s->min_slots || g->st[mid].max_power<s->min_power) return;
+    if(hi-lo<=GEO_LEAF){
+        for(int i=lo;i<hi;i++) offer(s,i);
+        return;
+    }
+    offer(s,mid);
+    const double* c= g->axis[mid]==0 ? g->x : g->axis[mid]==1 ? g->y : g->z;
+    double diff=s->q[g->axis[mid]]-c[mid];
+    int nlo= diff<0 ? lo : mid+1, nhi= diff<0 ? mid : hi;
+    int flo= diff<0 ? mid+1 : lo, fhi= diff<0 ? hi : mid;
+    search(s,nlo,nhi);
+    double bound= s->size==s->cap ? s->h[0].d2 : s->lim;
+    if(diff*diff<=bound) search(s,flo,fhi);
+}
+
+/*
+ * Fonction : geo_nearest
+ * Description : Recherche des k plus proches voisins filtrés ; une limite
+ *               de distance donne la requête par rayon (au plus k résultats)
+ * Retour : Nombre d'IDs écrits, -1 si échec d'allocation
+ * Complexité temps : O(log n + k log k) en moyenne - Complexité espace : O(k + log n)
+ */
+int geo_nearest(const GeoIndex* g, double lat, double lon, double max_km, int k,
+                int min_slots, int min_power, int* out_ids, double* out_km){
+    if(k<=0 || !out_ids || g->n==0) return 0;
+    if(k>g->n) k=g->n;
+    GeoSearch s;
+    s.g=g;
+    to_unit(lat,lon,&s.q[0],&s.q[1],&s.q[2]);
+    // Corde d'un arc de max_km ; au-delà du demi-tour, tout point convient
+    double ang= max_km<0 ? GEO_PI : max_km/GEO_EARTH_KM;
+    s.lim= ang>=GEO_PI ? 5.0 : 4.0*sin(ang/2)*sin(ang/2);
+    s.min_slots= min_slots>INT_MIN ? min_slots : INT_MIN+1;
+    s.min_power= min_power>INT_MIN ? min_power : INT_MIN+1;
+    s.h=(GeoHit*)malloc(sizeof(GeoHit)*(size_t)k);
+    if(!s.h) return -1;
+    s.size=0; s.cap=k;
+    search(&s,0,g->n);
+
+    // Extraction du plus loin au plus proche, rangée depuis la fin
+    int cnt=s.size;
+    for(int i=cnt-1;i>=0;i--){
+        GeoHit top=s.h[0];
+        s.h[0]=s.h[--s.size];
+        hit_down(&s,0);
+        out_ids[i]=top.id;
+        if(out_km){
+            double half=sqrt(top.d2)/2;
+            out_km[i]=2*GEO_EARTH_KM*asin(half<1 ? half : 1);
+        }
+    }
+    free(s.h);
+    return cnt;
+}
+
+/*
+ * Fonction : geo_clear
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+void geo_clear(GeoIndex* g){
+    free(g->id); free(g->x); free(g->y); free(g->z);
+    free(g->st); free(g->axis); free(g->sorted_id); free(g->by_id);
+    geo_init(g);
+}
@@ -0,0 +1,74 @@
+#ifndef DS_GEO_INDEX_H
+#define DS_GEO_INDEX_H
+#include "station_index.h"
+
+/*
+ * ============================================================================
+ * INDEX GÉOGRAPHIQUE : ARBRE K-D DES POSITIONS DES STATIONS
+ * ============================================================================
+ *
+ * Chaque station positionnée devient un point de la sphère unité (x, y, z) :
+ * la corde entre deux points croît avec la distance orthodromique, les
+ * plus proches voisins en corde sont donc les plus proches sur la Terre,
+ * sans cas particulier aux pôles ni à l'antiméridien.
+ * Arbre k-d implicite construit en une fois (médiane sur l'axe le plus
+ * étendu) : le sous-arbre [lo, hi) a sa racine en (lo + hi) / 2, les plages
+ * d'au plus GEO_LEAF points sont lues d'un bloc. Chaque sous-arbre porte les
+ * maxima de places libres et de puissance de ses stations : les filtres
+ * écartent un sous-arbre entier pendant la descente.
+ * Positions figées à la construction ; places libres et puissance tenues à
+ * jour par l'index (voir si_enable_geo), une station supprimée reste en
+ * place, éteinte.
+ */
+
+/* Taille maximale d'une feuille (plage lue séquentiellement) */
+#define GEO_LEAF 16
+
+/* Rayon moyen de la Terre (km) */
+#define GEO_EARTH_KM 6371.0088
+
+/* Filtres d'un point et maxima du sous-arbre dont il est la racine (une
+ * seule ligne de cache lue par nœud pendant une descente ou une mise à jour) */
+typedef struct GeoStat {
+    int slots;              /* places libres (INT_MIN : station supprimée) */
+    int power;              /* puissance en kW (INT_MIN : station supprimée) */
+    int max_slots;          /* maximum du sous-arbre */
+    int max_power;          /* idem pour la puissance */
+} GeoStat;
+
+/* Arbre k-d des stations, en colonnes rangées dans l'ordre de l'arbre */
+typedef struct GeoIndex {
+    int n;                  /* nombre de points */
+    int* id;                /* ID de la station du point i */
+    double* x, * y, * z;    /* position sur la sphère unité */
+    GeoStat* st;            /* filtres et maxima du point i */
+    unsigned char* axis;    /* axe de coupe du nœud i (0 = x, 1 = y, 2 = z) */
+    int* sorted_id;         /* IDs croissants ... */
+    int* by_id;             /* ... et position du point de chacun */
+} GeoIndex;
+
+/* Initialisation d'un index vide - O(1) */
+void geo_init(GeoIndex* g);
+
+/* Construction depuis des positions en degrés (doublons d'ID : la dernière
+ * gagne ; latitude hors [-90, 90] ou longitude hors [-180, 180] : ignorée) ;
+ * places libres et puissance lues dans idx (station absente : éteinte) -
+ * O(n log n). Retour : 1 si réussi, 0 si échec d'allocation (g inchangé) */
+int geo_build(GeoIndex* g, const GeoPoint* pts, int n, const StationIndex* idx);
+
+/* Répercussion d'une modification de station (in NULL : suppression) -
+ * O(log n). Rien si la station n'a pas de position */
+void geo_set(GeoIndex* g, int id, const StationInfo* in);
+
+/* Au plus k stations les plus proches de (lat, lon) à moins de max_km
+ * (max_km < 0 : sans limite), avec slots_free >= min_slots et
+ * power_kW >= min_power ; triées par distance croissante puis ID croissant,
+ * distances en km dans out_km (NULL accepté) - O(k log k + log n) en
+ * moyenne. Retour : nombre d'IDs écrits, -1 si échec d'allocation */
+int geo_nearest(const GeoIndex* g, double lat, double lon, double max_km, int k,
+                int min_slots, int min_power, int* out_ids, double* out_km);
+
+/* Libération (l'index redevient vide) - O(1) */
+void geo_clear(GeoIndex* g);
+
+#endif
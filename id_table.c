@@ -0,0 +1,243 @@
+#include "id_table.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Capacité initiale de la plage directe et de la table de hachage */
+#define IT_FIRST_CAP 64
+
+/*
+ * Fonction auxiliaire : hslot
+ * Description : Case initiale d'un ID dans la table de hachage
+ *               (hachage multiplicatif de Knuth, bits hauts repliés)
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+static unsigned hslot(int id, int cap){
+    unsigned h=(unsigned)id*2654435761u;
+    h^=h>>15;
+    return h&(unsigned)(cap-1);
+}
+
+/*
+ * Fonction auxiliaire : in_dense
+ * Description : Vrai si l'ID est couvert par la plage directe
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+static int in_dense(const IdTable* t, int id){
+    long long off=(long long)id-t->base;
+    return t->dense_cap>0 && off>=0 && off<t->dense_cap;
+}
+
+/*
+ * Fonction : it_init
+ * Description : Initialise une table vide (aucune allocation)
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+void it_init(IdTable* t){
+    memset(t,0,sizeof*t);
+}
+
+/*
+ * Fonction auxiliaire : hash_find
+ * Description : Case contenant l'ID dans la table de hachage, ou -1
+ * Complexité temps : O(1) en moyenne (facteur de charge <= 1/2)
+ * Complexité espace : O(1)
+ */
+static int hash_find(const IdTable* t, int id){
+    if(!t->hash_cap) return -1;
+    unsigned mask=(unsigned)t->hash_cap-1;
+    for(unsigned i=hslot(id,t->hash_cap); t->vals[i]; i=(i+1)&mask)
+        if(t->keys[i]==id) return (int)i;
+    return -1;
+}
+
+/*
+ * Fonction auxiliaire : hash_place
+ * Description : Range une entrée dans une table qui ne la contient pas
+ *               (place libre garantie par l'appelant)
+ * Complexité temps : O(1) en moyenne - Complexité espace : O(1)
+ */
+static void hash_place(int* keys, StationNode** vals, int cap, int id, StationNode* n){
+    unsigned mask=(unsigned)cap-1, i=hslot(id,cap);
+    while(vals[i]) i=(i+1)&mask;
+    keys[i]=id; vals[i]=n;
+}
+
+/*
+ * Fonction auxiliaire : hash_alloc
+ * Description : Alloue des tableaux de hachage vides de capacité cap
+ * Retour : 1 si réussi, 0 si échec d'allocation (rien n'est alloué)
+ * Complexité temps : O(cap) - Complexité espace : O(cap)
+ */
+static int hash_alloc(int cap, int** keys, StationNode*** vals){
+    *keys=(int*)malloc(sizeof(int)*(size_t)cap);
+    *vals=(StationNode**)calloc((size_t)cap,sizeof(StationNode*));
+    if(*keys && *vals) return 1;
+    free(*keys); free(*vals);
+    return 0;
+}
+
+/*
+ * Fonction auxiliaire : hash_refill
+ * Description : Remplace la table de hachage par des tableaux neufs (vides) et
+ *               y replace les entrées qui ne relèvent pas de la plage directe ;
+ *               les autres sont transférées dans la plage directe
+ * Complexité temps : O(ancienne capacité) - Complexité espace : O(1)
+ */
+static void hash_refill(IdTable* t, int* keys, StationNode** vals, int cap){
+    int count=0;
+    for(int i=0;i<t->hash_cap;i++){
+        if(!t->vals[i]) continue;
+        int id=t->keys[i];
+        if(in_dense(t,id)){
+            t->dense[id-t->base]=t->vals[i];
+            t->dense_count++;
+        }
+        else {
+            hash_place(keys,vals,cap,id,t->vals[i]);
+            count++;
+        }
+    }
+    free(t->keys); free(t->vals);
+    t->keys=keys; t->vals=vals; t->hash_cap=cap; t->hash_count=count;
+}
+
+/*
+ * Fonction auxiliaire : dense_extend
+ * Description : Tente d'étendre la plage directe pour couvrir id.
+ *               Refus si la plage obtenue serait remplie à moins de 50 %
+ *               (l'ID ira alors dans la table de hachage). La capacité double
+ *               à chaque extension, la marge étant laissée du côté de
+ *               l'extension (IDs croissants ou décroissants). Les IDs hachés
+ *               qui tombent dans la nouvelle plage y sont transférés.
+ * Retour : 1 si id est désormais couvert, 0 sinon
+ * Complexité temps : O(dense_cap + hash_cap), O(1) amorti par insertion
+ * Complexité espace : O(dense_cap)
+ */
+static int dense_extend(IdTable* t, int id){
+    long long lo= t->dense_cap ? t->base : id;
+    long long hi= t->dense_cap ? (long long)t->base+t->dense_cap : (long long)id+1;
+    long long nlo= id<lo ? id : lo;
+    long long nhi= (long long)id+1>hi ? (long long)id+1 : hi;
+    long long span=nhi-nlo;
+    if(span>IT_FIRST_CAP && (long long)(t->dense_count+1)*2<span) return 0;
+
+    long long ncap= t->dense_cap ? 2LL*t->dense_cap : IT_FIRST_CAP;
+    while(ncap<span) ncap*=2;
+    long long nbase= id<lo ? nhi-ncap : nlo;
+    if(ncap>(1LL<<30) || nbase<-2147483647LL-1 || nbase+ncap-1>2147483647LL) return 0;
+
+    // Tableaux alloués avant toute modification : un échec laisse la table intacte
+    int* keys=0;
+    StationNode** vals=0;
+    if(t->hash_count>0 && !hash_alloc(t->hash_cap,&keys,&vals)) return 0;
+    StationNode** d=(StationNode**)calloc((size_t)ncap,sizeof(StationNode*));
+    if(!d){ free(keys); free(vals); return 0; }
+    if(t->dense_cap) memcpy(&d[t->base-nbase],t->dense,sizeof(StationNode*)*(size_t)t->dense_cap);
+    free(t->dense);
+    t->dense=d; t->base=(int)nbase; t->dense_cap=(int)ncap;
+
+    // Transfert des IDs hachés désormais couverts par la plage directe
+    if(t->hash_count>0) hash_refill(t,keys,vals,t->hash_cap);
+    return 1;
+}
+
+/*
+ * Fonction : it_get
+ * Description : Nœud associé à un ID (accès direct, sinon hachage)
+ * Retour : Nœud, ou NULL si l'ID est absent
+ * Complexité temps : O(1) - Une case (plage directe) ou un sondage court
+ * Complexité espace : O(1)
+ */
+StationNode* it_get(const IdTable* t, int id){
+    if(in_dense(t,id)) return t->dense[id-t->base];
+    int i=hash_find(t,id);
+    return i<0 ? 0 : t->vals[i];
+}
+
+/*
+ * Fonction : it_put
+ * Description : Associe un ID à un nœud (remplace l'association existante)
+ * Paramètres :
+ *   - t : table
+ *   - id : identifiant de la station
+ *   - n : nœud de la station (non NULL)
+ * Retour : 1 si enregistré, 0 si échec d'allocation (table inchangée)
+ * Complexité temps : O(1) amorti
+ * Complexité espace : O(1) amorti
+ */
+int it_put(IdTable* t, int id, StationNode* n){
+    if(in_dense(t,id) || dense_extend(t,id)){
+        StationNode** slot=&t->dense[id-t->base];
+        if(!*slot) t->dense_count++;
+        *slot=n;
+        return 1;
+    }
+    int i=hash_find(t,id);
+    if(i>=0){ t->vals[i]=n; return 1; }
+    if((t->hash_count+1)*2>t->hash_cap){
+        int cap= t->hash_cap ? t->hash_cap*2 : IT_FIRST_CAP;
+        int* keys;
+        StationNode** vals;
+        if(!hash_alloc(cap,&keys,&vals)) return 0;
+        hash_refill(t,keys,vals,cap);
+    }
+    hash_place(t->keys,t->vals,t->hash_cap,id,n);
+    t->hash_count++;
+    return 1;
+}
+
+/*
+ * Fonction : it_remove
+ * Description : Retire un ID. Dans la table de hachage, les entrées suivantes
+ *               du même groupe sont recalées (suppression par décalage
+ *               arrière) : pas de marqueurs de suppression à nettoyer.
+ * Retour : 1 si l'ID était présent, 0 sinon
+ * Complexité temps : O(1) en moyenne
+ * Complexité espace : O(1)
+ */
+int it_remove(IdTable* t, int id){
+    if(in_dense(t,id)){
+        StationNode** slot=&t->dense[id-t->base];
+        if(!*slot) return 0;
+        *slot=0;
+        t->dense_count--;
+        return 1;
+    }
+    int i=hash_find(t,id);
+    if(i<0) return 0;
+    unsigned mask=(unsigned)t->hash_cap-1, hole=(unsigned)i, j=(unsigned)i;
+    t->vals[hole]=0;
+    for(;;){
+        j=(j+1)&mask;
+        if(!t->vals[j]) break;
+        unsigned k=hslot(t->keys[j],t->hash_cap);
+        // L'entrée j reste si sa case initiale k est dans (hole, j] (cycliquement)
+        int stays= hole<=j ? (hole<k && k<=j) : (hole<k || k<=j);
+        if(stays) continue;
+        t->keys[hole]=t->keys[j]; t->vals[hole]=t->vals[j];
+        t->vals[j]=0;
+        hole=j;
+    }
+    t->hash_count--;
+    return 1;
+}
+
+/*
+ * Fonction : it_count
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+int it_count(const IdTable* t){
+    return t->dense_count+t->hash_count;
+}
+
+/*
+ * Fonction : it_clear
+ * Description : Libère les deux tables ; la table redevient vide et réutilisable
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+void it_clear(IdTable* t){
+    free(t->dense);
+    free(t->keys);
+    free(t->vals);
+    it_init(t);
+}
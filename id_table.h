@@ -0,0 +1,50 @@
+#ifndef DS_ID_TABLE_H
+#define DS_ID_TABLE_H
+#include "station_index.h"
+
+/*
+ * ============================================================================
+ * TABLE D'IDS : RECHERCHE PONCTUELLE EN O(1)
+ * ============================================================================
+ *
+ * Associe un ID de station à son nœud (StationNode*), en complément de l'arbre :
+ *   - table à accès direct pour une plage compacte d'IDs [base, base + dense_cap)
+ *     (les IDs FRIZI_1001..1300 arrivent par blocs contigus) ;
+ *   - table de hachage à adressage ouvert (sondage linéaire) pour les IDs hors
+ *     de cette plage.
+ * La plage directe s'étend tant qu'elle reste remplie à au moins 50 %.
+ */
+
+typedef struct IdTable {
+    /* Accès direct */
+    int base;               /* premier ID couvert */
+    int dense_cap;          /* nombre d'IDs couverts (0 = pas de plage directe) */
+    int dense_count;        /* entrées occupées dans la plage directe */
+    StationNode** dense;    /* dense[id - base] */
+    /* Hachage (IDs hors plage directe) */
+    int hash_cap;           /* capacité (puissance de 2, 0 = non allouée) */
+    int hash_count;         /* entrées occupées */
+    int* keys;              /* IDs */
+    StationNode** vals;     /* nœuds (NULL = case vide) */
+} IdTable;
+
+/* Initialisation d'une table vide - O(1) */
+void it_init(IdTable* t);
+
+/* Nœud associé à un ID, ou NULL - O(1) */
+StationNode* it_get(const IdTable* t, int id);
+
+/* Association (ou remplacement) ID → nœud - O(1) amorti
+ * Retour : 1 si enregistré, 0 si échec d'allocation */
+int it_put(IdTable* t, int id, StationNode* n);
+
+/* Retrait d'un ID - O(1). Retour : 1 si présent, 0 sinon */
+int it_remove(IdTable* t, int id);
+
+/* Nombre d'IDs enregistrés - O(1) */
+int it_count(const IdTable* t);
+
+/* Libération de la mémoire (la table redevient vide) - O(1) */
+void it_clear(IdTable* t);
+
+#endif
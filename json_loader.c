@@ -37,6 +37,11 @@ int ds_load_stations_from_json(const char* path, StationIndex* idx){
     if(fread(buf, 1, sz, f)!=(size_t)sz){ free(buf); fclose(f); return -1; }
     buf[sz]=0; fclose(f);
 
+    /* Les stations sont accumulées puis chargées en une seule construction */
+    int cap = 64;
+    StationEntry* rows = (StationEntry*)malloc(sizeof(StationEntry) * cap);
+    if(!rows){ free(buf); return -1; }
+
     int inserted = 0;
     char* p = buf;
     while((p = strchr(p, '{'))){
@@ -54,11 +59,21 @@ int ds_load_stations_from_json(const char* path, StationIndex* idx){
             info.price_cents = 300;
             info.slots_free  = slots ? slots : 2;
             info.last_ts     = 0;
-            si_add(idx, id, info);
+            if(inserted == cap){
+                StationEntry* grown = (StationEntry*)realloc(rows, sizeof(StationEntry) * cap * 2);
+                if(!grown){ free(rows); free(buf); return -1; }
+                rows = grown;
+                cap *= 2;
+            }
+            rows[inserted].station_id = id;
+            rows[inserted].info = info;
             inserted++;
         }
         p = q+1;
     }
     free(buf);
-    return inserted;
+
+    int built = si_build_sorted(idx, rows, inserted);
+    free(rows);
+    return built < 0 ? -1 : inserted;
 }
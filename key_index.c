@@ -0,0 +1,235 @@
+#include "key_index.h"
+#include <stdlib.h>
+
+/*
+ * Fonctions auxiliaires : hauteur et taille d'un sous-arbre (NULL : -1 et 0)
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+static int kh(KeyNode* n){ return n? n->height : -1; }
+static int ks(KeyNode* n){ return n? n->size : 0; }
+
+/*
+ * Fonction auxiliaire : kupd
+ * Description : Recalcule hauteur et taille d'un nœud depuis ses enfants
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+static void kupd(KeyNode* n){
+    int hl=kh(n->left), hr=kh(n->right);
+    n->height=(hl>hr?hl:hr)+1;
+    n->size=ks(n->left)+ks(n->right)+1;
+}
+
+/*
+ * Fonction auxiliaire : kcmp
+ * Description : Compare deux couples (clé, ID) : <0, 0 ou >0
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+static int kcmp(int k1, int id1, int k2, int id2){
+    if(k1!=k2) return k1<k2 ? -1 : 1;
+    return id1<id2 ? -1 : id1>id2;
+}
+
+/*
+ * Fonctions auxiliaires : rotations droite / gauche
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+static KeyNode* krotR(KeyNode* y){
+    KeyNode* x=y->left;
+    y->left=x->right; x->right=y;
+    kupd(y); kupd(x);
+    return x;
+}
+static KeyNode* krotL(KeyNode* x){
+    KeyNode* y=x->right;
+    x->right=y->left; y->left=x;
+    kupd(x); kupd(y);
+    return y;
+}
+
+/*
+ * Fonction auxiliaire : kbalance
+ * Description : Rééquilibre un nœud (rotation simple ou double)
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+static KeyNode* kbalance(KeyNode* n){
+    kupd(n);
+    int bf=kh(n->left)-kh(n->right);
+    if(bf>1){
+        if(kh(n->left->right)>kh(n->left->left)) n->left=krotL(n->left);
+        return krotR(n);
+    }
+    if(bf<-1){
+        if(kh(n->right->left)>kh(n->right->right)) n->right=krotR(n->right);
+        return krotL(n);
+    }
+    return n;
+}
+
+/*
+ * Fonction : ki_init
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+void ki_init(KeyIndex* t){ t->root=0; }
+
+/*
+ * Fonction auxiliaire récursive : kins
+ * Description : Insère le nœud nn dans le sous-arbre r
+ * Complexité temps : O(log n) - Complexité espace : O(log n) (récursion)
+ */
+static KeyNode* kins(KeyNode* r, KeyNode* nn){
+    if(!r) return nn;
+    if(kcmp(nn->key,nn->id,r->key,r->id)<0) r->left=kins(r->left,nn);
+    else r->right=kins(r->right,nn);
+    return kbalance(r);
+}
+
+/*
+ * Fonction : ki_insert
+ * Description : Insère le couple (key, id), supposé absent
+ * Retour : 1 si inséré, 0 si échec d'allocation
+ * Complexité temps : O(log n) - Complexité espace : O(log n) (récursion)
+ */
+int ki_insert(KeyIndex* t, int key, int id){
+    KeyNode* nn=(KeyNode*)malloc(sizeof(KeyNode));
+    if(!nn) return 0;
+    nn->key=key; nn->id=id; nn->left=nn->right=0; nn->height=0; nn->size=1;
+    t->root=kins(t->root,nn);
+    return 1;
+}
+
+/*
+ * Fonctions auxiliaires récursives : kdel_min / kdel
+ * Description : kdel_min décroche le minimum d'un sous-arbre ; kdel retire le
+ *               couple (key, id) du sous-arbre r et rend le nœud retiré dans
+ *               *out (le successeur prend sa place, sans copie)
+ * Complexité temps : O(log n) - Complexité espace : O(log n) (récursion)
+ */
+static KeyNode* kdel_min(KeyNode* r, KeyNode** min){
+    if(!r->left){ *min=r; return r->right; }
+    r->left=kdel_min(r->left,min);
+    return kbalance(r);
+}
+static KeyNode* kdel(KeyNode* r, int key, int id, KeyNode** out){
+    if(!r) return 0;
+    int c=kcmp(key,id,r->key,r->id);
+    if(c<0) r->left=kdel(r->left,key,id,out);
+    else if(c>0) r->right=kdel(r->right,key,id,out);
+    else {
+        *out=r;
+        if(!r->left || !r->right) return r->left ? r->left : r->right;
+        KeyNode* s;
+        KeyNode* right=kdel_min(r->right,&s);
+        s->left=r->left; s->right=right;
+        return kbalance(s);
+    }
+    return kbalance(r);
+}
+
+/*
+ * Fonction : ki_delete
+ * Description : Supprime le couple (key, id)
+ * Retour : 1 si le couple était présent, 0 sinon
+ * Complexité temps : O(log n) - Complexité espace : O(log n) (récursion)
+ */
+int ki_delete(KeyIndex* t, int key, int id){
+    KeyNode* out=0;
+    t->root=kdel(t->root,key,id,&out);
+    if(!out) return 0;
+    free(out);
+    return 1;
+}
+
+/*
+ * Fonction : ki_move
+ * Description : Change la clé du couple (old_key, id) en new_key : le nœud
+ *               décroché est réinséré tel quel (ni libération ni allocation) ;
+ *               inséré s'il était absent
+ * Retour : 1 si réussi, 0 si échec d'allocation (couple absent au départ)
+ * Complexité temps : O(log n) - Complexité espace : O(log n) (récursion)
+ */
+int ki_move(KeyIndex* t, int old_key, int new_key, int id){
+    KeyNode* out=0;
+    t->root=kdel(t->root,old_key,id,&out);
+    if(!out) return ki_insert(t,new_key,id);
+    out->key=new_key; out->left=out->right=0; out->height=0; out->size=1;
+    t->root=kins(t->root,out);
+    return 1;
+}
+
+/*
+ * Fonction auxiliaire : count_below
+ * Description : Nombre de couples de clé < x (strict) ou <= x (large)
+ *               Une seule descente : chaque virage à droite ajoute le
+ *               sous-arbre gauche et le nœud courant
+ * Complexité temps : O(log n) - Complexité espace : O(1)
+ */
+static int count_below(const KeyNode* r, int x, int inclusive){
+    int c=0;
+    while(r){
+        if(r->key<x || (inclusive && r->key==x)){ c+=ks(r->left)+1; r=r->right; }
+        else r=r->left;
+    }
+    return c;
+}
+
+/*
+ * Fonction : ki_count_range
+ * Description : Nombre de couples de clé dans [lo, hi] par différence de rangs
+ * Complexité temps : O(log n) - Deux descentes
+ * Complexité espace : O(1)
+ */
+int ki_count_range(const KeyIndex* t, int lo, int hi){
+    if(lo>hi) return 0;
+    return count_below(t->root,hi,1)-count_below(t->root,lo,0);
+}
+
+/*
+ * Fonction auxiliaire récursive : krange
+ * Description : Parcours in-order limité à [lo, hi] (sous-arbres hors plage
+ *               ignorés), arrêté dès que cap IDs sont écrits
+ * Complexité temps : O(log n + k) - Complexité espace : O(log n)
+ */
+static int krange(const KeyNode* r, int lo, int hi, int* out, int cap, int w){
+    if(!r || w>=cap) return w;
+    if(r->key>=lo) w=krange(r->left,lo,hi,out,cap,w);
+    if(w<cap && r->key>=lo && r->key<=hi) out[w++]=r->id;
+    if(r->key<=hi) w=krange(r->right,lo,hi,out,cap,w);
+    return w;
+}
+
+/*
+ * Fonction : ki_range_ids
+ * Description : IDs des couples de clé dans [lo, hi], par (clé, ID) croissants
+ * Retour : Nombre d'IDs écrits (au plus cap)
+ * Complexité temps : O(log n + k) - Complexité espace : O(log n)
+ */
+int ki_range_ids(const KeyIndex* t, int lo, int hi, int* out, int cap){
+    if(lo>hi || cap<=0) return 0;
+    return krange(t->root,lo,hi,out,cap,0);
+}
+
+/*
+ * Fonction : ki_count
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+int ki_count(const KeyIndex* t){ return ks(t->root); }
+
+/*
+ * Fonction auxiliaire récursive : kfree
+ * Complexité temps : O(n) - Complexité espace : O(log n)
+ */
+static void kfree(KeyNode* r){
+    if(!r) return;
+    kfree(r->left);
+    kfree(r->right);
+    free(r);
+}
+
+/*
+ * Fonction : ki_clear
+ * Complexité temps : O(n) - Complexité espace : O(log n)
+ */
+void ki_clear(KeyIndex* t){
+    kfree(t->root);
+    t->root=0;
+}
@@ -0,0 +1,59 @@
+#ifndef DS_KEY_INDEX_H
+#define DS_KEY_INDEX_H
+
+/*
+ * ============================================================================
+ * INDEX SECONDAIRE ORDONNÉ : COUPLES (clé, ID)
+ * ============================================================================
+ *
+ * AVL de couples (clé, ID) triés par clé puis par ID, avec la taille de chaque
+ * sous-arbre. Sert d'index secondaire sur un attribut des stations
+ * (puissance, prix) : plusieurs stations partagent une même clé, l'ID rend
+ * chaque couple unique.
+ * Compter les couples d'une plage de clés coûte O(log n), les énumérer
+ * O(log n + k).
+ */
+
+/* Nœud de l'index secondaire */
+typedef struct KeyNode {
+    int key;                  /* valeur de l'attribut */
+    int id;                   /* identifiant de la station */
+    struct KeyNode* left;     /* couples inférieurs */
+    struct KeyNode* right;    /* couples supérieurs */
+    int height;               /* hauteur (équilibrage AVL) */
+    int size;                 /* nombre de couples du sous-arbre */
+} KeyNode;
+
+/* Index secondaire */
+typedef struct KeyIndex {
+    KeyNode* root;
+} KeyIndex;
+
+/* Initialisation d'un index vide - O(1) */
+void ki_init(KeyIndex* t);
+
+/* Insertion d'un couple absent - O(log n)
+ * Retour : 1 si inséré, 0 si échec d'allocation (index inchangé) */
+int ki_insert(KeyIndex* t, int key, int id);
+
+/* Suppression d'un couple - O(log n). Retour : 1 si présent, 0 sinon */
+int ki_delete(KeyIndex* t, int key, int id);
+
+/* Changement de clé d'un couple, sans réallocation (inséré s'il était
+ * absent) - O(log n). Retour : 1 si réussi, 0 si échec d'allocation */
+int ki_move(KeyIndex* t, int old_key, int new_key, int id);
+
+/* Nombre de couples dont la clé est dans [lo, hi] - O(log n) */
+int ki_count_range(const KeyIndex* t, int lo, int hi);
+
+/* IDs des couples dont la clé est dans [lo, hi], par (clé, ID) croissants
+ * (au plus cap) - O(log n + k). Retour : nombre d'IDs écrits */
+int ki_range_ids(const KeyIndex* t, int lo, int hi, int* out, int cap);
+
+/* Nombre total de couples - O(1) */
+int ki_count(const KeyIndex* t);
+
+/* Libération de tous les nœuds - O(n) */
+void ki_clear(KeyIndex* t);
+
+#endif
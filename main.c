@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
 
 #include "events.h"
 #include "queue.h"
@@ -8,6 +9,9 @@
 #include "csv_loader.h"
 #include "json_loader.h"
 #include "nary.h"
+#include "rules.h"
+#include "rule_plan.h"
+#include "rule_sub.h"
 
 #define MAX_VEH 100
 #define MRU_CAP 5
@@ -42,6 +46,49 @@ void add_to_mru(int veh_id, int station_id){
     if(count>MRU_CAP) ds_slist_remove_tail(&VEH_MRU[veh_id], &drop);
 }
 
+/* Valeurs par défaut d'une station inconnue créée par un événement */
+static const StationInfo DEFAULT_STATION = { 50, 300, 2, 0 };
+
+/*
+ * Fonction : apply_event
+ * Description : Applique un événement à l'état d'une station (appelée en place
+ *               par si_update, directement sur le nœud de l'AVL)
+ * Paramètres :
+ *   - info : informations de la station à modifier
+ *   - ctx : événement à appliquer (Event*)
+ * Complexité temps : O(1)
+ * Complexité espace : O(1)
+ */
+static void apply_event(StationInfo* info, void* ctx){
+    const Event* e = (const Event*)ctx;
+
+    // Mettre à jour selon l'action
+    if(e->action==1) { // Branchement (plug_in)
+        if(info->slots_free>0) info->slots_free--;
+    }
+    if(e->action==0) { // Débranchement (plug_out)
+        info->slots_free++;
+    }
+
+    info->last_ts = e->ts;
+}
+
+/*
+ * Fonction : print_alert
+ * Description : Notification d'un abonnement : affiche l'entrée ou la sortie
+ *               d'une station de l'ensemble de la règle
+ * Paramètres :
+ *   - ctx : nom de la règle (chaîne)
+ *   - sub : abonnement notifié (non utilisé)
+ *   - station_id : station concernée
+ *   - entered : 1 si elle satisfait désormais la règle, 0 sinon
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+static void print_alert(void* ctx, const RuleSub* sub, int station_id, int entered){
+    (void)sub;
+    printf("  [ALERT] Station %d %s \"%s\"\n", station_id, entered ? "enters" : "leaves", (const char*)ctx);
+}
+
 /*
  * Fonction : process_events
  * Description : Traite une file d'événements (branchement/débranchement de véhicules)
@@ -50,8 +97,8 @@ void add_to_mru(int veh_id, int station_id){
  *   - q : queue d'événements à traiter
  *   - idx : index AVL des stations
  * Complexité temps : O(k * log n) où k = nombre d'événements, n = nombre de stations
- *                    Chaque événement nécessite une recherche O(log n) et une insertion O(log n)
- * Complexité espace : O(log n) - Pile de récursion pour l'AVL
+ *                    Chaque événement est appliqué en place en une seule descente (si_update)
+ * Complexité espace : O(1) - Pas de récursion
  */
 void process_events(Queue* q, StationIndex* idx){
     Event e;
@@ -59,38 +106,11 @@ void process_events(Queue* q, StationIndex* idx){
         // Mettre à jour le MRU du véhicule
         add_to_mru(e.vehicle_id, e.station_id);
 
-        // Récupérer l'état actuel de la station (ou créer avec valeurs par défaut)
-        StationNode* sn = si_find(idx->root, e.station_id);
-        StationInfo info;
-        if(sn){
-            info=sn->info;
-        }
-        else {
-            // Valeurs par défaut pour une nouvelle station
-            info.power_kW=50;
-            info.price_cents=300;
-            info.slots_free=2;
-            info.last_ts=0;
-        }
-
-        // Mettre à jour selon l'action
-        if(e.action==1) { // Branchement (plug_in)
-            if(info.slots_free>0) info.slots_free--;
-        }
-        if(e.action==0) { // Débranchement (plug_out)
-            info.slots_free++;
-        }
-
-        info.last_ts = e.ts;
-
-        // Mettre à jour dans l'AVL
-        si_add(idx, e.station_id, info);
+        // Mettre à jour la station en place (créée avec les valeurs par défaut si absente)
+        si_update(idx, e.station_id, &DEFAULT_STATION, apply_event, &e);
     }
 }
 
-/* Déclaration de la fonction d'évaluation des règles postfix (définie dans rules.c) */
-int eval_rule_postfix(char* toks[], int n, StationInfo* info);
-
 /*
  * Fonction : demo_query_top_n
  * Description : Démonstration d'une requête Top-N avec filtrage par règle postfix
@@ -102,43 +122,44 @@ int eval_rule_postfix(char* toks[], int n, StationInfo* info);
  *   - n : nombre maximum de résultats à afficher
  *
  * Algorithme :
- *   1) Récupérer toutes les stations triées par ID (parcours in-order de l'AVL)
- *   2) Filtrer avec la règle postfix
- *   3) Sélectionner les N premiers résultats
+ *   1) Planifier la règle (rule_plan) : bornes déduites des comparaisons,
+ *      choix du chemin d'accès, affichage du plan (rule_explain)
+ *   2) Exécuter le plan : curseur par ID croissant élagué par les bornes,
+ *      ou index secondaire s'il est plus sélectif ; arrêt après N résultats
+ *   3) Afficher les N premiers résultats (recherche par ID)
  *
- * Complexité temps : O(m + k) où m = nombre total de stations, k = stations matchées
- *                    Parcours in-order O(m) + filtrage O(m) + affichage O(min(n,k))
- * Complexité espace : O(m) - Tableau temporaire pour stocker tous les IDs
+ * Complexité temps : O(m) au pire où m = nombre total de stations
+ *                    (arrêt dès N résultats trouvés, sous-arbres hors bornes sautés)
+ * Complexité espace : O(N) - Tableau des résultats
  */
 void demo_query_top_n(StationIndex* idx, char* rule[], int rule_len, int n) {
     printf("\n=== Query: Top-%d stations matching rule ===\n", n);
+    if (n <= 0) return;
 
-    // Étape 1 : Récupérer TOUTES les stations triées par ID (Parcours In-Order de l'AVL)
-    int buffer_cap = 1024;
-    int* ids = (int*)malloc(sizeof(int) * buffer_cap);
-    if (!ids) return;
-
-    int total_stations = si_to_array(idx->root, ids, buffer_cap);
-
-    // Étape 2 & 3 : Filtrer et Sélectionner les N premiers
-    int found_count = 0;
-    for (int i = 0; i < total_stations && found_count < n; i++) {
-        StationNode* s = si_find(idx->root, ids[i]);
+    // Étape 1 : Plan d'exécution de la règle
+    RulePlan plan;
+    rule_plan(idx, rule, rule_len, INT_MIN, INT_MAX, n, &plan);
+    char explain[256];
+    rule_explain(&plan, explain, (int)sizeof explain);
+    printf("  Plan: %s\n", explain);
 
-        // Application de la règle Postfix
-        if (s && eval_rule_postfix(rule, rule_len, &s->info)) {
-            printf("  [MATCH #%d] Station %d : Power=%dkW, Slots=%d, Price=%d centimes\n",
-                   found_count + 1, s->station_id, s->info.power_kW,
-                   s->info.slots_free, s->info.price_cents);
-            found_count++;
-        }
+    // Étape 2 : Exécution (N premiers IDs qualifiés, croissants)
+    int* ids = (int*)malloc(sizeof(int) * n);
+    if (!ids) return;
+    int found_count = rule_run(idx, &plan, rule, rule_len, ids);
+
+    // Étape 3 : Affichage
+    for (int i = 0; i < found_count; i++) {
+        StationNode* s = si_find_idx(idx, ids[i]);
+        printf("  [MATCH #%d] Station %d : Power=%dkW, Slots=%d, Price=%d centimes\n",
+               i + 1, s->station_id, s->info.power_kW,
+               s->info.slots_free, s->info.price_cents);
     }
+    free(ids);
 
     if (found_count == 0) {
         printf("  No stations match this rule.\n");
     }
-
-    free(ids);
 }
 
 /*
@@ -160,13 +181,14 @@ int main(void){
 
     // Initialisation de l'index AVL et de la queue d'événements
     StationIndex idx; si_init(&idx);
+    si_enable_lookup(&idx); // recherches par ID en O(1) (repli sur l'arbre si échec)
     Queue q; q_init(&q);
 
     /* ========== CHARGEMENT DES DONNÉES ========== */
     printf("=== Loading Datasets ===\n");
 
-    // Chargement du CSV (300 stations réelles)
-    int c1 = ds_load_stations_from_csv("izivia_tp_subset.csv", &idx);
+    // Chargement du CSV (300 stations réelles), fichier projeté en mémoire
+    int c1 = ds_load_stations_from_csv_mmap("izivia_tp_subset.csv", &idx);
     printf("CSV loaded: %d stations\n", c1);
 
     // Chargement du JSON (10 stations - optionnel)
@@ -182,8 +204,15 @@ int main(void){
     for(int i=0;i<DS_EVENTS_COUNT;i++) {
         q_enqueue(&q, DS_EVENTS[i]);
     }
+    // Abonnement : chaque événement ne réévalue la règle que pour sa station
+    char* alert_rule[] = { "power","50",">=","slots","2",">=","&&" };
+    RuleSub* alert = si_sub_register(&idx, alert_rule, 7, print_alert, "power >= 50 && slots >= 2");
     process_events(&q, &idx);
     printf("Processed %d events\n", DS_EVENTS_COUNT);
+    if(alert){
+        printf("Subscription \"power >= 50 && slots >= 2\": %d stations\n", si_sub_count(&idx, alert));
+        si_sub_unregister(&idx, alert);
+    }
 
     /* ========== DÉMONSTRATION 1 : AVL SIDEWAYS ========== */
     printf("\n=== AVL Tree Structure (Sideways View) ===\n");
@@ -193,18 +222,19 @@ int main(void){
     /* ========== DÉMONSTRATION 2 : RÈGLE POSTFIX SIMPLE ========== */
     printf("\n=== Rule Filtering: power >= 50 && slots >= 1 ===\n");
     char* rule1[] = { "slots","1",">=","power","50",">=","&&" };
-    int ids[64];
-    int k = si_to_array(idx.root, ids, 64);
+    RuleProgram prog1;
+    rule_compile(rule1, 7, &prog1); // compilée une fois, évaluée sur chaque station
+    SiIter it;
+    si_iter_seek(&it, &idx, INT_MIN, INT_MAX);
     printf("Matching stations (first 40): ");
-    int displayed = 0;
-    for(int i=0; i<k && displayed<40; i++){
-        StationNode* s = si_find(idx.root, ids[i]);
-        if(s && eval_rule_postfix(rule1, 7, &s->info)) {
-            printf("%d ", ids[i]);
-            displayed++;
+    int displayed = 0, matched = 0, k = 0;
+    for(StationNode* s; (s = si_iter_next(&it)); k++){
+        if(rule_eval(&prog1, &s->info)) {
+            if(displayed<40){ printf("%d ", s->station_id); displayed++; }
+            matched++;
         }
     }
-    printf("\n(Total: %d/%d stations in AVL)\n", k, k);
+    printf("\n(Total: %d/%d stations in AVL)\n", matched, k);
 
     /* ========== DÉMONSTRATION 3 : HISTORIQUE MRU ========== */
     printf("\n=== Vehicle MRU History (Last Visited Stations) ===\n");
@@ -261,8 +291,8 @@ int main(void){
 
     /* ========== DÉMONSTRATION 6 : FONCTIONS MIN/MAX ========== */
     printf("\n=== AVL Min/Max Stations ===\n");
-    StationNode* min_station = si_min(idx.root);
-    StationNode* max_station = si_max(idx.root);
+    StationNode* min_station = si_min_idx(&idx);
+    StationNode* max_station = si_max_idx(&idx);
     if(min_station){
         printf("Min station ID: %d (Power=%dkW, Slots=%d)\n",
                min_station->station_id, min_station->info.power_kW,
@@ -44,9 +44,14 @@ void demo_modules_standalone() {
     printf("\n>>> MODULE A1 : Requettes par plages (Range Queries)\n");
     printf("    Objectif : Extraire des donnees sans parcourir toute la base.\n\n");
 
-    // Test 1 : Plage d'identifiants
-    int range_ids[100];
-    int count = si_range_ids(idx.root, 1100, 1150, range_ids, 100); // [cite: 51, 160]
+    // Test 1 : Plage d'identifiants (curseur : pas de tableau à dimensionner)
+    int range_ids[10];
+    int count = 0;
+    SiIter it;
+    si_iter_seek(&it, &idx, 1100, 1150); // [cite: 51, 160]
+    for (StationNode* s; (s = si_iter_next(&it)); count++) {
+        if (count < 10) range_ids[count] = s->station_id;
+    }
     printf("  Test 1 : Stations dans la zone ID [1100, 1150]\n");
     printf("    -> %d stations trouves.\n", count);
     printf("    Premie"
@@ -55,15 +60,28 @@ void demo_modules_standalone() {
         printf("%d ", range_ids[i]);
     }
     printf("%s\n\n", count > 10 ? "..." : "");
+
+    // Test 1bis : comptage et pagination par rangs (statistiques d'ordre)
+    int total = si_count_range(idx.root, 1100, 1150);
+    int page[10];
+    int page_len = si_range_page(idx.root, 1100, 1150, 20, page, 10);
+    printf("  Test 1bis : Comptage O(log n) et page 3 (10 par page) de [1100, 1150]\n");
+    printf("    -> %d stations dans la zone, rang de la station 1100 : %d\n",
+           total, si_rank(idx.root, 1100));
+    printf("    Page 3 : ");
+    for (int i = 0; i < page_len; i++) {
+        printf("%d ", page[i]);
+    }
+    printf("\n\n");
     wait_user();
 
     // Test 2 : Filtre par puissance
-    int high_power = si_count_ge_power(idx.root, 100); // [cite: 161]
+    int high_power = si_count_ge_power_idx(&idx, 100); // [cite: 161]
     printf("  Test 2 : Stations Haute Puissance (>= 100 kW)\n");
     printf("    -> %d stations identifiees.\n", high_power);
     // Test 3 : Comptage stations >= 50 kW
     printf("  Test 3 : Comptage des stations avec puissance >= 50 kW\n");
-    int medium_power_count = si_count_ge_power(idx.root, 50);
+    int medium_power_count = si_count_ge_power_idx(&idx, 50);
     printf("    Resultat : %d stations\n\n", medium_power_count);
     wait_user();
 
@@ -76,7 +94,7 @@ void demo_modules_standalone() {
     int top5[5];
     int k = si_top_k_by_score(idx.root, 5, top5, 2, 1, 1);
     for (int i = 0; i < k; i++) {
-        StationNode* s = si_find(idx.root, top5[i]);
+        StationNode* s = si_find_idx(&idx, top5[i]);
         if (s) {
             int score = s->info.slots_free * 2 + s->info.power_kW * 1 - s->info.price_cents * 1;
             printf("    #%d - Station %d (score=%d, slots=%d, power=%dkW, price=%dc)\n",
@@ -92,7 +110,7 @@ void demo_modules_standalone() {
     int top3[3];
     k = si_top_k_by_score(idx.root, 3, top3, 10, 1, 1);
     for (int i = 0; i < k; i++) {
-        StationNode* s = si_find(idx.root, top3[i]);
+        StationNode* s = si_find_idx(&idx, top3[i]);
         if (s) {
             int score = s->info.slots_free * 10 + s->info.power_kW * 1 - s->info.price_cents * 1;
             printf("    #%d - Station %d (score=%d, slots=%d)\n",
@@ -0,0 +1,249 @@
+#include "query_cache.h"
+#include "advanced_queries.h"
+#include "rules.h"
+#include "rule_plan.h"
+#include "rule_opt.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <limits.h>
+
+/*
+ * Fonction : qc_init
+ * Complexité temps : O(capacity) - Complexité espace : O(capacity)
+ */
+int qc_init(QueryCache* c, int capacity){
+    int sets=1;
+    while(sets*QC_WAYS<capacity && sets<(1<<24)) sets*=2;
+    memset(c,0,sizeof*c);
+    c->e=(QcEntry*)calloc((size_t)sets*QC_WAYS,sizeof(QcEntry));
+    if(!c->e) return 0;
+    c->nsets=sets;
+    return 1;
+}
+
+/* Empreinte FNV-1a 64 bits, prolongée octet par octet */
+static unsigned long long fnv(unsigned long long h, const void* p, size_t n){
+    const unsigned char* b=(const unsigned char*)p;
+    for(size_t i=0;i<n;i++){ h^=b[i]; h*=1099511628211ULL; }
+    return h;
+}
+#define FNV_SEED 14695981039346656037ULL
+
+static int gcd(int a, int b){
+    while(b){ int t=a%b; a=b; b=t; }
+    return a;
+}
+
+/*
+ * Fonction auxiliaire : slot_of
+ * Description : Entrée de la requête dans son ensemble (match non NULL :
+ *               compare les paramètres), sinon la victime de l'ensemble
+ *               (entrée libre, ou la moins récemment utilisée)
+ * Retour : l'entrée ; *found = 1 si c'est la requête
+ * Complexité temps : O(QC_WAYS) comparaisons
+ */
+static QcEntry* slot_of(QueryCache* c, unsigned long long hash,
+                        int (*match)(const QcEntry*, const void*), const void* q, int* found){
+    QcEntry* set=&c->e[(size_t)(hash&(unsigned long long)(c->nsets-1))*QC_WAYS];
+    QcEntry* victim=&set[0];
+    for(int w=0;w<QC_WAYS;w++){
+        QcEntry* e=&set[w];
+        if(e->kind && e->hash==hash && match(e,q)){ *found=1; return e; }
+        if(victim->kind && (!e->kind || e->used<victim->used)) victim=e;
+    }
+    *found=0;
+    return victim;
+}
+
+/* Libère ce que possède une entrée (résultat, règle, optimiseur) et la vide */
+static void entry_release(QcEntry* e){
+    free(e->ids);
+    free(e->rule);
+    free(e->opt);
+    memset(e,0,sizeof*e);
+}
+
+/*
+ * Fonction auxiliaire : store
+ * Description : Mémorise un résultat dans l'entrée (rien si l'allocation
+ *               échoue : l'entrée est alors libérée)
+ * Retour : 1 si mémorisé, 0 sinon
+ */
+static int store(QcEntry* e, const int* ids, int n){
+    int* d=(int*)realloc(e->ids,sizeof(int)*(size_t)(n+1));
+    if(!d){ entry_release(e); return 0; }
+    e->ids=d;
+    memcpy(d,ids,sizeof(int)*(size_t)n);
+    e->n=n;
+    return 1;
+}
+
+/* Requête top-k normalisée */
+typedef struct TopKQ {
+    int a, b, g;
+} TopKQ;
+
+static int match_topk(const QcEntry* e, const void* q){
+    const TopKQ* t=(const TopKQ*)q;
+    return e->kind==1 && e->alpha==t->a && e->beta==t->b && e->gamma==t->g;
+}
+
+/*
+ * Fonction : qc_top_k
+ * Description : Succès si l'entrée vient du même index, à la même version,
+ *               et couvre k (k mémorisé >= k, ou moins de stations que le k
+ *               mémorisé) ; sinon calcul par si_top_k_idx puis mémorisation
+ * Retour : nombre d'IDs écrits
+ * Complexité temps : O(k) si succès - Complexité espace : O(k) par entrée
+ */
+int qc_top_k(QueryCache* c, StationIndex* idx, int k, int* out_ids,
+             int alpha, int beta, int gamma){
+    if(k<=0 || !out_ids) return 0;
+    TopKQ q={ alpha, beta, gamma };
+    int d=gcd(gcd(abs(alpha),abs(beta)),abs(gamma));
+    if(d>1){ q.a/=d; q.b/=d; q.g/=d; }
+    unsigned long long h=fnv(FNV_SEED,"T",1);
+    h=fnv(h,&q,sizeof q);
+
+    int found;
+    QcEntry* e=slot_of(c,h,match_topk,&q,&found);
+    c->tick++;
+    if(found && e->uid==idx->uid && e->stamp==idx->version && (k<=e->asked || e->n<e->asked)){
+        int n= k<e->n ? k : e->n;
+        memcpy(out_ids,e->ids,sizeof(int)*(size_t)n);
+        e->used=c->tick;
+        c->hits++;
+        return n;
+    }
+    c->misses++;
+    int n=si_top_k_idx(idx,k,out_ids,alpha,beta,gamma);
+    if(!found){
+        free(e->rule);
+        free(e->opt);
+        e->rule=0;
+        e->opt=0;
+        e->kind=1; e->hash=h;
+        e->alpha=q.a; e->beta=q.b; e->gamma=q.g;
+    }
+    if(store(e,out_ids,n)){
+        e->uid=idx->uid; e->stamp=idx->version; e->asked=k; e->used=c->tick;
+    }
+    return n;
+}
+
+/*
+ * Fonction auxiliaire : canon_rule
+ * Description : Forme canonique d'une règle : les champs et opérateurs sont
+ *               gardés, tout autre token devient la valeur décimale que lui
+ *               donne l'évaluation (atoi) ; tokens séparés par ' '
+ * Retour : chaîne allouée, NULL si échec d'allocation
+ * Complexité temps : O(taille de la règle)
+ */
+static char* canon_rule(char* toks[], int n){
+    static const char* kw[]={ "power","price","slots",">=","<=",">","<","==","&&","||" };
+    size_t len=1;
+    for(int i=0;i<n;i++) len+=strlen(toks[i])+13;
+    char* s=(char*)malloc(len);
+    if(!s) return 0;
+    size_t w=0;
+    for(int i=0;i<n;i++){
+        const char* t=toks[i];
+        int keep=0;
+        for(size_t j=0;j<sizeof kw/sizeof kw[0] && !keep;j++) keep=strcmp(t,kw[j])==0;
+        if(w) s[w++]=' ';
+        if(keep){ size_t l=strlen(t); memcpy(s+w,t,l); w+=l; }
+        else w+=(size_t)sprintf(s+w,"%d",atoi(t));
+    }
+    s[w]='\0';
+    return s;
+}
+
+/* Requête de règle normalisée */
+typedef struct RuleQ {
+    const char* rule;
+    int lo, hi;
+} RuleQ;
+
+static int match_rule(const QcEntry* e, const void* q){
+    const RuleQ* r=(const RuleQ*)q;
+    return e->kind==2 && e->lo==r->lo && e->hi==r->hi && strcmp(e->rule,r->rule)==0;
+}
+
+/*
+ * Fonction : qc_rule_ids
+ * Description : Succès si l'entrée vient du même index, couvre cap, et si
+ *               aucun ID dont elle dépend n'a été écrit depuis son calcul :
+ *               [lo, dernier ID rendu] quand le curseur s'est arrêté au
+ *               cap-ième résultat, [lo, hi] sinon
+ * Retour : nombre d'IDs écrits
+ * Complexité temps : O(cap + n) si succès - Complexité espace : O(cap) par entrée
+ */
+int qc_rule_ids(QueryCache* c, StationIndex* idx, char* toks[], int n,
+                int lo, int hi, int* out, int cap){
+    if(!out || cap<=0) return 0;
+    si_enable_versions(idx);
+    char* rule=canon_rule(toks,n);
+    if(!rule){ c->misses++; return si_rule_ids(idx,toks,n,lo,hi,out,cap); }
+    RuleQ q={ rule, lo, hi };
+    unsigned long long h=fnv(FNV_SEED,"R",1);
+    h=fnv(h,rule,strlen(rule));
+    h=fnv(h,&lo,sizeof lo);
+    h=fnv(h,&hi,sizeof hi);
+
+    int found;
+    QcEntry* e=slot_of(c,h,match_rule,&q,&found);
+    c->tick++;
+    if(found && e->uid==idx->uid && (cap<=e->asked || e->n<e->asked)
+       && (e->stamp==idx->version || si_range_version(idx,e->dep_lo,e->dep_hi)<=e->stamp)){
+        free(rule);
+        e->stamp=idx->version;  /* toujours exact : inutile de revérifier les plages */
+        int m= cap<e->n ? cap : e->n;
+        memcpy(out,e->ids,sizeof(int)*(size_t)m);
+        e->used=c->tick;
+        c->hits++;
+        return m;
+    }
+    c->misses++;
+    if(found) free(rule);
+    else {
+        free(e->rule);
+        free(e->opt);
+        e->rule=rule;
+        e->opt=0;
+        e->kind=2; e->hash=h;
+        e->lo=lo; e->hi=hi;
+    }
+    /* Même plan que si_rule_ids, avec l'optimiseur de l'entrée (règle de même forme canonique) */
+    RulePlan plan;
+    rule_plan(idx,toks,n,lo,hi,cap,&plan);
+    if(plan.compiled && !e->opt){
+        e->opt=(RuleOpt*)malloc(sizeof(RuleOpt));
+        if(e->opt) ro_build(e->opt,&plan.prog);
+    }
+    int m=rule_run_opt(idx,&plan,e->opt,toks,n,out);
+    if(store(e,out,m)){
+        e->uid=idx->uid; e->stamp=idx->version; e->asked=cap; e->used=c->tick;
+        e->dep_lo=lo;
+        e->dep_hi= m==cap ? out[m-1] : hi;
+    }
+    return m;
+}
+
+/*
+ * Fonction : qc_reset
+ * Complexité temps : O(capacity) - Complexité espace : O(1)
+ */
+void qc_reset(QueryCache* c){
+    for(int i=0;i<c->nsets*QC_WAYS;i++) entry_release(&c->e[i]);
+}
+
+/*
+ * Fonction : qc_clear
+ * Complexité temps : O(capacity) - Complexité espace : O(1)
+ */
+void qc_clear(QueryCache* c){
+    if(c->e) qc_reset(c);
+    free(c->e);
+    memset(c,0,sizeof*c);
+}
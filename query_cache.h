@@ -0,0 +1,80 @@
+#ifndef DS_QUERY_CACHE_H
+#define DS_QUERY_CACHE_H
+#include "station_index.h"
+
+/*
+ * ============================================================================
+ * CACHE DE RÉSULTATS DE REQUÊTES (TOP-K, RÈGLES POSTFIX)
+ * ============================================================================
+ *
+ * Les résultats sont rangés sous la requête normalisée :
+ *   - top-k : poids (alpha, beta, gamma) divisés par leur PGCD (le
+ *     classement ne change pas), k à part : un top-k mémorisé sert tout k
+ *     plus petit ;
+ *   - règle : tokens réécrits sous forme canonique (nombres décimaux sans
+ *     zéro ni signe superflu) et plage d'IDs ; de même pour cap.
+ * Chaque résultat est daté de la version de l'index au calcul (voir
+ * StationIndex.version) et porte l'identifiant de l'index. Un top-k dépend
+ * de toutes les stations : toute écriture l'invalide. Une règle ne dépend que
+ * des IDs lus par son curseur : elle reste valide tant qu'aucune plage
+ * d'IDs lue n'a été écrite (si_range_version), une écriture ailleurs ne la
+ * touche pas. Un succès recopie le résultat : O(k). Une entrée de règle
+ * garde aussi son optimiseur (rule_opt) : ses compteurs de sélectivité
+ * s'accumulent d'un recalcul à l'autre.
+ * Cache associatif par ensembles de QC_WAYS entrées, remplacement de la
+ * moins récemment utilisée. Un cache ne sert qu'un thread à la fois.
+ */
+
+/* Nombre d'entrées par ensemble */
+#define QC_WAYS 4
+
+/* Résultat mémorisé */
+typedef struct QcEntry {
+    unsigned long long hash;    /* empreinte de la requête normalisée */
+    int kind;                   /* 0 : libre, 1 : top-k, 2 : règle */
+    int alpha, beta, gamma;     /* top-k : poids normalisés */
+    char* rule;                 /* règle : tokens canoniques séparés par ' ' */
+    int lo, hi;                 /* règle : plage d'IDs demandée */
+    unsigned uid;               /* index qui a produit le résultat */
+    unsigned long long stamp;   /* version de l'index à laquelle il est exact */
+    int dep_lo, dep_hi;         /* règle : IDs dont il dépend */
+    int asked;                  /* k ou cap du calcul */
+    int n;                      /* nombre d'IDs */
+    int* ids;                   /* résultat */
+    struct RuleOpt* opt;        /* règle : optimiseur gardé entre les recalculs
+                                   (NULL : règle non compilée ou mémoire manquante) */
+    unsigned long long used;    /* dernier usage (remplacement) */
+} QcEntry;
+
+/* Cache */
+typedef struct QueryCache {
+    int nsets;                  /* nombre d'ensembles (puissance de 2) */
+    QcEntry* e;                 /* nsets * QC_WAYS entrées */
+    unsigned long long tick;    /* horloge des usages */
+    long long hits, misses;     /* statistiques */
+} QueryCache;
+
+/* Initialisation d'un cache d'au moins capacity entrées (arrondi à une
+ * puissance de 2, QC_WAYS au minimum) - O(capacity).
+ * Retour : 1 si réussi, 0 si échec d'allocation */
+int qc_init(QueryCache* c, int capacity);
+
+/* si_top_k_idx servi par le cache - O(k) si succès, coût de si_top_k_idx
+ * sinon. Retour : nombre d'IDs écrits (même résultat que si_top_k_idx) */
+int qc_top_k(QueryCache* c, StationIndex* idx, int k, int* out_ids,
+             int alpha, int beta, int gamma);
+
+/* si_rule_ids servi par le cache ; active les versions par plage de l'index
+ * (si_enable_versions) au premier appel - O(k + n) si succès (n = tokens),
+ * coût de si_rule_ids sinon, avec l'optimiseur de l'entrée (rule_run_opt).
+ * Retour : nombre d'IDs écrits (même résultat que si_rule_ids) */
+int qc_rule_ids(QueryCache* c, StationIndex* idx, char* toks[], int n,
+                int lo, int hi, int* out, int cap);
+
+/* Oubli de tous les résultats (statistiques conservées) - O(capacity) */
+void qc_reset(QueryCache* c);
+
+/* Libération du cache - O(capacity) */
+void qc_clear(QueryCache* c);
+
+#endif
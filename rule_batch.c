@@ -0,0 +1,286 @@
+#include "rule_batch.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RB_HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+typedef unsigned long long u64;
+
+/*
+ * Noyaux de comparaison de len <= 64 lignes : bits de a[i] > y et de
+ * a[i] == y, y = b[i] (colonne) ou la constante c si b est NULL
+ */
+typedef void (*CmpKernel)(const int* a, const int* b, int c, int len, u64* gt, u64* eq);
+
+static void cmp_scalar(const int* a, const int* b, int c, int len, u64* gt, u64* eq){
+    u64 g=0, e=0;
+    for(int i=0;i<len;i++){
+        int y= b ? b[i] : c;
+        g|=(u64)(a[i]>y)<<i;
+        e|=(u64)(a[i]==y)<<i;
+    }
+    *gt=g; *eq=e;
+}
+
+#ifdef RB_HAVE_X86
+/* 4 lignes par comparaison (pcmpgtd / pcmpeqd), masques par movmskps */
+__attribute__((target("sse4.1")))
+static void cmp_sse41(const int* a, const int* b, int c, int len, u64* gt, u64* eq){
+    u64 g=0, e=0;
+    int i=0;
+    const __m128i vc=_mm_set1_epi32(c);
+    for(; i+4<=len; i+=4){
+        __m128i x=_mm_loadu_si128((const __m128i*)(a+i));
+        __m128i y= b ? _mm_loadu_si128((const __m128i*)(b+i)) : vc;
+        g|=(u64)(unsigned)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(x,y)))<<i;
+        e|=(u64)(unsigned)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x,y)))<<i;
+    }
+    u64 tg, te;
+    cmp_scalar(a+i, b ? b+i : NULL, c, len-i, &tg, &te);
+    *gt=g|(i<64 ? tg<<i : 0); *eq=e|(i<64 ? te<<i : 0);
+}
+
+/* 8 lignes par comparaison */
+__attribute__((target("avx2")))
+static void cmp_avx2(const int* a, const int* b, int c, int len, u64* gt, u64* eq){
+    u64 g=0, e=0;
+    int i=0;
+    const __m256i vc=_mm256_set1_epi32(c);
+    for(; i+8<=len; i+=8){
+        __m256i x=_mm256_loadu_si256((const __m256i*)(a+i));
+        __m256i y= b ? _mm256_loadu_si256((const __m256i*)(b+i)) : vc;
+        g|=(u64)(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(x,y)))<<i;
+        e|=(u64)(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x,y)))<<i;
+    }
+    u64 tg, te;
+    cmp_scalar(a+i, b ? b+i : NULL, c, len-i, &tg, &te);
+    *gt=g|(i<64 ? tg<<i : 0); *eq=e|(i<64 ? te<<i : 0);
+}
+#endif
+
+/* Masque d'une comparaison (ordre de RuleOp : >=, <=, >, <, ==) */
+static u64 cmp_bits(int k, u64 gt, u64 eq, u64 full){
+    switch(k){
+        case 0: return gt|eq;
+        case 1: return ~gt&full;
+        case 2: return gt;
+        case 3: return ~(gt|eq)&full;
+        default: return eq;
+    }
+}
+
+static int cmp_apply(int k, int a, int b){
+    switch(k){
+        case 0: return a>=b;
+        case 1: return a<=b;
+        case 2: return a>b;
+        case 3: return a<b;
+        default: return a==b;
+    }
+}
+
+static const int CMP_MIRROR[]={ 1, 0, 3, 2, 4 };
+
+/* Valeur de la pile d'un bloc : masque (booléens), colonne ou constante */
+enum { BV_MASK = 0, BV_VEC = 1, BV_CONST = 2 };
+typedef struct BVal {
+    int kind;
+    int c;                  /* BV_CONST */
+    const int* v;           /* BV_VEC : 64 valeurs (ou moins au dernier bloc) */
+    u64 m;                  /* BV_MASK */
+} BVal;
+
+/* Contexte d'évaluation d'un programme sur un instantané */
+typedef struct Batch {
+    const RuleProgram* prog;
+    const int* col[RULE_FIELD_COUNT];
+    CmpKernel cmp;
+    int (*tmp)[64];         /* un tampon par case de pile (masque relu comme nombre) */
+} Batch;
+
+static void batch_setup(Batch* b, const RuleProgram* prog, const StationColumns* c, ScSimd level, int (*tmp)[64]){
+    b->prog=prog;
+    b->col[RULE_POWER]=c->power;
+    b->col[RULE_PRICE]=c->price;
+    b->col[RULE_SLOTS]=c->slots;
+    b->tmp=tmp;
+    ScSimd best=sc_simd_best();
+    if(level>best) level=best;
+    b->cmp=cmp_scalar;
+#ifdef RB_HAVE_X86
+    if(level==SC_SIMD_AVX2) b->cmp=cmp_avx2;
+    else if(level==SC_SIMD_SSE41) b->cmp=cmp_sse41;
+#endif
+}
+
+/* Masque relu comme nombre : 0 / 1 par ligne, dans le tampon de sa case */
+static void as_vec(const Batch* b, BVal* x, int slot, int len){
+    if(x->kind!=BV_MASK) return;
+    int* t=b->tmp[slot];
+    for(int i=0;i<len;i++) t[i]=(int)((x->m>>i)&1);
+    x->kind=BV_VEC;
+    x->v=t;
+}
+
+/* Nombre relu comme booléen : non nul */
+static u64 to_mask(const Batch* b, const BVal* x, int len, u64 full){
+    if(x->kind==BV_MASK) return x->m;
+    if(x->kind==BV_CONST) return x->c ? full : 0;
+    u64 gt, eq;
+    b->cmp(x->v,NULL,0,len,&gt,&eq);
+    return ~eq&full;
+}
+
+/*
+ * Fonction auxiliaire : eval_block
+ * Description : Exécute le programme sur les lignes [row, row + len)
+ *               (len <= 64), une instruction pour tout le bloc
+ * Retour : masque des lignes qui satisfont la règle
+ * Complexité temps : O(len(prog) · 64 / largeur SIMD) - Complexité espace : O(RULE_MAX_DEPTH)
+ */
+static u64 eval_block(const Batch* b, int row, int len){
+    BVal st[RULE_MAX_DEPTH];
+    int sp=0;
+    u64 full= len==64 ? ~0ULL : (1ULL<<len)-1;
+    const RuleProgram* p=b->prog;
+    for(int i=0;i<p->len;i++){
+        const RuleInsn* in=&p->code[i];
+        u64 gt, eq;
+        switch(in->op){
+            case RULE_OP_FIELD:
+                st[sp].kind=BV_VEC; st[sp].v=b->col[in->field]+row; st[sp].c=0; sp++;
+                break;
+            case RULE_OP_CONST:
+                st[sp].kind=BV_CONST; st[sp].c=in->arg; sp++;
+                break;
+            case RULE_OP_GE: case RULE_OP_LE: case RULE_OP_GT: case RULE_OP_LT: case RULE_OP_EQ: {
+                sp--;
+                BVal* x=&st[sp-1], * y=&st[sp];
+                int k=in->op-RULE_OP_GE;
+                if(x->kind==BV_CONST && y->kind==BV_CONST){ x->c=cmp_apply(k,x->c,y->c); break; }
+                as_vec(b,x,sp-1,len);
+                as_vec(b,y,sp,len);
+                if(x->kind==BV_CONST){ b->cmp(y->v,NULL,x->c,len,&gt,&eq); k=CMP_MIRROR[k]; }
+                else b->cmp(x->v,y->kind==BV_CONST ? NULL : y->v,y->c,len,&gt,&eq);
+                x->kind=BV_MASK;
+                x->m=cmp_bits(k,gt,eq,full);
+                break;
+            }
+            case RULE_OP_AND: case RULE_OP_OR: {
+                sp--;
+                u64 l=to_mask(b,&st[sp-1],len,full), r=to_mask(b,&st[sp],len,full);
+                st[sp-1].kind=BV_MASK;
+                st[sp-1].m= in->op==RULE_OP_AND ? l&r : l|r;
+                break;
+            }
+            default:
+                b->cmp(b->col[in->field]+row,NULL,in->arg,len,&gt,&eq);
+                st[sp].kind=BV_MASK;
+                st[sp].m=cmp_bits(in->op-RULE_OP_TEST_GE,gt,eq,full);
+                sp++;
+                break;
+        }
+    }
+    return sp ? to_mask(b,&st[sp-1],len,full)&full : 0;
+}
+
+/*
+ * Fonction : rb_init
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+void rb_init(RuleBitmap* m){
+    memset(m,0,sizeof*m);
+}
+
+/*
+ * Fonction : rb_eval_level
+ * Description : Un mot du bitmap par bloc de 64 lignes
+ * Complexité temps : O(len · n / 64) blocs - Complexité espace : O(n / 64)
+ */
+int rb_eval_level(RuleBitmap* m, const RuleProgram* prog, const StationColumns* c, ScSimd level){
+    int words=(c->n+63)/64;
+    if(words>m->cap){
+        u64* bits=(u64*)realloc(m->bits,sizeof(u64)*(size_t)words);
+        if(!bits) return 0;
+        m->bits=bits;
+        m->cap=words;
+    }
+    m->n=c->n;
+    int tmp[RULE_MAX_DEPTH][64];
+    Batch b;
+    batch_setup(&b,prog,c,level,tmp);
+    for(int w=0;w<words;w++){
+        int row=w*64;
+        m->bits[w]=eval_block(&b,row,c->n-row<64 ? c->n-row : 64);
+    }
+    return 1;
+}
+
+int rb_eval(RuleBitmap* m, const RuleProgram* prog, const StationColumns* c){
+    return rb_eval_level(m,prog,c,SC_SIMD_AVX2);
+}
+
+/*
+ * Fonction : rb_count_rule
+ * Complexité temps : O(len · n / 64) blocs - Complexité espace : O(1)
+ */
+int rb_count_rule(const RuleProgram* prog, const StationColumns* c){
+    int tmp[RULE_MAX_DEPTH][64];
+    Batch b;
+    batch_setup(&b,prog,c,SC_SIMD_AVX2,tmp);
+    int count=0;
+    for(int row=0;row<c->n;row+=64)
+        count+=__builtin_popcountll(eval_block(&b,row,c->n-row<64 ? c->n-row : 64));
+    return count;
+}
+
+/*
+ * Fonction : rb_count
+ * Complexité temps : O(n / 64) - Complexité espace : O(1)
+ */
+int rb_count(const RuleBitmap* m){
+    int count=0;
+    for(int w=0;w<(m->n+63)/64;w++) count+=__builtin_popcountll(m->bits[w]);
+    return count;
+}
+
+/*
+ * Fonction : rb_next
+ * Complexité temps : O(n / 64) au pire - Complexité espace : O(1)
+ */
+int rb_next(const RuleBitmap* m, int from){
+    if(from<0) from=0;
+    if(from>=m->n) return -1;
+    int words=(m->n+63)/64, w=from>>6;
+    u64 word=m->bits[w]&(~0ULL<<(from&63));
+    while(!word){
+        if(++w>=words) return -1;
+        word=m->bits[w];
+    }
+    return w*64+__builtin_ctzll(word);
+}
+
+/*
+ * Fonction : rb_ids
+ * Complexité temps : O(n / 64 + k) - Complexité espace : O(1)
+ */
+int rb_ids(const RuleBitmap* m, const StationColumns* c, int* out, int cap){
+    int count=0;
+    for(int w=0;w<(m->n+63)/64 && count<cap;w++){
+        for(u64 word=m->bits[w]; word && count<cap; word&=word-1)
+            out[count++]=c->id[w*64+__builtin_ctzll(word)];
+    }
+    return count;
+}
+
+/*
+ * Fonction : rb_clear
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+void rb_clear(RuleBitmap* m){
+    free(m->bits);
+    rb_init(m);
+}
@@ -0,0 +1,54 @@
+#ifndef DS_RULE_BATCH_H
+#define DS_RULE_BATCH_H
+#include "rules.h"
+#include "station_columns.h"
+
+/*
+ * ============================================================================
+ * ÉVALUATION DES RÈGLES PAR BLOCS (BITMAPS DE SÉLECTION)
+ * ============================================================================
+ *
+ * Une règle compilée (rule_compile) est exécutée sur l'instantané colonnaire
+ * par blocs de 64 lignes : chaque instruction traite le bloc entier. Un test
+ * "champ op constante" ou une comparaison de deux colonnes est une suite de
+ * comparaisons vectorielles (8 lignes par instruction AVX2, 4 en SSE4.1,
+ * repli scalaire) dont les masques forment un mot de 64 bits ; && et ||
+ * deviennent un ET / OU sur ces mots. Le résultat est un bitmap de sélection,
+ * bit i = ligne i de l'instantané (IDs croissants).
+ */
+
+/* Bitmap de sélection des lignes d'un instantané */
+typedef struct RuleBitmap {
+    int n;                      /* nombre de lignes */
+    int cap;                    /* mots alloués */
+    unsigned long long* bits;   /* bit i % 64 de bits[i / 64] : ligne i retenue */
+} RuleBitmap;
+
+/* Initialisation d'un bitmap vide - O(1) */
+void rb_init(RuleBitmap* m);
+
+/* Évaluation de la règle sur toutes les lignes de c (bitmap redimensionné à
+ * c->n lignes) avec le meilleur noyau disponible - O(len · n / 64) blocs.
+ * Retour : 1 si réussi, 0 si échec d'allocation (bitmap inchangé) */
+int rb_eval(RuleBitmap* m, const RuleProgram* prog, const StationColumns* c);
+
+/* Idem avec un noyau imposé (ramené au meilleur disponible) */
+int rb_eval_level(RuleBitmap* m, const RuleProgram* prog, const StationColumns* c, ScSimd level);
+
+/* Nombre de lignes de c qui satisfont la règle, sans bitmap - O(len · n / 64) */
+int rb_count_rule(const RuleProgram* prog, const StationColumns* c);
+
+/* Nombre de lignes retenues (popcount) - O(n / 64) */
+int rb_count(const RuleBitmap* m);
+
+/* Première ligne retenue à partir de from, -1 s'il n'y en a plus - O(n / 64)
+ * au pire. Parcours : for(i=rb_next(m,0); i>=0; i=rb_next(m,i+1)) */
+int rb_next(const RuleBitmap* m, int from);
+
+/* IDs des lignes retenues (au plus cap), croissants - O(n / 64 + k) */
+int rb_ids(const RuleBitmap* m, const StationColumns* c, int* out, int cap);
+
+/* Libération du bitmap - O(1) */
+void rb_clear(RuleBitmap* m);
+
+#endif
@@ -0,0 +1,275 @@
+#include "rule_opt.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+static const char* const CMP_TOK[]={ ">=", "<=", ">", "<", "==" };
+static const int CMP_MIRROR[]={ 1, 0, 3, 2, 4 };
+static const char* const FIELD_NAME[RULE_FIELD_COUNT]={ "power", "price", "slots" };
+
+static int cmp_apply(int k, int a, int b){
+    switch(k){
+        case 0: return a>=b;
+        case 1: return a<=b;
+        case 2: return a>b;
+        case 3: return a<b;
+        default: return a==b;
+    }
+}
+
+/* Nœud binaire de la première passe (r = -1 : booléen d'un seul enfant) */
+typedef struct BNode {
+    int kind, op, field, arg;
+    int l, r;
+} BNode;
+
+/* Contexte de construction */
+typedef struct RoBuild {
+    RuleOpt* o;
+    BNode b[RULE_MAX_CODE];
+    int nb;
+    int tmp[RO_MAX_NODES];  /* clauses d'une liste en cours d'aplatissement */
+} RoBuild;
+
+static int b_new(RoBuild* c, int kind, int op, int field, int arg, int l, int r){
+    BNode* x=&c->b[c->nb];
+    x->kind=kind; x->op=op; x->field=field; x->arg=arg; x->l=l; x->r=r;
+    return c->nb++;
+}
+
+/* Valeur de vérité d'une constante, -1 si ce n'en est pas une */
+static int b_truth(const RoBuild* c, int i){
+    return c->b[i].kind==RO_CONST ? c->b[i].arg!=0 : -1;
+}
+
+/* Nœud vu comme booléen : un champ seul vaut sa valeur, il est enveloppé
+ * pour valoir 0 / 1 s'il remplace un && ou un || */
+static int b_bool(RoBuild* c, int i){
+    return c->b[i].kind==RO_FIELD ? b_new(c,RO_AND,0,0,0,i,-1) : i;
+}
+
+/*
+ * Fonction auxiliaire : b_logic
+ * Description : x && y ou x || y, repli des opérandes constants
+ */
+static int b_logic(RoBuild* c, int kind, int x, int y){
+    int tx=b_truth(c,x), ty=b_truth(c,y);
+    int absorb= kind==RO_AND ? 0 : 1;       /* constante qui fixe le résultat */
+    if(tx==absorb || ty==absorb) return b_new(c,RO_CONST,0,0,absorb,-1,-1);
+    if(tx>=0 && ty>=0) return b_new(c,RO_CONST,0,0,!absorb,-1,-1);
+    if(tx>=0) return b_bool(c,y);
+    if(ty>=0) return b_bool(c,x);
+    return b_new(c,kind,0,0,0,x,y);
+}
+
+/* Clauses d'une liste && (ou ||) : opérandes des nœuds de même nature */
+static void collect(RoBuild* c, int i, int kind, int* cnt){
+    const BNode* x=&c->b[i];
+    if(x->kind==kind){
+        collect(c,x->l,kind,cnt);
+        if(x->r>=0) collect(c,x->r,kind,cnt);
+    } else c->tmp[(*cnt)++]=i;
+}
+
+/*
+ * Fonction auxiliaire récursive : emit
+ * Description : Nœud définitif d'un nœud binaire ; listes && / || aplaties,
+ *               enfants contigus dans kids
+ * Retour : indice du nœud
+ */
+static int emit(RoBuild* c, int i){
+    RuleOpt* o=c->o;
+    const BNode* x=&c->b[i];
+    int id=o->n++;
+    RoNode* d=&o->node[id];
+    memset(d,0,sizeof*d);
+    d->kind=(unsigned char)x->kind;
+    d->op=(unsigned char)x->op;
+    d->field=(unsigned char)x->field;
+    d->arg=x->arg;
+    d->cost= x->kind==RO_CONST ? 0 : 1;
+    if(x->kind==RO_CMP){
+        d->first=o->nkids; d->count=2;
+        o->nkids+=2;
+        o->kids[d->first]=x->l;
+        o->kids[d->first+1]=x->r;
+    } else if(x->kind==RO_AND || x->kind==RO_OR){
+        int cnt=0;
+        collect(c,i,x->kind,&cnt);
+        d->first=o->nkids; d->count=cnt;
+        o->nkids+=cnt;
+        memcpy(&o->kids[d->first],c->tmp,sizeof(int)*(size_t)cnt);
+        d->cost=0;
+    } else return id;
+    /* Les cases réservées portent l'indice binaire jusqu'à leur émission */
+    int first=d->first, count=d->count, cost=d->cost;
+    for(int k=0;k<count;k++){
+        int kid=emit(c,o->kids[first+k]);
+        o->kids[first+k]=kid;
+        cost+=o->node[kid].cost;
+    }
+    o->node[id].cost=cost;
+    return id;
+}
+
+/*
+ * Fonction : ro_build
+ * Description : Première passe postfix → arbre binaire replié, seconde
+ *               passe d'aplatissement, puis classement initial par coût
+ * Complexité temps : O(len log len) - Complexité espace : O(len)
+ */
+void ro_build(RuleOpt* o, const RuleProgram* prog){
+    static const RoBuild zero;
+    RoBuild c=zero;
+    c.o=o;
+    o->n=0; o->nkids=0; o->since=0;
+    int st[RULE_MAX_DEPTH], sp=0;
+    for(int i=0;i<prog->len;i++){
+        const RuleInsn* in=&prog->code[i];
+        int op=in->op;
+        if(op==RULE_OP_FIELD){ st[sp++]=b_new(&c,RO_FIELD,0,in->field,0,-1,-1); continue; }
+        if(op==RULE_OP_CONST){ st[sp++]=b_new(&c,RO_CONST,0,0,in->arg,-1,-1); continue; }
+        if(op>=RULE_OP_TEST_GE){ st[sp++]=b_new(&c,RO_TEST,op-RULE_OP_TEST_GE,in->field,in->arg,-1,-1); continue; }
+        int y=st[--sp], x=st[--sp];
+        if(op==RULE_OP_AND || op==RULE_OP_OR){ st[sp++]=b_logic(&c,op==RULE_OP_AND ? RO_AND : RO_OR,x,y); continue; }
+        int k=op-RULE_OP_GE;
+        const BNode* bx=&c.b[x], * by=&c.b[y];
+        if(bx->kind==RO_CONST && by->kind==RO_CONST) st[sp++]=b_new(&c,RO_CONST,0,0,cmp_apply(k,bx->arg,by->arg),-1,-1);
+        else if(bx->kind==RO_FIELD && by->kind==RO_CONST) st[sp++]=b_new(&c,RO_TEST,k,bx->field,by->arg,-1,-1);
+        else if(bx->kind==RO_CONST && by->kind==RO_FIELD) st[sp++]=b_new(&c,RO_TEST,CMP_MIRROR[k],by->field,bx->arg,-1,-1);
+        else st[sp++]=b_new(&c,RO_CMP,k,0,0,x,y);
+    }
+    /* Règle vide : fausse */
+    o->root= sp ? emit(&c,st[sp-1]) : emit(&c,b_new(&c,RO_CONST,0,0,0,-1,-1));
+    ro_reorder(o);
+}
+
+static int ro_bool(RuleOpt* o, int i, const int* fv);
+
+static int ro_val(RuleOpt* o, int i, const int* fv){
+    const RoNode* x=&o->node[i];
+    if(x->kind==RO_FIELD) return fv[x->field];
+    if(x->kind==RO_CONST) return x->arg;
+    return ro_bool(o,i,fv);
+}
+
+/*
+ * Fonction auxiliaire récursive : ro_bool
+ * Description : Valeur de vérité d'un nœud ; une liste s'arrête à la
+ *               première clause qui fixe le résultat, chaque clause évaluée
+ *               est comptée
+ */
+static int ro_bool(RuleOpt* o, int i, const int* fv){
+    RoNode* x=&o->node[i];
+    switch(x->kind){
+        case RO_TEST: return cmp_apply(x->op,fv[x->field],x->arg);
+        case RO_FIELD: return fv[x->field]!=0;
+        case RO_CONST: return x->arg!=0;
+        case RO_CMP: return cmp_apply(x->op,ro_val(o,o->kids[x->first],fv),ro_val(o,o->kids[x->first+1],fv));
+        default: {
+            int stop= x->kind==RO_OR;
+            for(int k=0;k<x->count;k++){
+                RoNode* c=&o->node[o->kids[x->first+k]];
+                int r= c->kind==RO_TEST ? cmp_apply(c->op,fv[c->field],c->arg) : ro_bool(o,o->kids[x->first+k],fv);
+                c->evals++;
+                c->hits+=r;
+                if(r==stop) return stop;
+            }
+            return !stop;
+        }
+    }
+}
+
+/*
+ * Fonction : ro_eval
+ * Complexité temps : O(tests évalués), O(len log len) au reclassement
+ * Complexité espace : O(profondeur de l'arbre)
+ */
+int ro_eval(RuleOpt* o, const StationInfo* info){
+    const int fv[RULE_FIELD_COUNT]={ info->power_kW, info->price_cents, info->slots_free };
+    if(++o->since>=RO_REORDER_EVERY){ ro_reorder(o); o->since=0; }
+    return ro_bool(o,o->root,fv);
+}
+
+/* a doit passer avant b : rapport coût / probabilité d'arrêt plus faible
+ * (coût(a) · arrêt(b) < coût(b) · arrêt(a)) ; probabilités lissées
+ * (compte + 1) / (evals + 2), 1/2 pour une clause jamais évaluée */
+static int ranks_before(const RoNode* a, const RoNode* b, int is_or){
+    double sa=(double)(is_or ? a->hits : a->evals-a->hits)+1.0;
+    double sb=(double)(is_or ? b->hits : b->evals-b->hits)+1.0;
+    sa/=(double)a->evals+2.0;
+    sb/=(double)b->evals+2.0;
+    double ca=a->cost>0 ? a->cost : 1, cb=b->cost>0 ? b->cost : 1;
+    return ca*sb<cb*sa;
+}
+
+/*
+ * Fonction : ro_reorder
+ * Description : Tri par insertion (stable) des clauses de chaque liste,
+ *               puis compteurs divisés par deux
+ * Complexité temps : O(len²) au pire, listes courtes en pratique
+ * Complexité espace : O(1)
+ */
+void ro_reorder(RuleOpt* o){
+    for(int i=0;i<o->n;i++){
+        const RoNode* x=&o->node[i];
+        if(x->kind!=RO_AND && x->kind!=RO_OR) continue;
+        int* k=&o->kids[x->first];
+        for(int a=1;a<x->count;a++){
+            int v=k[a], b=a;
+            while(b>0 && ranks_before(&o->node[v],&o->node[k[b-1]],x->kind==RO_OR)){ k[b]=k[b-1]; b--; }
+            k[b]=v;
+        }
+    }
+    for(int i=0;i<o->n;i++){ o->node[i].evals/=2; o->node[i].hits/=2; }
+}
+
+/* Écriture bornée dans buf à partir de *len */
+static void put(char* buf, int cap, int* len, const char* fmt, ...){
+    if(*len>=cap-1) return;
+    va_list ap;
+    va_start(ap,fmt);
+    int w=vsnprintf(buf+*len,(size_t)(cap-*len),fmt,ap);
+    va_end(ap);
+    if(w>0) *len+= w<cap-*len ? w : cap-1-*len;
+}
+
+static void explain_node(const RuleOpt* o, int i, char* buf, int cap, int* len){
+    const RoNode* x=&o->node[i];
+    switch(x->kind){
+        case RO_CONST: put(buf,cap,len,"%d",x->arg); break;
+        case RO_FIELD: put(buf,cap,len,"%s",FIELD_NAME[x->field]); break;
+        case RO_TEST:
+            put(buf,cap,len,"%s",FIELD_NAME[x->field]);
+            put(buf,cap,len," %s %d",CMP_TOK[x->op],x->arg);
+            break;
+        case RO_CMP:
+            put(buf,cap,len,"(");
+            explain_node(o,o->kids[x->first],buf,cap,len);
+            put(buf,cap,len," %s ",CMP_TOK[x->op]);
+            explain_node(o,o->kids[x->first+1],buf,cap,len);
+            put(buf,cap,len,")");
+            break;
+        default:
+            put(buf,cap,len,"(");
+            for(int k=0;k<x->count;k++){
+                const RoNode* c=&o->node[o->kids[x->first+k]];
+                if(k) put(buf,cap,len," %s ",x->kind==RO_AND ? "&&" : "||");
+                explain_node(o,o->kids[x->first+k],buf,cap,len);
+                if(c->evals) put(buf,cap,len," [%d%%]",(int)(c->hits*100/c->evals));
+            }
+            put(buf,cap,len,")");
+    }
+}
+
+/*
+ * Fonction : ro_explain
+ * Complexité temps : O(len) - Complexité espace : O(profondeur)
+ */
+int ro_explain(const RuleOpt* o, char* buf, int cap){
+    if(!buf || cap<=0) return 0;
+    int len=0;
+    buf[0]='\0';
+    explain_node(o,o->root,buf,cap,&len);
+    return len;
+}
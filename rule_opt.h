@@ -0,0 +1,78 @@
+#ifndef DS_RULE_OPT_H
+#define DS_RULE_OPT_H
+#include "rules.h"
+
+/*
+ * ============================================================================
+ * OPTIMISEUR DE RÈGLES : ARBRE, REPLI DES CONSTANTES, COURT-CIRCUIT
+ * ============================================================================
+ *
+ * Une règle compilée (rule_compile) devient un arbre d'expression : les
+ * constantes sont repliées (1 2 < devient 1, x 0 && devient 0, x 1 && devient
+ * x), les && et || imbriqués sont aplatis en listes de clauses. L'évaluation
+ * s'arrête à la première clause fausse d'un && (vraie d'un ||).
+ * Chaque clause compte ses évaluations et ses résultats vrais ; toutes les
+ * RO_REORDER_EVERY évaluations, les clauses de chaque liste sont reclassées
+ * par coût / probabilité d'arrêt croissant (coût = nombre de tests du
+ * sous-arbre ; probabilité d'arrêt = taux d'échec pour &&, de succès pour ||,
+ * lissés), puis les compteurs sont divisés par deux pour suivre l'évolution
+ * des données. Le résultat ne dépend pas de l'ordre des clauses.
+ * Les compteurs sont modifiés à chaque évaluation : un optimiseur ne sert
+ * qu'un thread à la fois.
+ */
+
+/* Nombre maximal de nœuds de l'arbre */
+#define RO_MAX_NODES RULE_MAX_CODE
+
+/* Évaluations entre deux reclassements automatiques */
+#define RO_REORDER_EVERY 4096
+
+/* Nature d'un nœud */
+typedef enum RoKind {
+    RO_CONST = 0,           /* constante arg */
+    RO_FIELD = 1,           /* champ field */
+    RO_TEST = 2,            /* champ field op constante arg */
+    RO_CMP = 3,             /* enfant 0 op enfant 1 (valeurs quelconques) */
+    RO_AND = 4,             /* toutes les clauses vraies */
+    RO_OR = 5               /* une clause vraie */
+} RoKind;
+
+/* Nœud de l'arbre */
+typedef struct RoNode {
+    unsigned char kind;     /* RoKind */
+    unsigned char op;       /* comparaison : 0..4 pour >=, <=, >, <, == */
+    unsigned char field;    /* RuleField */
+    int arg;                /* constante */
+    int first, count;       /* enfants : kids[first .. first + count) */
+    int cost;               /* nombre de tests du sous-arbre */
+    long long evals, hits;  /* clause : évaluations et résultats vrais */
+} RoNode;
+
+/* Règle optimisée */
+typedef struct RuleOpt {
+    int n;                      /* nœuds utilisés */
+    int root;                   /* racine */
+    int nkids;                  /* cases de kids utilisées */
+    long long since;            /* évaluations depuis le dernier reclassement */
+    RoNode node[RO_MAX_NODES];
+    int kids[RO_MAX_NODES];
+} RuleOpt;
+
+/* Construction depuis une règle compilée (arbre, repli des constantes,
+ * aplatissement, clauses classées par coût) - O(len log len) */
+void ro_build(RuleOpt* o, const RuleProgram* prog);
+
+/* Évaluation en court-circuit, comptage des clauses, reclassement toutes
+ * les RO_REORDER_EVERY évaluations - O(tests évalués).
+ * Retour : 1 si la station satisfait la règle, 0 sinon (comme rule_eval) */
+int ro_eval(RuleOpt* o, const StationInfo* info);
+
+/* Reclassement immédiat des clauses selon les compteurs - O(len log len) */
+void ro_reorder(RuleOpt* o);
+
+/* Forme infixe de l'arbre, clauses dans l'ordre courant avec leur taux de
+ * succès observé, dans buf (tronquée à cap octets) - O(len).
+ * Retour : longueur écrite */
+int ro_explain(const RuleOpt* o, char* buf, int cap);
+
+#endif
@@ -0,0 +1,351 @@
+#include "rule_plan.h"
+#include "rules.h"
+#include "rule_opt.h"
+#include "advanced_queries.h"
+#include "bptree.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <limits.h>
+#include <stddef.h>
+
+/* Coût d'un candidat de l'index secondaire, en stations lues par le curseur
+ * (recherche de la station par ID, tas des N plus petits IDs) */
+#define RULE_INDEX_COST 4
+
+/* Valeur de la pile d'analyse : un champ, un nombre, ou un booléen décrit
+ * par la boîte des stations pour lesquelles il peut être vrai */
+enum { ABS_BOX = 0, ABS_FIELD = 1, ABS_NUM = 2 };
+typedef struct AbsVal {
+    int kind;
+    int field;                  /* ABS_FIELD : RuleField */
+    int num;                    /* ABS_NUM : valeur */
+    int lo[RULE_FIELD_COUNT], hi[RULE_FIELD_COUNT]; /* ABS_BOX */
+} AbsVal;
+
+static void box_all(int* lo, int* hi){
+    for(int f=0;f<RULE_FIELD_COUNT;f++){ lo[f]=INT_MIN; hi[f]=INT_MAX; }
+}
+
+static void box_none(int* lo, int* hi){
+    for(int f=0;f<RULE_FIELD_COUNT;f++){ lo[f]=INT_MAX; hi[f]=INT_MIN; }
+}
+
+static int box_empty(const int* lo, const int* hi){
+    for(int f=0;f<RULE_FIELD_COUNT;f++) if(lo[f]>hi[f]) return 1;
+    return 0;
+}
+
+/* Valeur vue comme booléen (un nombre est vrai s'il est non nul) */
+static void as_bool(AbsVal* v){
+    if(v->kind==ABS_NUM && v->num==0) box_none(v->lo,v->hi);
+    else if(v->kind!=ABS_BOX) box_all(v->lo,v->hi);
+    v->kind=ABS_BOX;
+}
+
+/* Comparaisons de RuleOp (>=, <=, >, <, ==) et leur miroir */
+static const int CMP_MIRROR[]={ 1, 0, 3, 2, 4 };
+
+static int cmp_apply(int op, int a, int b){
+    switch(op){
+        case 0: return a>=b;
+        case 1: return a<=b;
+        case 2: return a>b;
+        case 3: return a<b;
+        default: return a==b;
+    }
+}
+
+/* Boîte du test (champ f op c) */
+static void box_test(AbsVal* a, int f, int op, int c){
+    a->kind=ABS_BOX;
+    box_all(a->lo,a->hi);
+    switch(op){
+        case 0: a->lo[f]=c; break;
+        case 1: a->hi[f]=c; break;
+        case 2: if(c==INT_MAX) box_none(a->lo,a->hi); else a->lo[f]=c+1; break;
+        case 3: if(c==INT_MIN) box_none(a->lo,a->hi); else a->hi[f]=c-1; break;
+        default: a->lo[f]=a->hi[f]=c; break;
+    }
+}
+
+/*
+ * Fonction auxiliaire : abs_compare
+ * Description : a <- (a op b). Champ comparé à une constante : intervalle
+ *               du champ ; deux constantes : constante ; sinon non contraint
+ */
+static void abs_compare(AbsVal* a, const AbsVal* b, int op){
+    if(a->kind==ABS_NUM && b->kind==ABS_NUM) a->num=cmp_apply(op,a->num,b->num);
+    else if(a->kind==ABS_FIELD && b->kind==ABS_NUM) box_test(a,a->field,op,b->num);
+    else if(a->kind==ABS_NUM && b->kind==ABS_FIELD) box_test(a,b->field,CMP_MIRROR[op],a->num);
+    else { a->kind=ABS_BOX; box_all(a->lo,a->hi); }
+}
+
+/* a <- a && b (intersection) ou a || b (enveloppe) */
+static void abs_logic(AbsVal* a, AbsVal* b, int is_or){
+    as_bool(a);
+    as_bool(b);
+    if(is_or){
+        if(box_empty(b->lo,b->hi)) return;
+        if(box_empty(a->lo,a->hi)){ *a=*b; return; }
+    }
+    for(int f=0;f<RULE_FIELD_COUNT;f++){
+        if(is_or ? b->lo[f]<a->lo[f] : b->lo[f]>a->lo[f]) a->lo[f]=b->lo[f];
+        if(is_or ? b->hi[f]>a->hi[f] : b->hi[f]<a->hi[f]) a->hi[f]=b->hi[f];
+    }
+}
+
+/*
+ * Fonction auxiliaire : rule_bounds
+ * Description : Évaluation abstraite de la règle compilée : intervalle
+ *               nécessaire de chaque champ
+ * Complexité temps : O(len) - Complexité espace : O(RULE_MAX_DEPTH)
+ */
+static void rule_bounds(const RuleProgram* prog, int* lo, int* hi){
+    AbsVal st[RULE_MAX_DEPTH];
+    int top=0;
+    for(int i=0;i<prog->len;i++){
+        const RuleInsn* c=&prog->code[i];
+        if(c->op>=RULE_OP_GE && c->op<=RULE_OP_OR){
+            top--;
+            if(c->op<=RULE_OP_EQ) abs_compare(&st[top-1],&st[top],c->op-RULE_OP_GE);
+            else abs_logic(&st[top-1],&st[top],c->op==RULE_OP_OR);
+            continue;
+        }
+        AbsVal* v=&st[top++];
+        if(c->op==RULE_OP_FIELD){ v->kind=ABS_FIELD; v->field=c->field; }
+        else if(c->op==RULE_OP_CONST){ v->kind=ABS_NUM; v->num=c->arg; }
+        else box_test(v,c->field,c->op-RULE_OP_TEST_GE,c->arg);
+    }
+    if(top==0){ box_none(lo,hi); return; }
+    as_bool(&st[top-1]);
+    memcpy(lo,st[top-1].lo,sizeof st[top-1].lo);
+    memcpy(hi,st[top-1].hi,sizeof st[top-1].hi);
+}
+
+/*
+ * Fonction : rule_plan
+ * Description : Bornes de la règle, puis coût de chaque chemin : le curseur
+ *               lit environ limit / densité stations (densité = effectif de
+ *               l'intervalle indexé le plus étroit / total), l'index
+ *               secondaire lit tout son intervalle
+ * Complexité temps : O(n + log m) - Complexité espace : O(1)
+ */
+void rule_plan(const StationIndex* idx, char* toks[], int n, int lo, int hi, int limit, RulePlan* p){
+    memset(p,0,offsetof(RulePlan,prog));
+    p->compiled=rule_compile(toks,n,&p->prog);
+    if(p->compiled) rule_bounds(&p->prog,p->lo,p->hi);
+    else box_all(p->lo,p->hi);
+    p->id_lo=lo; p->id_hi=hi; p->limit=limit;
+    p->candidates=-1;
+    p->access=RULE_ACCESS_EMPTY;
+    if(limit<=0 || lo>hi || box_empty(p->lo,p->hi)) return;
+
+    int avl=idx->backend==SI_BACKEND_AVL;
+    long long total=avl ? (idx->root ? idx->root->size : 0) : (idx->bp ? idx->bp->count : 0);
+    p->rows=avl ? si_count_range(idx->root,lo,hi) : total;
+    if(p->rows==0) return;
+    p->access=RULE_ACCESS_ID;
+    p->pruned=avl && (p->lo[RULE_POWER]>INT_MIN || p->lo[RULE_SLOTS]>INT_MIN || p->hi[RULE_PRICE]<INT_MAX);
+    p->est_reads=p->rows;
+    if(!idx->attr) return;
+
+    int best=-1;
+    long long c_best=0;
+    for(int a=0;a<SI_ATTR_COUNT;a++){
+        if(p->lo[a]==INT_MIN && p->hi[a]==INT_MAX) continue;
+        long long c=si_attr_count(idx,(SiAttr)a,p->lo[a],p->hi[a]);
+        if(best<0 || c<c_best){ best=a; c_best=c; }
+    }
+    if(best<0) return;
+    if(c_best==0){ p->access=RULE_ACCESS_EMPTY; p->est_reads=0; return; }
+    long long scan=((long long)limit*total+c_best-1)/c_best;
+    if(scan<p->est_reads) p->est_reads=scan;
+    if(c_best*RULE_INDEX_COST<p->est_reads){
+        p->access=best==SI_ATTR_POWER ? RULE_ACCESS_POWER : RULE_ACCESS_PRICE;
+        p->candidates=c_best;
+        p->est_reads=c_best;
+        p->pruned=0;
+    }
+}
+
+/* État d'une exécution */
+typedef struct PlanRun {
+    const RulePlan* p;
+    char** toks;
+    int n;
+    int* out;
+    int count;
+    RuleOpt* opt;           /* règle compilée, clauses reclassées au fil des lectures */
+} PlanRun;
+
+/* Station dans la boîte du plan (test exact avant la règle complète) */
+static int in_box(const RulePlan* p, const StationInfo* in){
+    return in->power_kW>=p->lo[RULE_POWER] && in->power_kW<=p->hi[RULE_POWER]
+        && in->price_cents>=p->lo[RULE_PRICE] && in->price_cents<=p->hi[RULE_PRICE]
+        && in->slots_free>=p->lo[RULE_SLOTS] && in->slots_free<=p->hi[RULE_SLOTS];
+}
+
+static int qualifies(PlanRun* r, StationNode* s){
+    if(!in_box(r->p,&s->info)) return 0;
+    return r->opt ? ro_eval(r->opt,&s->info) : eval_rule_postfix(r->toks,r->n,&s->info);
+}
+
+/*
+ * Fonction auxiliaire : walk
+ * Description : Parcours infixe de l'AVL restreint à [id_lo, id_hi], arrêté
+ *               au limit-ième résultat ; un sous-arbre dont les agrégats
+ *               excluent la boîte est sauté (max_power, max_slots, min_price)
+ * Complexité temps : O(log m + v) - Complexité espace : O(log m) (récursion)
+ */
+static void walk(PlanRun* r, StationNode* t){
+    const RulePlan* p=r->p;
+    while(t && r->count<p->limit){
+        if(t->max_power<p->lo[RULE_POWER] || t->max_slots<p->lo[RULE_SLOTS]
+           || t->min_price>p->hi[RULE_PRICE]) return;
+        if(t->station_id<p->id_lo){ t=t->right; continue; }
+        if(t->station_id>p->id_hi){ t=t->left; continue; }
+        walk(r,t->left);
+        if(r->count>=p->limit) return;
+        if(qualifies(r,t)) r->out[r->count++]=t->station_id;
+        t=t->right;
+    }
+}
+
+/* Tas max d'IDs : descente de h[i] */
+static void heap_down(int* h, int n, int i){
+    for(;;){
+        int l=2*i+1, m=i;
+        if(l<n && h[l]>h[m]) m=l;
+        if(l+1<n && h[l+1]>h[m]) m=l+1;
+        if(m==i) return;
+        int t=h[i]; h[i]=h[m]; h[m]=t;
+        i=m;
+    }
+}
+
+/*
+ * Fonction auxiliaire : run_index
+ * Description : Candidats de l'intervalle indexé, dont on garde les limit
+ *               plus petits IDs qualifiés (tas max dans out), puis tri
+ * Retour : nombre d'IDs écrits, -1 si échec d'allocation
+ * Complexité temps : O(c·n + c log N) - Complexité espace : O(c)
+ */
+static int run_index(const StationIndex* idx, PlanRun* r){
+    const RulePlan* p=r->p;
+    SiAttr a=p->access==RULE_ACCESS_POWER ? SI_ATTR_POWER : SI_ATTR_PRICE;
+    int c=si_attr_count(idx,a,p->lo[a],p->hi[a]);
+    if(c<=0) return 0;
+    int* cand=(int*)malloc(sizeof(int)*(size_t)c);
+    if(!cand) return -1;
+    c=si_attr_range_ids(idx,a,p->lo[a],p->hi[a],cand,c);
+    if(c<0){ free(cand); return -1; }
+
+    int* h=r->out, m=0;
+    for(int i=0;i<c;i++){
+        int id=cand[i];
+        if(id<p->id_lo || id>p->id_hi || (m==p->limit && id>=h[0])) continue;
+        StationNode* s=si_find_idx(idx,id);
+        if(!s || !qualifies(r,s)) continue;
+        if(m<p->limit){
+            int j=m++;
+            while(j>0 && h[(j-1)/2]<id){ h[j]=h[(j-1)/2]; j=(j-1)/2; }
+            h[j]=id;
+        } else {
+            h[0]=id;
+            heap_down(h,m,0);
+        }
+    }
+    free(cand);
+    for(int k=m-1;k>0;k--){
+        int t=h[0]; h[0]=h[k]; h[k]=t;
+        heap_down(h,k,0);
+    }
+    return m;
+}
+
+/*
+ * Fonction : rule_run_opt
+ * Description : Exécution du plan ; l'index secondaire retombe sur le
+ *               curseur si la mémoire manque
+ * Complexité temps : voir rule_plan.h - Complexité espace : O(log m) ou O(c)
+ */
+int rule_run_opt(const StationIndex* idx, const RulePlan* p, RuleOpt* opt,
+                 char* toks[], int n, int* out){
+    if(!out || p->access==RULE_ACCESS_EMPTY || p->limit<=0) return 0;
+    RuleOpt local;
+    PlanRun r={ p, toks, n, out, 0, NULL };
+    if(p->compiled){
+        if(!opt){ ro_build(&local,&p->prog); opt=&local; }
+        r.opt=opt;
+    }
+    if(p->access!=RULE_ACCESS_ID){
+        int m=run_index(idx,&r);
+        if(m>=0) return m;
+    }
+    if(idx->backend==SI_BACKEND_AVL){
+        walk(&r,idx->root);
+        return r.count;
+    }
+    SiIter it;
+    si_iter_seek(&it,idx,p->id_lo,p->id_hi);
+    StationNode* s;
+    while(r.count<p->limit && (s=si_iter_next(&it)))
+        if(qualifies(&r,s)) out[r.count++]=s->station_id;
+    return r.count;
+}
+
+int rule_run(const StationIndex* idx, const RulePlan* p, char* toks[], int n, int* out){
+    return rule_run_opt(idx,p,NULL,toks,n,out);
+}
+
+/* Intervalle lisible : "[50, +inf)", "(-inf, 250]", "[1, 4]" */
+static int fmt_range(char* b, size_t cap, int lo, int hi){
+    char l[16], h[16];
+    if(lo==INT_MIN) snprintf(l,sizeof l,"(-inf"); else snprintf(l,sizeof l,"[%d",lo);
+    if(hi==INT_MAX) snprintf(h,sizeof h,"+inf)"); else snprintf(h,sizeof h,"%d]",hi);
+    return snprintf(b,cap,"%s, %s",l,h);
+}
+
+/*
+ * Fonction : rule_explain
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+int rule_explain(const RulePlan* p, char* buf, int cap){
+    static const char* const NAMES[RULE_FIELD_COUNT]={ "power", "price", "slots" };
+    char s[320], r[48];
+    int len=0;
+    /* len reste dans s même après une écriture tronquée */
+    #define PUT(...) do{ len+=snprintf(s+len,sizeof s-(size_t)len,__VA_ARGS__); \
+                         if(len>(int)sizeof s-1) len=(int)sizeof s-1; }while(0)
+
+    int full=p->id_lo==INT_MIN && p->id_hi==INT_MAX;
+    fmt_range(r,sizeof r,p->id_lo,p->id_hi);
+    switch(p->access){
+        case RULE_ACCESS_EMPTY:
+            PUT("empty: no station can match");
+            break;
+        case RULE_ACCESS_ID:
+            PUT("id scan%s%s over %lld stations%s, stop after %d matches (est. %lld reads)",
+                full ? "" : " ",full ? "" : r,p->rows,p->pruned ? " pruned by subtree aggregates" : "",p->limit,p->est_reads);
+            break;
+        default: {
+            int a=p->access==RULE_ACCESS_POWER ? RULE_POWER : RULE_PRICE;
+            char k[48];
+            fmt_range(k,sizeof k,p->lo[a],p->hi[a]);
+            PUT("%s index scan %s: %lld candidates, keep the %d smallest ids%s%s",
+                NAMES[a],k,p->candidates,p->limit,full ? "" : " in ",full ? "" : r);
+        }
+    }
+    int any=0;
+    for(int f=0;f<RULE_FIELD_COUNT;f++){
+        if(p->lo[f]==INT_MIN && p->hi[f]==INT_MAX) continue;
+        if(p->lo[f]>p->hi[f]){ PUT("%s%s empty",any ? ", " : "; bounds: ",NAMES[f]); any=1; continue; }
+        fmt_range(r,sizeof r,p->lo[f],p->hi[f]);
+        PUT("%s%s %s",any ? ", " : "; bounds: ",NAMES[f],r);
+        any=1;
+    }
+    #undef PUT
+    if(buf && cap>0) snprintf(buf,(size_t)cap,"%s",s);
+    return len;
+}
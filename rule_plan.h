@@ -0,0 +1,78 @@
+#ifndef DS_RULE_PLAN_H
+#define DS_RULE_PLAN_H
+#include "rules.h"
+
+/*
+ * ============================================================================
+ * PLANIFICATION DES RÈGLES POSTFIX (POUSSÉE DES PRÉDICATS)
+ * ============================================================================
+ *
+ * Une évaluation abstraite de la règle en déduit, champ par champ, un
+ * intervalle hors duquel aucune station ne peut la satisfaire : une
+ * comparaison champ / constante donne un intervalle, && les intersecte,
+ * || prend leur enveloppe, tout le reste (comparaison entre champs,
+ * booléen comparé à un nombre, règle mal formée) ne contraint rien.
+ * Le plan choisit ensuite le chemin d'accès le moins coûteux :
+ *   - parcours par ID de la plage demandée, arrêté au N-ième résultat ;
+ *     avec l'AVL, les sous-arbres dont les agrégats (max_power, max_slots,
+ *     min_price) sortent des intervalles sont sautés en entier ;
+ *   - parcours de l'index secondaire de la puissance ou du prix (voir
+ *     si_enable_attr_index) restreint à son intervalle, dont on garde les N
+ *     plus petits IDs ;
+ *   - rien, si un intervalle est vide.
+ * Les effectifs exacts des index secondaires servent d'estimation de
+ * sélectivité. La règle complète est toujours réévaluée sur chaque station
+ * lue (rule_opt : clauses en court-circuit, reclassées selon leur
+ * sélectivité observée) : le résultat ne dépend pas du plan (les N premiers
+ * IDs qualifiés).
+ */
+
+/* Chemin d'accès retenu */
+typedef enum RuleAccess {
+    RULE_ACCESS_EMPTY = 0,  /* aucun résultat possible */
+    RULE_ACCESS_ID = 1,     /* curseur par ID croissant, arrêt au N-ième */
+    RULE_ACCESS_POWER = 2,  /* index secondaire (power_kW, ID) */
+    RULE_ACCESS_PRICE = 3   /* index secondaire (price_cents, ID) */
+} RuleAccess;
+
+/* Plan d'exécution d'une règle */
+typedef struct RulePlan {
+    RuleAccess access;          /* chemin d'accès */
+    int lo[RULE_FIELD_COUNT];   /* intervalle nécessaire de chaque champ ... */
+    int hi[RULE_FIELD_COUNT];   /* ... (INT_MIN / INT_MAX : non borné) */
+    int id_lo, id_hi;           /* plage d'IDs demandée */
+    int limit;                  /* nombre maximal de résultats */
+    int pruned;                 /* parcours par ID élagué par les agrégats AVL */
+    long long rows;             /* stations de la plage (estimation avec le B+) */
+    long long candidates;       /* couples de l'index parcouru (-1 : sans objet) */
+    long long est_reads;        /* stations lues estimées */
+    int compiled;               /* règle compilée dans prog (sinon : tokens interprétés) */
+    RuleProgram prog;           /* règle compilée, évaluée par rule_run */
+} RulePlan;
+
+/* Compilation de la règle (rule_compile) et choix du plan sur la plage
+ * [lo, hi] pour au plus limit résultats - O(n + log m), n = tokens. Jamais
+ * d'échec : une règle que rule_compile refuse donne un parcours par ID sans
+ * bornes, évalué token par token */
+void rule_plan(const StationIndex* idx, char* toks[], int n, int lo, int hi, int limit, RulePlan* p);
+
+/* Exécution d'un plan (out : au moins p->limit cases ; toks, n : la règle
+ * planifiée) ; IDs croissants - O(v·n) par ID (v = stations lues), O(c·n + c log N) par index secondaire
+ * (c = candidats). Retour : nombre d'IDs écrits */
+int rule_run(const StationIndex* idx, const RulePlan* p, char* toks[], int n, int* out);
+
+struct RuleOpt;
+
+/* rule_run avec un optimiseur gardé par l'appelant d'une requête à l'autre
+ * (ro_build sur le programme de la même règle) : ses compteurs s'accumulent
+ * sur toutes les requêtes, les clauses sont reclassées même quand chacune
+ * lit moins de RO_REORDER_EVERY stations. opt NULL ou règle non compilée :
+ * comme rule_run (optimiseur propre à l'appel) */
+int rule_run_opt(const StationIndex* idx, const RulePlan* p, struct RuleOpt* opt,
+                 char* toks[], int n, int* out);
+
+/* Description lisible d'un plan dans buf (tronquée à cap octets) - O(1).
+ * Retour : longueur de la description complète (comme snprintf) */
+int rule_explain(const RulePlan* p, char* buf, int cap);
+
+#endif
@@ -0,0 +1,299 @@
+#include "rule_sub.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+/*
+ * Fonction : rs_init
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+void rs_init(RuleSubs* r){
+    memset(r,0,sizeof*r);
+}
+
+typedef unsigned long long u64;
+
+#define RS_PAGE_WORDS (RS_PAGE_BITS / 64)
+
+/* Page du bitmap : bit b de bits = ID de rang b dans la page key */
+struct RsPage {
+    unsigned key;
+    u64 bits[RS_PAGE_WORDS];
+};
+
+/* Rang non signé d'un ID (même ordre que les IDs signés) */
+static unsigned id_rank(int id){ return (unsigned)id^0x80000000u; }
+
+/* Indice de la page key dans s->pages, ou de sa place */
+static int page_find(const RuleSub* s, unsigned key){
+    int lo=0, hi=s->npages;
+    while(lo<hi){
+        int mid=(lo+hi)/2;
+        if(s->pages[mid]->key<key) lo=mid+1; else hi=mid;
+    }
+    return lo;
+}
+
+/*
+ * Fonction auxiliaire : set_put
+ * Description : Ajoute un ID à l'ensemble (page créée à la demande)
+ * Retour : 1 si réussi, 0 si échec d'allocation
+ * Complexité temps : O(log p), O(p) à la création d'une page - Complexité espace : O(1) amorti
+ */
+static int set_put(RuleSub* s, int id){
+    unsigned r=id_rank(id), key=r>>RS_PAGE_SHIFT, b=r&(RS_PAGE_BITS-1);
+    int i=page_find(s,key);
+    if(i==s->npages || s->pages[i]->key!=key){
+        if(s->npages==s->cappages){
+            int c= s->cappages ? 2*s->cappages : 4;
+            struct RsPage** t=(struct RsPage**)realloc(s->pages,sizeof(struct RsPage*)*(size_t)c);
+            if(!t) return 0;
+            s->pages=t;
+            s->cappages=c;
+        }
+        struct RsPage* pg=(struct RsPage*)calloc(1,sizeof(struct RsPage));
+        if(!pg) return 0;
+        pg->key=key;
+        memmove(s->pages+i+1,s->pages+i,sizeof(struct RsPage*)*(size_t)(s->npages-i));
+        s->pages[i]=pg;
+        s->npages++;
+    }
+    u64* w=&s->pages[i]->bits[b>>6], m=1ULL<<(b&63);
+    if(!(*w&m)){ *w|=m; s->count++; }
+    return 1;
+}
+
+/* Retire un ID de l'ensemble (pages gardées) - O(log p) */
+static void set_del(RuleSub* s, int id){
+    unsigned r=id_rank(id), key=r>>RS_PAGE_SHIFT, b=r&(RS_PAGE_BITS-1);
+    int i=page_find(s,key);
+    if(i==s->npages || s->pages[i]->key!=key) return;
+    u64* w=&s->pages[i]->bits[b>>6], m=1ULL<<(b&63);
+    if(*w&m){ *w&=~m; s->count--; }
+}
+
+/* Libère toutes les pages - O(p) */
+static void set_clear(RuleSub* s){
+    for(int i=0;i<s->npages;i++) free(s->pages[i]);
+    free(s->pages);
+    s->pages=0;
+    s->npages=s->cappages=s->count=0;
+}
+
+/* Champs lus par un programme (FIELD et tests fusionnés) */
+static unsigned fields_of(const RuleProgram* p){
+    unsigned m=0;
+    for(int i=0;i<p->len;i++){
+        int op=p->code[i].op;
+        if(op==RULE_OP_FIELD || op>=RULE_OP_TEST_GE) m|=1u<<p->code[i].field;
+    }
+    return m;
+}
+
+/* Ajout en fin de liste, capacité doublée */
+static int push(RuleSub*** list, int* n, int* cap, RuleSub* s){
+    if(*n==*cap){
+        int c= *cap ? 2**cap : 8;
+        RuleSub** t=(RuleSub**)realloc(*list,sizeof(RuleSub*)*(size_t)c);
+        if(!t) return 0;
+        *list=t;
+        *cap=c;
+    }
+    (*list)[(*n)++]=s;
+    return 1;
+}
+
+/* Retrait en gardant l'ordre */
+static void drop(RuleSub** list, int* n, const RuleSub* s){
+    for(int i=0;i<*n;i++){
+        if(list[i]!=s) continue;
+        memmove(list+i,list+i+1,sizeof(RuleSub*)*(size_t)(*n-i-1));
+        (*n)--;
+        return;
+    }
+}
+
+/*
+ * Fonction : rs_add
+ * Description : L'abonnement est inscrit dans la liste de chaque champ lu ;
+ *               une règle sans champ (constante) n'est réévaluée qu'à la
+ *               création ou la suppression d'une station
+ * Complexité temps : O(s + len) - Complexité espace : O(1) amorti
+ */
+RuleSub* rs_add(RuleSubs* r, const RuleProgram* prog, RuleNotify notify, void* ctx){
+    RuleSub* s=(RuleSub*)calloc(1,sizeof(RuleSub));
+    if(!s) return 0;
+    s->prog=*prog;
+    s->fields=fields_of(prog);
+    s->notify=notify;
+    s->ctx=ctx;
+    if(!push(&r->subs,&r->n,&r->cap,s)){ free(s); return 0; }
+    for(int f=0;f<RULE_FIELD_COUNT;f++){
+        if(!(s->fields>>f&1u)) continue;
+        if(!push(&r->dep[f],&r->ndep[f],&r->capdep[f],s)){
+            for(int g=0;g<f;g++) drop(r->dep[g],&r->ndep[g],s);
+            r->n--;
+            free(s);
+            return 0;
+        }
+    }
+    return s;
+}
+
+/*
+ * Fonction : rs_remove
+ * Complexité temps : O(s + p) - Complexité espace : O(1)
+ */
+void rs_remove(RuleSubs* r, RuleSub* s){
+    drop(r->subs,&r->n,s);
+    for(int f=0;f<RULE_FIELD_COUNT;f++) drop(r->dep[f],&r->ndep[f],s);
+    set_clear(s);
+    free(s);
+}
+
+/*
+ * Fonction auxiliaire : reeval
+ * Description : Règle évaluée avant et après la modification ; l'ensemble
+ *               suit la différence (vidé et marqué à reconstruire si la
+ *               mémoire manque, la notification part quand même)
+ * Complexité temps : O(len + log p) - Complexité espace : O(RULE_MAX_DEPTH)
+ */
+static void reeval(RuleSub* s, int id, const StationInfo* old, const StationInfo* in){
+    int was= old && rule_eval(&s->prog,old), now= in && rule_eval(&s->prog,in);
+    if(was==now) return;
+    if(!s->dirty){
+        if(now && !set_put(s,id)){ set_clear(s); s->dirty=1; }
+        if(!now) set_del(s,id);
+    }
+    if(s->notify) s->notify(s->ctx,s,id,now);
+}
+
+/*
+ * Fonction : rs_change
+ * Description : Création, suppression : tous les abonnements. Mise à jour :
+ *               seuls ceux des champs modifiés, chacun une fois (numéro de
+ *               la modification), par champ puis par ordre d'enregistrement ;
+ *               rien si aucun champ lu par une règle ne change
+ * Complexité temps : O(d · (len + log p)) - Complexité espace : O(1)
+ */
+void rs_change(RuleSubs* r, int id, const StationInfo* old, const StationInfo* in){
+    if(!old || !in){
+        for(int i=0;i<r->n;i++) reeval(r->subs[i],id,old,in);
+        return;
+    }
+    unsigned changed=0;
+    if(old->power_kW!=in->power_kW) changed|=1u<<RULE_POWER;
+    if(old->price_cents!=in->price_cents) changed|=1u<<RULE_PRICE;
+    if(old->slots_free!=in->slots_free) changed|=1u<<RULE_SLOTS;
+    if(!changed) return;
+    unsigned long long seq=++r->seq;
+    for(int f=0;f<RULE_FIELD_COUNT;f++){
+        if(!(changed>>f&1u)) continue;
+        for(int i=0;i<r->ndep[f];i++){
+            RuleSub* s=r->dep[f][i];
+            if(s->seen==seq) continue;
+            s->seen=seq;
+            reeval(s,id,old,in);
+        }
+    }
+}
+
+/*
+ * Fonction : rs_clear
+ * Complexité temps : O(s + p) - Complexité espace : O(1)
+ */
+void rs_clear(RuleSubs* r){
+    for(int i=0;i<r->n;i++){
+        set_clear(r->subs[i]);
+        free(r->subs[i]);
+    }
+    free(r->subs);
+    for(int f=0;f<RULE_FIELD_COUNT;f++) free(r->dep[f]);
+    rs_init(r);
+}
+
+/*
+ * Fonction auxiliaire : sub_fill
+ * Description : (Re)construit l'ensemble d'un abonnement par un parcours
+ *               par ID de l'index (IDs croissants : pages créées en fin)
+ * Retour : 1 si réussi, 0 si échec d'allocation (ensemble marqué à reconstruire)
+ * Complexité temps : O(m · (len + log p)) - Complexité espace : O(SI_ITER_DEPTH)
+ */
+static int sub_fill(const StationIndex* idx, RuleSub* s){
+    set_clear(s);
+    s->dirty=0;
+    SiIter it;
+    si_iter_seek(&it,idx,INT_MIN,INT_MAX);
+    for(StationNode* n; (n=si_iter_next(&it)); ){
+        if(!rule_eval(&s->prog,&n->info) || set_put(s,n->station_id)) continue;
+        set_clear(s);
+        s->dirty=1;
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * Fonction : si_sub_register
+ * Description : Compile la règle, l'inscrit au registre de l'index (créé au
+ *               premier abonnement) et remplit son ensemble. Les
+ *               notifications ne concernent que les écritures suivantes.
+ * Paramètres :
+ *   - idx : index des stations
+ *   - toks, n : règle postfix
+ *   - notify, ctx : fonction appelée à chaque entrée / sortie (NULL : aucune)
+ * Retour : Abonnement, ou NULL (règle refusée, échec d'allocation)
+ * Complexité temps : O(m · (len + log p)) - Complexité espace : O(p)
+ */
+RuleSub* si_sub_register(StationIndex* idx, char* toks[], int n, RuleNotify notify, void* ctx){
+    RuleProgram prog;
+    if(!rule_compile(toks,n,&prog)) return 0;
+    if(!idx->subs){
+        idx->subs=(RuleSubs*)malloc(sizeof(RuleSubs));
+        if(!idx->subs) return 0;
+        rs_init(idx->subs);
+    }
+    RuleSub* s=rs_add(idx->subs,&prog,notify,ctx);
+    if(!s) return 0;
+    if(!sub_fill(idx,s)){ rs_remove(idx->subs,s); return 0; }
+    return s;
+}
+
+/*
+ * Fonction : si_sub_ids
+ * Description : Bits des pages dans l'ordre : IDs croissants
+ * Complexité temps : O(p · RS_PAGE_BITS / 64 + cap), O(m · (len + log p)) si
+ *                    reconstruction
+ * Complexité espace : O(1)
+ */
+int si_sub_ids(StationIndex* idx, RuleSub* s, int* out, int cap){
+    if(s->dirty && !sub_fill(idx,s)) return 0;
+    int count=0;
+    for(int i=0;i<s->npages && count<cap;i++){
+        const struct RsPage* pg=s->pages[i];
+        for(int w=0;w<RS_PAGE_WORDS && count<cap;w++)
+            for(u64 word=pg->bits[w]; word && count<cap; word&=word-1){
+                unsigned r=pg->key<<RS_PAGE_SHIFT|(unsigned)(w*64+__builtin_ctzll(word));
+                out[count++]=(int)(r^0x80000000u);
+            }
+    }
+    return count;
+}
+
+/*
+ * Fonction : si_sub_count
+ * Complexité temps : O(1), O(m · (len + log p)) si reconstruction
+ * Complexité espace : O(1)
+ */
+int si_sub_count(StationIndex* idx, RuleSub* s){
+    if(s->dirty && !sub_fill(idx,s)) return -1;
+    return s->count;
+}
+
+/*
+ * Fonction : si_sub_unregister
+ * Complexité temps : O(s + p) - Complexité espace : O(1)
+ */
+void si_sub_unregister(StationIndex* idx, RuleSub* s){
+    if(idx->subs) rs_remove(idx->subs,s);
+}
@@ -0,0 +1,97 @@
+#ifndef DS_RULE_SUB_H
+#define DS_RULE_SUB_H
+#include "rules.h"
+
+/*
+ * ============================================================================
+ * ABONNEMENTS AUX RÈGLES (ÉVALUATION INCRÉMENTALE)
+ * ============================================================================
+ *
+ * Un abonnement est une règle compilée permanente et l'ensemble des stations
+ * qui la satisfont. Chaque modification de station (si_add, si_update,
+ * si_delete, chargements) ne réévalue que les règles qui lisent un champ
+ * modifié (table champ → abonnements), et seulement pour cette station ;
+ * une création ou une suppression les réévalue toutes. L'ensemble est un
+ * bitmap des IDs par pages de RS_PAGE_BITS IDs consécutifs, allouées à la
+ * demande et rangées par ID (recherche dichotomique) : entrée et sortie en
+ * O(log p), p = pages, IDs croissants sans tri. Une station qui
+ * entre dans l'ensemble ou en sort est notifiée par l'appel de la fonction
+ * de l'abonnement, pendant l'écriture : cette fonction ne doit modifier ni
+ * l'index ni ses abonnements. Enregistrés sur un index (si_sub_register),
+ * qui les tient à jour.
+ */
+
+/* IDs par page de l'ensemble d'un abonnement (puissance de 2) */
+#define RS_PAGE_SHIFT 12
+#define RS_PAGE_BITS (1 << RS_PAGE_SHIFT)
+
+struct RuleSub;
+struct RsPage;
+
+/* Notification : entered = 1 si la station satisfait désormais la règle,
+ * 0 si elle ne la satisfait plus (ou a été supprimée) */
+typedef void (*RuleNotify)(void* ctx, const struct RuleSub* sub, int station_id, int entered);
+
+/* Abonnement */
+typedef struct RuleSub {
+    RuleProgram prog;           /* règle compilée */
+    unsigned fields;            /* champs lus : bit f pour le RuleField f */
+    int count;                  /* stations qui satisfont la règle */
+    int npages, cappages;       /* pages du bitmap, par ID croissant */
+    struct RsPage** pages;
+    int dirty;                  /* 1 : ensemble à reconstruire (échec d'allocation) */
+    unsigned long long seen;    /* dernière modification traitée (dédoublonnage) */
+    RuleNotify notify;          /* fonction notifiée (NULL : aucune) */
+    void* ctx;                  /* premier paramètre de notify */
+} RuleSub;
+
+/* Registre des abonnements d'un index */
+typedef struct RuleSubs {
+    int n, cap;                         /* abonnements, ordre d'enregistrement */
+    RuleSub** subs;
+    int ndep[RULE_FIELD_COUNT];         /* abonnements qui lisent chaque champ ... */
+    int capdep[RULE_FIELD_COUNT];
+    RuleSub** dep[RULE_FIELD_COUNT];    /* ... dans l'ordre d'enregistrement */
+    unsigned long long seq;             /* modifications traitées */
+} RuleSubs;
+
+/* Initialisation d'un registre vide - O(1) */
+void rs_init(RuleSubs* r);
+
+/* Nouvel abonnement à la règle compilée prog, ensemble vide - O(s), s =
+ * abonnements. Retour : l'abonnement, NULL si échec d'allocation */
+RuleSub* rs_add(RuleSubs* r, const RuleProgram* prog, RuleNotify notify, void* ctx);
+
+/* Retrait et libération d'un abonnement - O(s + p) */
+void rs_remove(RuleSubs* r, RuleSub* s);
+
+/* Répercussion d'une modification de station (old NULL : création,
+ * in NULL : suppression) : règles concernées réévaluées, ensembles tenus à
+ * jour, entrées et sorties notifiées - O(d · (len + log p)), d = abonnements
+ * qui lisent un champ modifié (tous pour une création ou une suppression) */
+void rs_change(RuleSubs* r, int id, const StationInfo* old, const StationInfo* in);
+
+/* Libération de tous les abonnements (registre vide, réutilisable) - O(s + p) */
+void rs_clear(RuleSubs* r);
+
+/* Abonne l'index à une règle postfix : ensemble rempli avec les stations
+ * présentes (sans notification), puis tenu à jour par si_add, si_update,
+ * si_delete et si_build_sorted (tous backends). L'abonnement appartient à
+ * l'index : si_sub_unregister ou si_clear le libère - O(m · (len + log p)).
+ * Retour : abonnement, NULL si la règle est refusée par rule_compile ou si
+ * échec d'allocation */
+RuleSub* si_sub_register(StationIndex* idx, char* toks[], int n, RuleNotify notify, void* ctx);
+
+/* IDs des stations qui satisfont la règle, croissants (au plus cap) ; un
+ * ensemble abandonné après un échec d'allocation est reconstruit ici -
+ * O(p · RS_PAGE_BITS / 64 + cap). Retour : nombre d'IDs écrits */
+int si_sub_ids(StationIndex* idx, RuleSub* s, int* out, int cap);
+
+/* Nombre de stations qui satisfont la règle - O(1) (O(m · len) si
+ * reconstruction). Retour : -1 si échec d'allocation */
+int si_sub_count(StationIndex* idx, RuleSub* s);
+
+/* Retire et libère un abonnement - O(s + p) */
+void si_sub_unregister(StationIndex* idx, RuleSub* s);
+
+#endif
@@ -1,12 +1,18 @@
-#include "station_index.h"
+#include "rules.h"
 #include "stack.h"
+#include "rule_plan.h"
+#include "rule_batch.h"
+#include "rule_opt.h"
+#include <limits.h>
 #include <string.h>
 #include <stdlib.h>
 
 /*
- * Fonction : eval_rule_postfix
+ * Fonction auxiliaire : eval_tokens
  * Description : Évalue une règle de filtrage en notation postfix (polonaise inversée)
- *               Utilise une pile pour évaluer les expressions
+ *               en interprétant directement les tokens avec une pile chaînée
+ *               (une allocation par empilement). Repli de eval_rule_postfix
+ *               pour les règles que rule_compile refuse
  *
  * Notation postfix : les opérateurs suivent les opérandes
  * Exemple : "slots 1 >= power 50 >= &&"
@@ -37,7 +43,7 @@
  *   2) Règle : "power 50 >= price 250 <= &&"
  *      Évalue : (power >= 50) AND (price <= 250)
  */
-int eval_rule_postfix(char* toks[], int n, StationInfo* info){
+static int eval_tokens(char* toks[], int n, StationInfo* info){
     Stack st;
     st_init(&st);
 
@@ -110,4 +116,156 @@ int eval_rule_postfix(char* toks[], int n, StationInfo* info){
     st_pop(&st,&ok);
     st_clear(&st);
     return ok!=0;
-}
\ No newline at end of file
+}
+
+/*
+ * Fonction auxiliaire : binop_of
+ * Description : Opération d'un token d'opérateur, aiguillée sur son premier
+ *               caractère (même reconnaissance exacte que strcmp)
+ * Retour : RuleOp, -1 si le token n'est pas un opérateur
+ */
+static int binop_of(const char* t){
+    switch(t[0]){
+        case '>': return t[1]=='\0' ? RULE_OP_GT : (t[1]=='=' && t[2]=='\0') ? RULE_OP_GE : -1;
+        case '<': return t[1]=='\0' ? RULE_OP_LT : (t[1]=='=' && t[2]=='\0') ? RULE_OP_LE : -1;
+        case '=': return (t[1]=='=' && t[2]=='\0') ? RULE_OP_EQ : -1;
+        case '&': return (t[1]=='&' && t[2]=='\0') ? RULE_OP_AND : -1;
+        case '|': return (t[1]=='|' && t[2]=='\0') ? RULE_OP_OR : -1;
+        default: return -1;
+    }
+}
+
+/* Comparaison retournée : c op champ  <=>  champ miroir c (>= ↔ <=, > ↔ <) */
+static const RuleOp RULE_MIRROR[] = { RULE_OP_LE, RULE_OP_GE, RULE_OP_LT, RULE_OP_GT, RULE_OP_EQ };
+
+/*
+ * Fonction : rule_compile
+ * Description : Une passe sur les tokens ; la hauteur de pile est suivie
+ *               comme à l'évaluation. Une comparaison dont les deux
+ *               opérandes sont les deux dernières instructions émises, un
+ *               champ et une constante, les remplace par un test fusionné
+ * Complexité temps : O(n) - Complexité espace : O(1)
+ */
+int rule_compile(char* toks[], int n, RuleProgram* prog){
+    prog->len = 0;
+    prog->depth = 0;
+    int sp = 0;
+
+    for(int i=0; i<n; i++){
+        const char* t = toks[i];
+        int op = binop_of(t);
+
+        // Opérateur : deux opérandes dépilées, un résultat empilé
+        if(op >= 0){
+            if(sp < 2) return 0;
+            sp--;
+            RuleInsn* c = prog->code;
+            int m = prog->len;
+            if(op <= RULE_OP_EQ && m >= 2){
+                RuleInsn a = c[m-2], b = c[m-1];
+                if(a.op == RULE_OP_FIELD && b.op == RULE_OP_CONST){
+                    c[m-2].op = (unsigned char)(op - RULE_OP_GE + RULE_OP_TEST_GE);
+                    c[m-2].arg = b.arg;
+                    prog->len--;
+                    continue;
+                }
+                if(a.op == RULE_OP_CONST && b.op == RULE_OP_FIELD){
+                    c[m-2].op = (unsigned char)(RULE_MIRROR[op - RULE_OP_GE] - RULE_OP_GE + RULE_OP_TEST_GE);
+                    c[m-2].field = b.field;
+                    prog->len--;
+                    continue;
+                }
+            }
+            if(m >= RULE_MAX_CODE) return 0;
+            prog->code[prog->len++] = (RuleInsn){ (unsigned char)op, 0, 0 };
+            continue;
+        }
+
+        // Opérande : champ résolu, ou nombre converti une fois pour toutes
+        if(prog->len >= RULE_MAX_CODE || sp >= RULE_MAX_DEPTH) return 0;
+        RuleInsn in = { RULE_OP_CONST, 0, 0 };
+        if(t[0]=='p' && strcmp(t,"power")==0){ in.op = RULE_OP_FIELD; in.field = RULE_POWER; }
+        else if(t[0]=='p' && strcmp(t,"price")==0){ in.op = RULE_OP_FIELD; in.field = RULE_PRICE; }
+        else if(t[0]=='s' && strcmp(t,"slots")==0){ in.op = RULE_OP_FIELD; in.field = RULE_SLOTS; }
+        else in.arg = atoi(t);
+        prog->code[prog->len++] = in;
+        if(++sp > prog->depth) prog->depth = sp;
+    }
+    return 1;
+}
+
+/*
+ * Fonction : rule_eval
+ * Description : Pile d'entiers de taille fixe (hauteur vérifiée à la
+ *               compilation), champs de la station lus une fois
+ * Complexité temps : O(len) - Complexité espace : O(RULE_MAX_DEPTH)
+ */
+int rule_eval(const RuleProgram* prog, const StationInfo* info){
+    int st[RULE_MAX_DEPTH];
+    int sp = 0;
+    const int fv[RULE_FIELD_COUNT] = { info->power_kW, info->price_cents, info->slots_free };
+
+    for(const RuleInsn* c = prog->code, * end = c + prog->len; c < end; c++){
+        switch(c->op){
+            case RULE_OP_FIELD:   st[sp++] = fv[c->field]; break;
+            case RULE_OP_CONST:   st[sp++] = c->arg; break;
+            case RULE_OP_GE:      sp--; st[sp-1] = st[sp-1] >= st[sp]; break;
+            case RULE_OP_LE:      sp--; st[sp-1] = st[sp-1] <= st[sp]; break;
+            case RULE_OP_GT:      sp--; st[sp-1] = st[sp-1] > st[sp]; break;
+            case RULE_OP_LT:      sp--; st[sp-1] = st[sp-1] < st[sp]; break;
+            case RULE_OP_EQ:      sp--; st[sp-1] = st[sp-1] == st[sp]; break;
+            case RULE_OP_AND:     sp--; st[sp-1] = st[sp-1] && st[sp]; break;
+            case RULE_OP_OR:      sp--; st[sp-1] = st[sp-1] || st[sp]; break;
+            case RULE_OP_TEST_GE: st[sp++] = fv[c->field] >= c->arg; break;
+            case RULE_OP_TEST_LE: st[sp++] = fv[c->field] <= c->arg; break;
+            case RULE_OP_TEST_GT: st[sp++] = fv[c->field] > c->arg; break;
+            case RULE_OP_TEST_LT: st[sp++] = fv[c->field] < c->arg; break;
+            default:              st[sp++] = fv[c->field] == c->arg; break;
+        }
+    }
+
+    // Règle vide : non satisfaite (comme une pile vide à l'interprétation)
+    return sp > 0 && st[sp-1] != 0;
+}
+
+/*
+ * Fonction : eval_rule_postfix
+ * Description : Compile la règle sur la pile d'appel puis l'évalue ; les
+ *               règles refusées par rule_compile passent par l'interpréteur
+ *               de tokens
+ * Complexité temps : O(n) - Complexité espace : O(1)
+ */
+int eval_rule_postfix(char* toks[], int n, StationInfo* info){
+    RuleProgram prog;
+    if(rule_compile(toks, n, &prog)) return rule_eval(&prog, info);
+    return eval_tokens(toks, n, info);
+}
+
+int si_rule_ids(const StationIndex* idx, char* toks[], int n, int lo, int hi, int* out, int cap){
+    if(!out || cap <= 0) return 0;
+
+    // Plan : bornes déduites de la règle, puis curseur élagué ou index secondaire
+    RulePlan plan;
+    rule_plan(idx, toks, n, lo, hi, cap, &plan);
+    return rule_run(idx, &plan, toks, n, out);
+}
+
+int si_rule_count(StationIndex* idx, char* toks[], int n){
+    RuleProgram prog;
+    int compiled = rule_compile(toks, n, &prog);
+
+    // Instantané colonnaire : blocs de 64 stations, un masque par instruction
+    StationColumns* c = idx->cols;
+    if(compiled && c && (!c->dirty || sc_rebuild(c, idx))) return rb_count_rule(&prog, c);
+
+    // Repli : curseur par ID, une station à la fois, clauses en court-circuit
+    RuleOpt opt;
+    if(compiled) ro_build(&opt, &prog);
+    SiIter it;
+    si_iter_seek(&it, idx, INT_MIN, INT_MAX);
+    int count = 0;
+    for(StationNode* s; (s = si_iter_next(&it)); ){
+        count += compiled ? ro_eval(&opt, &s->info) : eval_rule_postfix(toks, n, &s->info);
+    }
+    return count;
+}
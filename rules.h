@@ -0,0 +1,133 @@
+#ifndef DS_RULES_H
+#define DS_RULES_H
+#include "station_index.h"
+
+/*
+ * ============================================================================
+ * RÈGLES DE FILTRAGE POSTFIX
+ * ============================================================================
+ *
+ * Une règle est une suite de tokens en notation polonaise inversée, par
+ * exemple { "slots", "1", ">=", "power", "50", ">=", "&&" } pour
+ * (slots >= 1) ET (power >= 50). Voir eval_rule_postfix pour les tokens admis.
+ */
+
+/* Taille maximale d'une règle compilée (instructions) et de sa pile */
+#define RULE_MAX_CODE 128
+#define RULE_MAX_DEPTH 32
+
+/* Champs lus par une règle */
+typedef enum RuleField {
+    RULE_POWER = 0,         /* power_kW (même rang que SI_ATTR_POWER) */
+    RULE_PRICE = 1,         /* price_cents (même rang que SI_ATTR_PRICE) */
+    RULE_SLOTS = 2,         /* slots_free (pas d'index secondaire) */
+    RULE_FIELD_COUNT = 3
+} RuleField;
+
+/* Opérations d'une règle compilée. Les comparaisons sont rangées dans
+ * l'ordre >=, <=, >, <, == pour les deux formes (pile et fusionnée) */
+typedef enum RuleOp {
+    RULE_OP_FIELD = 0,      /* empile le champ field */
+    RULE_OP_CONST = 1,      /* empile la constante arg */
+    RULE_OP_GE = 2,         /* dépile b puis a, empile a >= b ... */
+    RULE_OP_LE = 3,
+    RULE_OP_GT = 4,
+    RULE_OP_LT = 5,
+    RULE_OP_EQ = 6,
+    RULE_OP_AND = 7,        /* dépile b puis a, empile a && b */
+    RULE_OP_OR = 8,         /* dépile b puis a, empile a || b */
+    RULE_OP_TEST_GE = 9,    /* empile (champ field >= arg) : "champ constante op" ... */
+    RULE_OP_TEST_LE = 10,   /* ... ou "constante champ op" (opérateur retourné) */
+    RULE_OP_TEST_GT = 11,
+    RULE_OP_TEST_LT = 12,
+    RULE_OP_TEST_EQ = 13
+} RuleOp;
+
+/* Instruction d'une règle compilée */
+typedef struct RuleInsn {
+    unsigned char op;       /* RuleOp */
+    unsigned char field;    /* RuleField (RULE_OP_FIELD, RULE_OP_TEST_*) */
+    int arg;                /* constante (RULE_OP_CONST, RULE_OP_TEST_*) */
+} RuleInsn;
+
+/* Règle compilée : programme pour une pile de taille fixe */
+typedef struct RuleProgram {
+    int len;                /* nombre d'instructions */
+    int depth;              /* hauteur maximale de la pile */
+    RuleInsn code[RULE_MAX_CODE];
+} RuleProgram;
+
+/*
+ * Fonction : rule_compile
+ * Description : Traduit une règle postfix en programme : champs et
+ *               constantes résolus une fois, motifs "champ constante op"
+ *               fusionnés en une instruction, hauteur de pile vérifiée
+ * Paramètres :
+ *   - toks, n : règle postfix (tokens de eval_rule_postfix)
+ *   - prog : programme produit
+ * Retour : 1 si compilée, 0 si mal formée (opérateur sans ses deux
+ *          opérandes), plus longue que RULE_MAX_CODE instructions ou plus
+ *          profonde que RULE_MAX_DEPTH
+ * Complexité temps : O(n) - Complexité espace : O(1)
+ */
+int rule_compile(char* toks[], int n, RuleProgram* prog);
+
+/*
+ * Fonction : rule_eval
+ * Description : Évalue une règle compilée sur une station, sans allocation
+ * Retour : 1 si la station satisfait la règle, 0 sinon
+ * Complexité temps : O(len) - Complexité espace : O(RULE_MAX_DEPTH) sur la pile d'appel
+ */
+int rule_eval(const RuleProgram* prog, const StationInfo* info);
+
+/*
+ * Fonction : eval_rule_postfix
+ * Description : Évalue une règle sur les informations d'une station
+ *               (compilation puis rule_eval ; pour évaluer une même règle
+ *               sur beaucoup de stations, compiler une fois avec rule_compile)
+ * Retour : 1 si la station satisfait la règle, 0 sinon
+ * Complexité temps : O(n) - n = nombre de tokens
+ * Complexité espace : O(1) - Programme et pile sur la pile d'appel
+ */
+int eval_rule_postfix(char* toks[], int n, StationInfo* info);
+
+/*
+ * Fonction : si_rule_ids
+ * Description : IDs des stations de la plage [lo, hi] qui satisfont la règle,
+ *               par ID croissant (quel que soit le backend) ; le chemin
+ *               d'accès est choisi par rule_plan (curseur arrêté au cap-ième
+ *               résultat et élagué par les bornes de la règle, ou index
+ *               secondaire de la puissance / du prix s'il est plus sélectif)
+ * Paramètres :
+ *   - idx : index des stations
+ *   - toks, n : règle postfix
+ *   - lo, hi : plage d'IDs (bornes incluses)
+ *   - out : tableau destination pour les IDs
+ *   - cap : capacité maximale du tableau
+ * Retour : Nombre d'IDs écrits dans le tableau
+ * Complexité temps : O(log m + v·n), v = stations lues (celles de la plage
+ *                    avant le cap-ième résultat, ou candidats de l'index)
+ * Complexité espace : O(n), O(c) par index secondaire (c = candidats)
+ *
+ * Exemple : les 10 premières stations de 50 kW ou plus
+ *   char* r[] = { "power", "50", ">=" };
+ *   si_rule_ids(&idx, r, 3, INT_MIN, INT_MAX, ids, 10);
+ */
+int si_rule_ids(const StationIndex* idx, char* toks[], int n, int lo, int hi, int* out, int cap);
+
+/*
+ * Fonction : si_rule_count
+ * Description : Nombre de stations qui satisfont la règle. Avec l'instantané
+ *               colonnaire (si_enable_columns), évaluation par blocs de 64
+ *               stations en SIMD (rb_count_rule) ; sinon curseur par ID
+ * Paramètres :
+ *   - idx : index des stations
+ *   - toks, n : règle postfix
+ * Retour : Nombre de stations
+ * Complexité temps : O(m·n) - m = stations, n = tokens (divisé par la
+ *                    largeur SIMD avec l'instantané)
+ * Complexité espace : O(1)
+ */
+int si_rule_count(StationIndex* idx, char* toks[], int n);
+
+#endif
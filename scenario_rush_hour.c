@@ -4,6 +4,7 @@
 #include "queue.h"
 #include "events.h"
 #include "advanced_queries.h"
+#include "topk_view.h"
 #include "csv_loader.h"
 
 /*
@@ -20,9 +21,11 @@
  *   3. Simuler une rafale d'événements (100+ arrivées)
  *   4. Afficher l'état après la rafale
  *   5. Utiliser Range Query pour analyser une zone spécifique
- *   6. Compter les stations haute puissance disponibles
+ *   6. Compter les stations haute puissance disponibles, proposer les
+ *      stations disponibles les plus proches d'un conducteur
  *
- * Démontre : A1 (range queries), A2 (top-k), gestion d'événements massifs
+ * Démontre : A1 (range queries), A2 (top-k), A3 (plus proches voisins),
+ *            gestion d'événements massifs
  */
 
 /*
@@ -40,38 +43,36 @@ static void wait_user() {
     while (getchar() != '\n');
 }
 
+/* Valeurs par défaut d'une station inexistante */
+static const StationInfo DEFAULT_STATION = { 50, 300, 2, 0 };
+
 /*
- * Fonction : process_single_event
- * Description : Traite un événement unique (branchement/débranchement)
+ * Fonction : apply_event
+ * Description : Modifie en place l'état d'une station selon un événement
+ *               (appelée par si_update sur le nœud de l'AVL)
  */
-static void process_single_event(Event e, StationIndex* idx) {
-    // Rechercher la station
-    StationNode* sn = si_find(idx->root, e.station_id);
-    StationInfo info;
-
-    if (sn) {
-        info = sn->info;
-    } else {
-        // Créer avec valeurs par défaut si inexistante
-        info.power_kW = 50;
-        info.price_cents = 300;
-        info.slots_free = 2;
-        info.last_ts = 0;
-    }
+static void apply_event(StationInfo* info, void* ctx) {
+    const Event* e = (const Event*)ctx;
 
     // Mettre à jour selon l'action
-    if (e.action == 1) {  // Branchement
-        if (info.slots_free > 0) {
-            info.slots_free--;
+    if (e->action == 1) {  // Branchement
+        if (info->slots_free > 0) {
+            info->slots_free--;
         }
-    } else if (e.action == 0) {  // Débranchement
-        info.slots_free++;
+    } else if (e->action == 0) {  // Débranchement
+        info->slots_free++;
     }
 
-    info.last_ts = e.ts;
+    info->last_ts = e->ts;
+}
 
-    // Mettre à jour dans l'AVL
-    si_add(idx, e.station_id, info);
+/*
+ * Fonction : process_single_event
+ * Description : Traite un événement unique (branchement/débranchement)
+ *               Une seule descente dans l'AVL, modification en place
+ */
+static void process_single_event(Event e, StationIndex* idx) {
+    si_update(idx, e.station_id, &DEFAULT_STATION, apply_event, &e);
 }
 
 /*
@@ -96,18 +97,22 @@ static int generate_rush_hour_events(Queue* q, int num_events) {
 /*
  * Fonction : print_top_k_stations
  * Description : Affiche le Top-K des stations par score
+ *               Lu dans la vue maintenue si elle est fournie (O(k), sans
+ *               recalcul après une rafale), sinon calculé
  */
-static void print_top_k_stations(StationIndex* idx, int k, int alpha, int beta, int gamma) {
+static void print_top_k_stations(StationIndex* idx, TopKView* view,
+                                 int k, int alpha, int beta, int gamma) {
     int* top_ids = (int*)malloc(sizeof(int) * k);
     if (!top_ids) return;
 
-    int count = si_top_k_by_score(idx->root, k, top_ids, alpha, beta, gamma);
+    int count = view ? si_view_read(idx, view, top_ids)
+                     : si_top_k_idx(idx, k, top_ids, alpha, beta, gamma);
 
     printf("  Top-%d stations (score = %d*slots + %d*power - %d*price):\n",
            k, alpha, beta, gamma);
 
     for (int i = 0; i < count; i++) {
-        StationNode* s = si_find(idx->root, top_ids[i]);
+        StationNode* s = si_find_idx(idx, top_ids[i]);
         if (s) {
             int score = s->info.slots_free * alpha +
                        s->info.power_kW * beta -
@@ -134,6 +139,9 @@ void run_rush_hour_scenario(void) {
     printf("\n>>> ETAPE 1 : Chargement du dataset CSV...\n");
     StationIndex idx;
     si_init(&idx);
+    si_enable_lookup(&idx); // si_find_idx en O(1) pendant tout le scenario
+    si_enable_attr_index(&idx); // filtres puissance / prix en O(log n)
+    si_enable_columns(&idx); // Top-K par parcours colonnaire SIMD
     int loaded = ds_load_stations_from_csv("izivia_tp_subset.csv", &idx);
     if (loaded <= 0) {
         printf("[ERREUR] Impossible de charger le fichier CSV.\n");
@@ -147,16 +155,17 @@ void run_rush_hour_scenario(void) {
 
     // Paramètres de scoring : slots=2, power=1, price=1
     int alpha = 2, beta = 1, gamma = 1;
-    print_top_k_stations(&idx, 5, alpha, beta, gamma);
+    // Vue Top-5 enregistrée : mise à jour par chaque événement de la rafale
+    TopKView* best5 = si_view_register(&idx, 5, alpha, beta, gamma);
+    print_top_k_stations(&idx, best5, 5, alpha, beta, gamma);
 
     // Statistiques initiales
-    int high_power = si_count_ge_power(idx.root, 100);
+    int high_power = si_count_ge_power_idx(&idx, 100);
     printf("\n  Statistiques :\n");
     printf("    - Stations haute puissance (>= 100kW) : %d\n", high_power);
 
-    // Range query : zone 1100-1150
-    int range_ids[100];
-    int range_count = si_range_ids(idx.root, 1100, 1150, range_ids, 100);
+    // Range query : zone 1100-1150 (comptage par rangs, sans extraire les IDs)
+    int range_count = si_count_range(idx.root, 1100, 1150);
     printf("    - Stations dans la zone [1100-1150] : %d\n", range_count);
     printf("\n");
     wait_user();
@@ -185,32 +194,36 @@ void run_rush_hour_scenario(void) {
     // ========== ÉTAPE 4 : ÉTAT APRÈS LA RAFALE ==========
     printf(">>> ETAPE 4 : Etat APRES l'heure de pointe\n");
 
-    print_top_k_stations(&idx, 5, alpha, beta, gamma);
+    print_top_k_stations(&idx, best5, 5, alpha, beta, gamma);
 
     // Nouvelles statistiques
-    high_power = si_count_ge_power(idx.root, 100);
+    high_power = si_count_ge_power_idx(&idx, 100);
     printf("\n  Statistiques :\n");
     printf("    - Stations haute puissance (>= 100kW) : %d\n", high_power);
 
-    range_count = si_range_ids(idx.root, 1100, 1150, range_ids, 100);
+    range_count = si_count_range(idx.root, 1100, 1150);
     printf("    - Stations dans la zone [1100-1150] : %d\n", range_count);
     wait_user();
 
     // ========== ÉTAPE 5 : ANALYSE DÉTAILLÉE D'UNE ZONE ==========
     printf("\n>>> ETAPE 5 : Analyse detaillee de la zone [1100-1110]\n");
 
-    int zone_ids[20];
-    int zone_count = si_range_ids(idx.root, 1100, 1110, zone_ids, 20);
+    // Agrégats de la zone en O(log n) (sans parcourir ses stations)
+    RangeStats zone;
+    si_range_stats(idx.root, 1100, 1110, &zone);
 
-    printf("    Stations trouvees dans cette zone : %d\n", zone_count);
+    printf("    Stations trouvees dans cette zone : %d\n", zone.count);
+    printf("    Places libres au total : %lld, puissance max : %dkW\n",
+           zone.sum_slots, zone.max_power);
     printf("    Details :\n");
 
-    for (int i = 0; i < zone_count && i < 10; i++) {
-        StationNode* s = si_find(idx.root, zone_ids[i]);
-        if (s) {
-            printf("      - Station %d : %d slots libres, %dkW\n",
-                   s->station_id, s->info.slots_free, s->info.power_kW);
-        }
+    // Curseur sur la zone : les nœuds rendus portent déjà les informations
+    SiIter it;
+    si_iter_seek(&it, &idx, 1100, 1110);
+    StationNode* s;
+    for (int i = 0; i < 10 && (s = si_iter_next(&it)); i++) {
+        printf("      - Station %d : %d slots libres, %dkW\n",
+               s->station_id, s->info.slots_free, s->info.power_kW);
     }
 
     wait_user();
@@ -220,17 +233,31 @@ void run_rush_hour_scenario(void) {
 
     // Top-3 avec pondération forte sur les slots disponibles
     int top_available[3];
-    int avail_count = si_top_k_by_score(idx.root, 3, top_available, 10, 1, 1);
+    int avail_count = si_top_k_idx(&idx, 3, top_available, 10, 1, 1);
 
     printf("    Top-3 stations les plus disponibles (score = 10*slots + power - price) :\n");
     for (int i = 0; i < avail_count; i++) {
-        StationNode* s = si_find(idx.root, top_available[i]);
+        StationNode* s = si_find_idx(&idx, top_available[i]);
         if (s) {
             printf("      %d. Station %d (%d slots libres, %dkW)\n",
                    i + 1, s->station_id, s->info.slots_free, s->info.power_kW);
         }
     }
 
+    // Stations proches d'un conducteur (positions du CSV, arbre k-d)
+    int near_ids[3];
+    double near_km[3];
+    int near_count = si_nearest_idx(&idx, 48.8566, 2.3522, 3, 1, 50, near_ids, near_km);
+
+    printf("\n    3 stations les plus proches de Paris (>= 1 slot libre, >= 50kW) :\n");
+    for (int i = 0; i < near_count; i++) {
+        StationNode* s = si_find_idx(&idx, near_ids[i]);
+        if (s) {
+            printf("      %d. Station %d a %.1f km (%d slots libres, %dkW)\n",
+                   i + 1, s->station_id, near_km[i], s->info.slots_free, s->info.power_kW);
+        }
+    }
+
     // Nettoyage
     si_clear(&idx);
 }
\ No newline at end of file
@@ -0,0 +1,401 @@
+#include "station_columns.h"
+#include "bptree.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SC_HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+/*
+ * Fonction : sc_init
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+void sc_init(StationColumns* c){
+    memset(c,0,sizeof*c);
+    c->dirty=1;
+}
+
+/*
+ * Fonction auxiliaire : sc_reserve
+ * Description : Garantit une capacité d'au moins need lignes (doublement)
+ * Retour : 1 si réussi, 0 si échec d'allocation (colonnes inchangées)
+ * Complexité temps : O(n) amorti O(1) - Complexité espace : O(cap)
+ */
+static int sc_reserve(StationColumns* c, int need){
+    if(need<=c->cap) return 1;
+    int cap= c->cap ? c->cap : 1024;
+    while(cap<need) cap*=2;
+    int** cols[4]={&c->id,&c->slots,&c->power,&c->price};
+    int* fresh[4];
+    for(int k=0;k<4;k++){
+        fresh[k]=(int*)malloc(sizeof(int)*(size_t)cap);
+        if(!fresh[k]){ while(k>0) free(fresh[--k]); return 0; }
+    }
+    for(int k=0;k<4;k++){
+        if(c->n) memcpy(fresh[k],*cols[k],sizeof(int)*(size_t)c->n);
+        free(*cols[k]);
+        *cols[k]=fresh[k];
+    }
+    c->cap=cap;
+    return 1;
+}
+
+/*
+ * Fonction auxiliaire : put_row
+ * Description : Écrit les champs de score d'une station à la ligne i
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+static void put_row(StationColumns* c, int i, int id, const StationInfo* in){
+    c->id[i]=id; c->slots[i]=in->slots_free; c->power[i]=in->power_kW; c->price[i]=in->price_cents;
+}
+
+/*
+ * Fonction auxiliaire récursive : fill_avl
+ * Description : Recopie l'AVL dans les colonnes par parcours in-order
+ * Complexité temps : O(n) - Complexité espace : O(log n)
+ */
+static void fill_avl(StationColumns* c, const StationNode* r){
+    if(!r) return;
+    fill_avl(c,r->left);
+    put_row(c,c->n++,r->station_id,&r->info);
+    fill_avl(c,r->right);
+}
+
+/*
+ * Fonction : sc_rebuild
+ * Description : Reconstruit l'instantané depuis l'index (ordre des IDs)
+ * Retour : 1 si réussi, 0 si échec d'allocation
+ * Complexité temps : O(n) - Complexité espace : O(n)
+ */
+int sc_rebuild(StationColumns* c, const StationIndex* idx){
+    int n;
+    if(idx->backend==SI_BACKEND_BPTREE) n= idx->bp ? idx->bp->count : 0;
+    else n= idx->root ? idx->root->size : 0;
+    c->dirty=1;
+    if(!sc_reserve(c,n)) return 0;
+    c->n=0;
+    if(idx->backend==SI_BACKEND_BPTREE){
+        const BPNode* leaf= idx->bp ? idx->bp->root : 0;
+        while(leaf && !leaf->is_leaf) leaf=leaf->children[0];
+        for(; leaf; leaf=leaf->leaf.next)
+            for(int i=0;i<leaf->nkeys;i++) put_row(c,c->n++,leaf->keys[i],&leaf->leaf.recs[i]->info);
+    }
+    else fill_avl(c,idx->root);
+    c->dirty=0;
+    return 1;
+}
+
+/*
+ * Fonction auxiliaire : lower_bound
+ * Description : Première ligne d'ID >= id (recherche dichotomique)
+ * Complexité temps : O(log n) - Complexité espace : O(1)
+ */
+static int lower_bound(const StationColumns* c, int id){
+    int lo=0, hi=c->n;
+    while(lo<hi){
+        int mid=lo+(hi-lo)/2;
+        if(c->id[mid]<id) lo=mid+1; else hi=mid;
+    }
+    return lo;
+}
+
+/*
+ * Fonction : sc_set
+ * Description : Réécrit la ligne d'une station existante ; une station
+ *               nouvelle est insérée à sa place (décalage des colonnes,
+ *               rien à décaler quand les IDs arrivent en ordre croissant)
+ * Retour : 1 si réussi, 0 si échec d'allocation (instantané à reconstruire)
+ * Complexité temps : O(log n) pour une mise à jour, O(n) pour un ajout
+ * Complexité espace : O(1) amorti
+ */
+int sc_set(StationColumns* c, int id, const StationInfo* in){
+    int i=lower_bound(c,id);
+    if(i<c->n && c->id[i]==id){ put_row(c,i,id,in); return 1; }
+    if(!sc_reserve(c,c->n+1)){ c->dirty=1; return 0; }
+    size_t tail=sizeof(int)*(size_t)(c->n-i);
+    memmove(c->id+i+1,c->id+i,tail);
+    memmove(c->slots+i+1,c->slots+i,tail);
+    memmove(c->power+i+1,c->power+i,tail);
+    memmove(c->price+i+1,c->price+i,tail);
+    put_row(c,i,id,in);
+    c->n++;
+    return 1;
+}
+
+/*
+ * Fonction : sc_remove
+ * Description : Retire la ligne d'une station (décalage des colonnes)
+ * Retour : 1 si la station était présente, 0 sinon
+ * Complexité temps : O(n) - Complexité espace : O(1)
+ */
+int sc_remove(StationColumns* c, int id){
+    int i=lower_bound(c,id);
+    if(i>=c->n || c->id[i]!=id) return 0;
+    size_t tail=sizeof(int)*(size_t)(c->n-i-1);
+    memmove(c->id+i,c->id+i+1,tail);
+    memmove(c->slots+i,c->slots+i+1,tail);
+    memmove(c->power+i,c->power+i+1,tail);
+    memmove(c->price+i,c->price+i+1,tail);
+    c->n--;
+    return 1;
+}
+
+/* Station retenue et son score */
+typedef struct ScRanked {
+    int station_id;
+    int score;
+} ScRanked;
+
+/*
+ * Sélection des k meilleurs : tas dont la racine est la PIRE station retenue
+ * (score le plus faible ; à score égal, ID le plus grand). Classement final :
+ * score décroissant puis ID croissant, comme si_top_k_by_score.
+ */
+typedef struct TopK {
+    ScRanked* h;        /* tas de taille cap */
+    int size, cap;
+    int thr;            /* score à dépasser strictement une fois le tas plein */
+} TopK;
+
+/* a est-il moins bon que b ? */
+static int worse(const ScRanked* a, const ScRanked* b){
+    return a->score<b->score || (a->score==b->score && a->station_id>b->station_id);
+}
+
+static void tk_down(TopK* t, int i){
+    for(;;){
+        int l=2*i+1, r=l+1, m=i;
+        if(l<t->size && worse(&t->h[l],&t->h[m])) m=l;
+        if(r<t->size && worse(&t->h[r],&t->h[m])) m=r;
+        if(m==i) return;
+        ScRanked x=t->h[i]; t->h[i]=t->h[m]; t->h[m]=x;
+        i=m;
+    }
+}
+
+static void tk_up(TopK* t, int i){
+    while(i>0){
+        int p=(i-1)/2;
+        if(!worse(&t->h[i],&t->h[p])) return;
+        ScRanked x=t->h[i]; t->h[i]=t->h[p]; t->h[p]=x;
+        i=p;
+    }
+}
+
+/*
+ * Fonction auxiliaire : tk_offer
+ * Description : Propose une station ; les IDs étant parcourus en ordre
+ *               croissant, un score égal au seuil perd toujours (ID plus grand)
+ * Complexité temps : O(log k) si retenue, O(1) sinon
+ */
+static void tk_offer(TopK* t, int id, int score){
+    if(t->size<t->cap){
+        t->h[t->size].station_id=id; t->h[t->size].score=score;
+        tk_up(t,t->size++);
+        if(t->size==t->cap) t->thr=t->h[0].score;
+        return;
+    }
+    if(score<=t->thr) return;
+    t->h[0].station_id=id; t->h[0].score=score;
+    tk_down(t,0);
+    t->thr=t->h[0].score;
+}
+
+/*
+ * Fonction auxiliaire : score_of
+ * Description : Score d'une ligne, en arithmétique modulo 2^32 comme les
+ *               noyaux vectoriels (identique au calcul entier sans débordement)
+ */
+static int score_of(const StationColumns* c, int i, int a, int b, int g){
+    unsigned s=(unsigned)c->slots[i]*(unsigned)a+(unsigned)c->power[i]*(unsigned)b-(unsigned)c->price[i]*(unsigned)g;
+    return (int)s;
+}
+
+/*
+ * Noyau scalaire : lignes [i, end)
+ */
+static void scan_scalar(const StationColumns* c, int i, int end, TopK* t, int a, int b, int g){
+    for(; i<end; i++){
+        int s=score_of(c,i,a,b,g);
+        if(s>t->thr) tk_offer(t,c->id[i],s);
+    }
+}
+
+#ifdef SC_HAVE_X86
+/*
+ * Noyau SSE4.1 : 4 scores par itération (_mm_mullo_epi32), comparaison au
+ * seuil en vectoriel ; seules les lignes qui le dépassent passent par le tas
+ */
+__attribute__((target("sse4.1")))
+static void scan_sse41(const StationColumns* c, int i, int end, TopK* t, int a, int b, int g){
+    const __m128i va=_mm_set1_epi32(a), vb=_mm_set1_epi32(b), vg=_mm_set1_epi32(g);
+    for(; i+4<=end; i+=4){
+        __m128i s=_mm_loadu_si128((const __m128i*)(c->slots+i));
+        __m128i p=_mm_loadu_si128((const __m128i*)(c->power+i));
+        __m128i q=_mm_loadu_si128((const __m128i*)(c->price+i));
+        __m128i sc=_mm_sub_epi32(_mm_add_epi32(_mm_mullo_epi32(s,va),_mm_mullo_epi32(p,vb)),_mm_mullo_epi32(q,vg));
+        int mask=_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(sc,_mm_set1_epi32(t->thr))));
+        if(!mask) continue;
+        int tmp[4];
+        _mm_storeu_si128((__m128i*)tmp,sc);
+        while(mask){
+            int j=__builtin_ctz((unsigned)mask);
+            mask&=mask-1;
+            if(tmp[j]>t->thr) tk_offer(t,c->id[i+j],tmp[j]);
+        }
+    }
+    scan_scalar(c,i,end,t,a,b,g);
+}
+
+/*
+ * Noyau AVX2 : 8 scores par itération
+ */
+__attribute__((target("avx2")))
+static void scan_avx2(const StationColumns* c, int i, int end, TopK* t, int a, int b, int g){
+    const __m256i va=_mm256_set1_epi32(a), vb=_mm256_set1_epi32(b), vg=_mm256_set1_epi32(g);
+    for(; i+8<=end; i+=8){
+        __m256i s=_mm256_loadu_si256((const __m256i*)(c->slots+i));
+        __m256i p=_mm256_loadu_si256((const __m256i*)(c->power+i));
+        __m256i q=_mm256_loadu_si256((const __m256i*)(c->price+i));
+        __m256i sc=_mm256_sub_epi32(_mm256_add_epi32(_mm256_mullo_epi32(s,va),_mm256_mullo_epi32(p,vb)),_mm256_mullo_epi32(q,vg));
+        int mask=_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(sc,_mm256_set1_epi32(t->thr))));
+        if(!mask) continue;
+        int tmp[8];
+        _mm256_storeu_si256((__m256i*)tmp,sc);
+        while(mask){
+            int j=__builtin_ctz((unsigned)mask);
+            mask&=mask-1;
+            if(tmp[j]>t->thr) tk_offer(t,c->id[i+j],tmp[j]);
+        }
+    }
+    scan_scalar(c,i,end,t,a,b,g);
+}
+#endif
+
+/*
+ * Fonction : sc_simd_best
+ * Description : Détection à l'exécution (CPUID) du meilleur noyau
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+ScSimd sc_simd_best(void){
+#ifdef SC_HAVE_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) return SC_SIMD_AVX2;
+    if(__builtin_cpu_supports("sse4.1")) return SC_SIMD_SSE41;
+#endif
+    return SC_SIMD_SCALAR;
+}
+
+/*
+ * Fonction auxiliaire : comparaison pour le classement final
+ * (score décroissant, puis ID croissant)
+ */
+static int cmp_ranked(const void* x, const void* y){
+    const ScRanked* a=(const ScRanked*)x;
+    const ScRanked* b=(const ScRanked*)y;
+    if(a->score!=b->score) return a->score>b->score ? -1 : 1;
+    return (a->station_id>b->station_id)-(a->station_id<b->station_id);
+}
+
+/*
+ * Fonction auxiliaire : top_k_rows
+ * Description : Top-k par score sur les lignes [lo, hi) : les k premières
+ *               lignes remplissent le tas, puis le noyau choisi calcule les
+ *               scores par blocs et ne compare au tas que ceux qui dépassent le
+ *               seuil courant (le k-ième meilleur score) - rare après les
+ *               premiers milliers de lignes
+ * Paramètres :
+ *   - out_ids : IDs classés (score décroissant, puis ID croissant)
+ *   - out_scores : scores correspondants (NULL accepté)
+ *   - level : noyau demandé (ramené au meilleur disponible)
+ * Retour : Nombre d'IDs écrits (min(k, hi - lo)), -1 si échec d'allocation
+ * Complexité temps : O(n + m log k + k log k), m = lignes retenues au passage
+ * Complexité espace : O(k)
+ */
+static int top_k_rows(const StationColumns* c, int lo, int hi, int k, int* out_ids, int* out_scores,
+                      int alpha, int beta, int gamma, ScSimd level){
+    if(lo<0) lo=0;
+    if(hi>c->n) hi=c->n;
+    if(k<=0 || !out_ids || lo>=hi) return 0;
+    if(k>hi-lo) k=hi-lo;
+    TopK t;
+    t.h=(ScRanked*)malloc(sizeof(ScRanked)*(size_t)k);
+    if(!t.h) return -1;
+    t.size=0; t.cap=k; t.thr=INT_MIN;
+    int i=lo;
+    for(; i<hi && t.size<t.cap; i++) tk_offer(&t,c->id[i],score_of(c,i,alpha,beta,gamma));
+
+    ScSimd best=sc_simd_best();
+    if(level>best) level=best;
+#ifdef SC_HAVE_X86
+    if(level==SC_SIMD_AVX2) scan_avx2(c,i,hi,&t,alpha,beta,gamma);
+    else if(level==SC_SIMD_SSE41) scan_sse41(c,i,hi,&t,alpha,beta,gamma);
+    else
+#endif
+    scan_scalar(c,i,hi,&t,alpha,beta,gamma);
+
+    qsort(t.h,(size_t)t.size,sizeof(ScRanked),cmp_ranked);
+    for(int j=0;j<t.size;j++){
+        out_ids[j]=t.h[j].station_id;
+        if(out_scores) out_scores[j]=t.h[j].score;
+    }
+    free(t.h);
+    return t.size;
+}
+
+/*
+ * Fonction : sc_top_k_level
+ * Description : top_k_rows sur toutes les lignes (0 si échec d'allocation)
+ * Complexité temps : voir top_k_rows - Complexité espace : O(k)
+ */
+int sc_top_k_level(const StationColumns* c, int k, int* out_ids,
+                   int alpha, int beta, int gamma, ScSimd level){
+    int count=top_k_rows(c,0,c->n,k,out_ids,0,alpha,beta,gamma,level);
+    return count<0 ? 0 : count;
+}
+
+/*
+ * Fonction : sc_top_k_rows
+ * Description : Top-k d'une tranche de lignes, avec les scores : une tâche
+ *               parallèle par tranche, fusion par l'appelant ; -1 si échec
+ *               d'allocation (à distinguer d'une tranche vide)
+ * Complexité temps : voir top_k_rows - Complexité espace : O(k)
+ */
+int sc_top_k_rows(const StationColumns* c, int lo, int hi, int k, int* out_ids, int* out_scores,
+                  int alpha, int beta, int gamma){
+    return top_k_rows(c,lo,hi,k,out_ids,out_scores,alpha,beta,gamma,SC_SIMD_AVX2);
+}
+
+/*
+ * Fonction : sc_count_ge_power_rows
+ * Description : Nombre de lignes de [lo, hi) de puissance >= P (boucle sans
+ *               branchement, vectorisée par le compilateur)
+ * Complexité temps : O(hi - lo) - Complexité espace : O(1)
+ */
+int sc_count_ge_power_rows(const StationColumns* c, int lo, int hi, int P){
+    if(lo<0) lo=0;
+    if(hi>c->n) hi=c->n;
+    int count=0;
+    for(int i=lo;i<hi;i++) count+=c->power[i]>=P;
+    return count;
+}
+
+/*
+ * Fonction : sc_top_k
+ * Complexité temps : voir sc_top_k_level - Complexité espace : O(k)
+ */
+int sc_top_k(const StationColumns* c, int k, int* out_ids, int alpha, int beta, int gamma){
+    return sc_top_k_level(c,k,out_ids,alpha,beta,gamma,SC_SIMD_AVX2);
+}
+
+/*
+ * Fonction : sc_clear
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+void sc_clear(StationColumns* c){
+    free(c->id); free(c->slots); free(c->power); free(c->price);
+    sc_init(c);
+}
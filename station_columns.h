@@ -0,0 +1,76 @@
+#ifndef DS_STATION_COLUMNS_H
+#define DS_STATION_COLUMNS_H
+#include "station_index.h"
+
+/*
+ * ============================================================================
+ * INSTANTANÉ COLONNAIRE DES STATIONS (STRUCTURE DE TABLEAUX)
+ * ============================================================================
+ *
+ * Copie des champs utilisés par le score, rangée colonne par colonne et triée
+ * par ID : id[i], slots[i], power[i], price[i] décrivent la i-ème station.
+ * Un parcours de score devient une lecture séquentielle de tableaux contigus,
+ * calculée par blocs de 8 (AVX2) ou 4 (SSE4.1) stations, avec repli scalaire.
+ * Tenue à jour par l'index (voir si_enable_columns) : une mise à jour d'une
+ * station existante réécrit sa ligne (recherche dichotomique), un ajout ou une
+ * suppression décale les colonnes ; un chargement en masse marque l'instantané
+ * à reconstruire.
+ */
+
+/* Jeux d'instructions du noyau de score (sc_top_k_level) */
+typedef enum ScSimd {
+    SC_SIMD_SCALAR = 0,     /* boucle scalaire portable */
+    SC_SIMD_SSE41 = 1,      /* 4 stations par itération */
+    SC_SIMD_AVX2 = 2        /* 8 stations par itération */
+} ScSimd;
+
+/* Instantané colonnaire */
+typedef struct StationColumns {
+    int n;          /* nombre de stations */
+    int cap;        /* capacité des colonnes */
+    int* id;        /* IDs croissants */
+    int* slots;     /* places libres */
+    int* power;     /* puissance (kW) */
+    int* price;     /* prix (centimes) */
+    int dirty;      /* 1 : à reconstruire depuis l'index avant usage */
+} StationColumns;
+
+/* Initialisation d'un instantané vide (à reconstruire) - O(1) */
+void sc_init(StationColumns* c);
+
+/* Reconstruction complète depuis l'index (AVL ou B+) - O(n)
+ * Retour : 1 si réussi, 0 si échec d'allocation (instantané marqué à reconstruire) */
+int sc_rebuild(StationColumns* c, const StationIndex* idx);
+
+/* Écriture de la ligne d'une station (ajoutée si absente) - O(log n), O(n) si ajout
+ * Retour : 1 si réussi, 0 si échec d'allocation (instantané marqué à reconstruire) */
+int sc_set(StationColumns* c, int id, const StationInfo* in);
+
+/* Retrait de la ligne d'une station - O(n). Retour : 1 si présente, 0 sinon */
+int sc_remove(StationColumns* c, int id);
+
+/* Jeu d'instructions le plus rapide disponible sur ce processeur - O(1) */
+ScSimd sc_simd_best(void);
+
+/* Top-k par score (même score, même ordre que si_top_k_by_score) avec le
+ * meilleur noyau disponible - O(n + k log k) en pratique */
+int sc_top_k(const StationColumns* c, int k, int* out_ids, int alpha, int beta, int gamma);
+
+/* Idem avec un noyau imposé (ramené au meilleur disponible) */
+int sc_top_k_level(const StationColumns* c, int k, int* out_ids,
+                   int alpha, int beta, int gamma, ScSimd level);
+
+/* Top-k des lignes [lo, hi) (tranche d'un parcours parallèle), classé comme
+ * sc_top_k, avec les scores dans out_scores (NULL accepté) - O(hi - lo + k log k).
+ * Retour : nombre d'IDs écrits, -1 si échec d'allocation (une tranche vide
+ * rend 0) */
+int sc_top_k_rows(const StationColumns* c, int lo, int hi, int k, int* out_ids, int* out_scores,
+                  int alpha, int beta, int gamma);
+
+/* Nombre de lignes [lo, hi) de puissance >= P - O(hi - lo) */
+int sc_count_ge_power_rows(const StationColumns* c, int lo, int hi, int P);
+
+/* Libération des colonnes - O(1) */
+void sc_clear(StationColumns* c);
+
+#endif
@@ -1,6 +1,15 @@
 #include "station_index.h"
+#include "bptree.h"
+#include "id_table.h"
+#include "key_index.h"
+#include "station_columns.h"
+#include "topk_view.h"
+#include "rule_sub.h"
+#include "geo_index.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <limits.h>
+#include <stdatomic.h>
 
 /*
  * Fonction auxiliaire : h (height)
@@ -10,30 +19,245 @@
  */
 static int h(StationNode* n){ return n? n->height : -1; }
 
+/*
+ * Fonction auxiliaire : sz (size)
+ * Description : Retourne le nombre de nœuds d'un sous-arbre (0 si NULL)
+ * Complexité temps : O(1)
+ * Complexité espace : O(1)
+ */
+static int sz(StationNode* n){ return n? n->size : 0; }
+
+/*
+ * Fonction auxiliaire : upd_aug (update augmented fields)
+ * Description : Recalcule les champs augmentés d'un nœud à partir de ses
+ *               enfants et de sa propre station, sans toucher à la hauteur :
+ *               taille, puissance max, prix min, places libres max et total
+ *               des places libres
+ * Retour : 1 si au moins un champ a changé, 0 sinon
+ * Complexité temps : O(1)
+ * Complexité espace : O(1)
+ */
+static int upd_aug(StationNode* n){
+    StationNode* l=n->left;
+    StationNode* r=n->right;
+    int size=sz(l)+sz(r)+1;
+    int maxp=n->info.power_kW, minc=n->info.price_cents, maxs=n->info.slots_free;
+    long long slots=n->info.slots_free;
+    if(l){
+        if(l->max_power>maxp) maxp=l->max_power;
+        if(l->min_price<minc) minc=l->min_price;
+        if(l->max_slots>maxs) maxs=l->max_slots;
+        slots+=l->sum_slots;
+    }
+    if(r){
+        if(r->max_power>maxp) maxp=r->max_power;
+        if(r->min_price<minc) minc=r->min_price;
+        if(r->max_slots>maxs) maxs=r->max_slots;
+        slots+=r->sum_slots;
+    }
+    int changed= size!=n->size || maxp!=n->max_power || minc!=n->min_price || maxs!=n->max_slots || slots!=n->sum_slots;
+    n->size=size; n->max_power=maxp; n->min_price=minc; n->max_slots=maxs; n->sum_slots=slots;
+    return changed;
+}
+
 /*
  * Fonction auxiliaire : upd (update height)
- * Description : Met à jour la hauteur d'un nœud après modification
+ * Description : Met à jour la hauteur et les champs augmentés d'un nœud
+ *               après modification
  * Complexité temps : O(1) - Lecture de 2 hauteurs et mise à jour
  * Complexité espace : O(1)
  */
 static void upd(StationNode* n){
     int hl=h(n->left), hr=h(n->right);
     n->height=(hl>hr?hl:hr)+1;
+    upd_aug(n);
+}
+
+/* Capacités minimale et maximale d'un slab (en nœuds) */
+#define POOL_FIRST_SLAB 64
+#define POOL_MAX_SLAB   65536
+
+/*
+ * Fonction auxiliaire : pool_init
+ * Description : Initialise un allocateur de nœuds vide (aucun slab alloué)
+ * Complexité temps : O(1)
+ * Complexité espace : O(1)
+ */
+static void pool_init(NodePool* p){
+    p->slabs=0; p->free_list=0; p->next_cap=POOL_FIRST_SLAB;
+}
+
+/*
+ * Fonction auxiliaire : pool_alloc
+ * Description : Fournit un nœud : d'abord depuis la liste libre, sinon depuis
+ *               le slab courant ; un nouveau slab (taille doublée jusqu'à
+ *               POOL_MAX_SLAB) est alloué quand le courant est plein.
+ *               Les nœuds consécutifs sont ainsi contigus en mémoire.
+ * Complexité temps : O(1) amorti - un malloc par slab au lieu d'un par nœud
+ * Complexité espace : O(1) amorti
+ */
+static StationNode* pool_alloc(NodePool* p){
+    if(p->free_list){
+        StationNode* n=p->free_list;
+        p->free_list=n->left;
+        return n;
+    }
+    if(!p->slabs || p->slabs->used==p->slabs->cap){
+        int cap=p->next_cap;
+        NodeSlab* s=(NodeSlab*)malloc(sizeof*s + (size_t)cap*sizeof(StationNode));
+        if(!s) return 0;
+        s->next=p->slabs; s->used=0; s->cap=cap;
+        p->slabs=s;
+        if(p->next_cap<POOL_MAX_SLAB) p->next_cap*=2;
+    }
+    return &p->slabs->nodes[p->slabs->used++];
+}
+
+/*
+ * Fonction auxiliaire : pool_release
+ * Description : Rend un nœud à la liste libre (réutilisé par la prochaine insertion)
+ * Complexité temps : O(1)
+ * Complexité espace : O(1)
+ */
+static void pool_release(NodePool* p, StationNode* n){
+    n->left=p->free_list;
+    p->free_list=n;
+}
+
+/*
+ * Fonction auxiliaire : pool_destroy
+ * Description : Libère tous les slabs d'un coup, sans parcourir l'arbre
+ * Complexité temps : O(S) où S = nombre de slabs (≈ n / POOL_MAX_SLAB + 10)
+ * Complexité espace : O(1)
+ */
+static void pool_destroy(NodePool* p){
+    while(p->slabs){
+        NodeSlab* s=p->slabs;
+        p->slabs=s->next;
+        free(s);
+    }
+    pool_init(p);
+}
+
+/*
+ * Mode persistant (copie de chemin)
+ * Les nœuds publiés ne sont jamais modifiés : l'écrivain travaille sur des
+ * copies (version == wver) qu'il peut modifier librement jusqu'à si_publish.
+ * Un nœud remplacé est mis en attente avec l'époque de la version qui ne le
+ * contient plus ; il est recyclé quand tous les lecteurs ont annoncé une
+ * époque au moins égale (récupération par époques).
+ */
+
+/* Nœud remplacé en attente de recyclage */
+typedef struct SiRetired {
+    StationNode* node;          /* nœud absent des versions >= epoch */
+    unsigned long long epoch;   /* première version qui ne le contient plus */
+} SiRetired;
+
+/* Case d'un lecteur : libre, réservée, ou époque annoncée */
+#define SLOT_FREE    0ULL
+#define SLOT_CLAIMED ULLONG_MAX
+
+/* Taille d'une ligne de cache : chaque lecteur écrit dans sa propre ligne */
+#define SI_CACHE_LINE 64
+
+/* Case d'un lecteur, seule sur sa ligne de cache (pas de faux partage) */
+typedef struct SiSlot {
+    _Alignas(SI_CACHE_LINE) atomic_ullong epoch;
+} SiSlot;
+
+/* État partagé du mode persistant */
+struct SiPersist {
+    unsigned long long wver;                       /* version en écriture (epoch + 1) */
+    SiRetired* retired;                            /* nœuds en attente (époques croissantes) */
+    int nretired, cap_retired;
+    _Alignas(SI_CACHE_LINE) _Atomic(StationNode*) root; /* racine publiée */
+    atomic_ullong epoch;                           /* version publiée */
+    SiSlot slots[SI_MAX_READERS];                  /* époques des lecteurs */
+};
+
+/*
+ * Fonction auxiliaire : retire
+ * Description : Met un nœud publié en attente de recyclage
+ * Retour : 1 si réussi, 0 si échec d'allocation (le nœud n'est alors jamais
+ *          recyclé : fuite bornée, mais aucun lecteur ne peut être lésé)
+ * Complexité temps : O(1) amorti - Complexité espace : O(1) amorti
+ */
+static int retire(struct SiPersist* ps, StationNode* n){
+    if(ps->nretired==ps->cap_retired){
+        int cap= ps->cap_retired ? 2*ps->cap_retired : 256;
+        SiRetired* r=(SiRetired*)realloc(ps->retired,sizeof(SiRetired)*(size_t)cap);
+        if(!r) return 0;
+        ps->retired=r; ps->cap_retired=cap;
+    }
+    ps->retired[ps->nretired].node=n;
+    ps->retired[ps->nretired].epoch=ps->wver;
+    ps->nretired++;
+    return 1;
+}
+
+/*
+ * Fonction auxiliaire : cow (copy on write)
+ * Description : Retourne un nœud modifiable équivalent à n : n lui-même hors
+ *               mode persistant ou s'il a été créé par la version en cours
+ *               d'écriture, sinon une copie (n est mis en attente de recyclage)
+ * Retour : Nœud modifiable, ou NULL si échec d'allocation (n intact)
+ * Complexité temps : O(1) amorti - Complexité espace : O(1)
+ */
+static StationNode* cow(StationIndex* idx, StationNode* n){
+    struct SiPersist* ps=idx->persist;
+    if(!ps || n->version==(unsigned)ps->wver) return n;
+    StationNode* c=pool_alloc(&idx->pool);
+    if(!c) return 0;
+    if(!retire(ps,n)){ pool_release(&idx->pool,c); return 0; }
+    *c=*n;
+    c->version=(unsigned)ps->wver;
+    return c;
+}
+
+/*
+ * Fonction auxiliaire : cow_at
+ * Description : Rend modifiable le nœud pointé par un lien et y raccroche la
+ *               copie éventuelle (le lien doit lui-même être modifiable)
+ * Retour : Nœud modifiable, ou NULL si échec d'allocation
+ * Complexité temps : O(1) amorti - Complexité espace : O(1)
+ */
+static StationNode* cow_at(StationIndex* idx, StationNode** link){
+    if(!idx->persist) return *link;
+    StationNode* c=cow(idx,*link);
+    if(c) *link=c;
+    return c;
+}
+
+/*
+ * Fonction auxiliaire : drop
+ * Description : Libère un nœud retiré de l'arbre : immédiatement s'il n'a
+ *               jamais été publié, après les lecteurs sinon
+ * Complexité temps : O(1) amorti - Complexité espace : O(1)
+ */
+static void drop(StationIndex* idx, StationNode* n){
+    struct SiPersist* ps=idx->persist;
+    if(ps && n->version!=(unsigned)ps->wver) retire(ps,n);
+    else pool_release(&idx->pool,n);
 }
 
 /*
  * Fonction auxiliaire : mk (make node)
- * Description : Crée un nouveau nœud de station
+ * Description : Crée un nouveau nœud de station depuis l'allocateur de l'index
+ *               (en mode persistant, le nœud appartient à la version en cours)
  * Paramètres :
+ *   - idx : index (allocateur de nœuds, version en écriture)
  *   - id : identifiant de la station
  *   - in : informations de la station (puissance, prix, slots, timestamp)
- * Complexité temps : O(1) - Allocation et initialisation
+ * Complexité temps : O(1) amorti - Allocation dans le slab et initialisation
  * Complexité espace : O(1) - Un seul nœud alloué
  */
-static StationNode* mk(int id, StationInfo in){
-    StationNode* n=(StationNode*)malloc(sizeof*n);
+static StationNode* mk(StationIndex* idx, int id, StationInfo in){
+    StationNode* n=pool_alloc(&idx->pool);
     if(!n) return 0;
-    n->station_id=id; n->info=in; n->left=n->right=0; n->height=0;
+    n->station_id=id; n->version= idx->persist ? (unsigned)idx->persist->wver : 0u; n->info=in; n->left=n->right=0; n->height=0;
+    n->size=1; n->max_power=in.power_kW; n->min_price=in.price_cents; n->max_slots=in.slots_free;
+    n->sum_slots=in.slots_free;
     return n;
 }
 
@@ -71,25 +295,35 @@ static StationNode* rotL(StationNode* x){
  * Fonction : rebalance
  * Description : Rééquilibre un nœud si son facteur d'équilibre est invalide (|bf| > 1)
  *               Effectue une rotation simple ou double selon le cas
- * Paramètre :
+ *               En mode persistant, les enfants modifiés par les rotations
+ *               sont d'abord recopiés (n doit déjà être modifiable) ; faute
+ *               de mémoire, le nœud reste déséquilibré mais l'arbre valide
+ * Paramètres :
+ *   - idx : index (copie des nœuds en mode persistant)
  *   - n : nœud à rééquilibrer
  * Retour : Nouvelle racine du sous-arbre après rééquilibrage
  * Complexité temps : O(1) - Maximum 2 rotations
  * Complexité espace : O(1) - Pas d'allocation supplémentaire
  */
-static StationNode* rebalance(StationNode* n){
+static StationNode* rebalance(StationIndex* idx, StationNode* n){
     upd(n);
     int bf=h(n->left)-h(n->right);
     // Cas gauche-gauche ou gauche-droite
     if(bf>1){
-        if(h(n->left->right)>h(n->left->left))
+        if(!cow_at(idx,&n->left)) return n;
+        if(h(n->left->right)>h(n->left->left)){
+            if(!cow_at(idx,&n->left->right)) return n;
             n->left=rotL(n->left); // Rotation gauche-droite (double rotation)
+        }
         return rotR(n);
     }
     // Cas droite-droite ou droite-gauche
     if(bf<-1){
-        if(h(n->right->left)>h(n->right->right))
+        if(!cow_at(idx,&n->right)) return n;
+        if(h(n->right->left)>h(n->right->right)){
+            if(!cow_at(idx,&n->right->left)) return n;
             n->right=rotR(n->right); // Rotation droite-gauche (double rotation)
+        }
         return rotL(n);
     }
     return n;
@@ -97,13 +331,595 @@ static StationNode* rebalance(StationNode* n){
 
 /*
  * Fonction : si_init
- * Description : Initialise un index de stations vide
+ * Description : Initialise un index de stations vide (backend AVL)
  * Paramètre :
  *   - idx : pointeur vers la structure StationIndex
  * Complexité temps : O(1)
  * Complexité espace : O(1)
  */
-void si_init(StationIndex* idx){ idx->root=0; }
+void si_init(StationIndex* idx){ si_init_backend(idx,SI_BACKEND_AVL); }
+
+/*
+ * Fonction : si_init_backend
+ * Description : Initialise un index vide en choisissant sa structure :
+ *               SI_BACKEND_AVL (défaut) ou SI_BACKEND_BPTREE (arbre B+).
+ *               Le backend B+ répond aux fonctions *_idx, à si_add, si_delete,
+ *               si_build_sorted et si_clear ; les fonctions qui prennent une
+ *               racine StationNode* (parcours de l'AVL) voient un arbre vide.
+ * Paramètres :
+ *   - idx : pointeur vers la structure StationIndex
+ *   - backend : structure à utiliser
+ * Complexité temps : O(1) - L'arbre B+ est alloué à la première insertion
+ * Complexité espace : O(1)
+ */
+void si_init_backend(StationIndex* idx, SiBackend backend){
+    idx->root=0;
+    pool_init(&idx->pool);
+    idx->backend=backend;
+    idx->bp=0;
+    idx->lookup=0;
+    idx->persist=0;
+    idx->attr=0;
+    idx->cols=0;
+    idx->views=0;
+    idx->geo=0;
+    idx->subs=0;
+    static atomic_uint next_uid;
+    idx->uid=atomic_fetch_add_explicit(&next_uid,1u,memory_order_relaxed);
+    idx->version=0;
+    idx->range_ver=0;
+}
+
+/*
+ * Fonction auxiliaire : bp_tree
+ * Description : Retourne l'arbre B+ de l'index, en le créant si besoin
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+static BPTree* bp_tree(StationIndex* idx){
+    if(!idx->bp){
+        idx->bp=(BPTree*)malloc(sizeof(BPTree));
+        if(idx->bp) bp_init(idx->bp);
+    }
+    return idx->bp;
+}
+
+/*
+ * Fonction auxiliaire : lookup_drop
+ * Description : Désactive la table de recherche (échec d'allocation lors de
+ *               sa mise à jour) : les recherches repassent par l'arbre
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+static void lookup_drop(StationIndex* idx){
+    if(!idx->lookup) return;
+    it_clear(idx->lookup);
+    free(idx->lookup);
+    idx->lookup=0;
+}
+
+/*
+ * Fonction auxiliaire : lookup_put
+ * Description : Enregistre un nœud dans la table de recherche si elle est active
+ * Complexité temps : O(1) amorti - Complexité espace : O(1) amorti
+ */
+static void lookup_put(StationIndex* idx, StationNode* n){
+    if(idx->lookup && !it_put(idx->lookup,n->station_id,n)) lookup_drop(idx);
+}
+
+/*
+ * Fonction auxiliaire récursive : lookup_fill
+ * Description : Enregistre tous les nœuds d'un sous-arbre AVL (ordre in-order :
+ *               IDs croissants, la plage directe s'étend d'un seul côté)
+ * Retour : 1 si réussi, 0 si échec d'allocation
+ * Complexité temps : O(n) - Complexité espace : O(log n)
+ */
+static int lookup_fill(IdTable* t, StationNode* r){
+    if(!r) return 1;
+    return lookup_fill(t,r->left) && it_put(t,r->station_id,r) && lookup_fill(t,r->right);
+}
+
+/*
+ * Fonction : si_enable_lookup
+ * Description : Active une table ID → nœud (accès direct pour les plages
+ *               d'IDs compactes, hachage sinon) à côté de l'arbre, quel que soit
+ *               le backend. Elle est remplie avec les stations déjà présentes
+ *               puis tenue à jour par si_add, si_update, si_delete et
+ *               si_build_sorted : si_find_idx y lit directement le nœud au lieu
+ *               de descendre l'arbre. Les nœuds n'étant jamais déplacés (pool,
+ *               suppression par raccrochage), les pointeurs restent valides.
+ *               En cas d'échec d'allocation lors d'une mise à jour, la table
+ *               est abandonnée et les recherches repassent par l'arbre.
+ *               si_clear libère la table (à réactiver après réutilisation).
+ *               Incompatible avec le mode persistant (les nœuds y changent
+ *               d'adresse à chaque écriture).
+ * Paramètre :
+ *   - idx : index des stations
+ * Retour : 1 si la table est active, 0 si échec d'allocation
+ * Complexité temps : O(n) - Une insertion O(1) amorti par station existante
+ * Complexité espace : O(n) - Environ un pointeur par ID de la plage directe
+ */
+int si_enable_lookup(StationIndex* idx){
+    if(idx->lookup) return 1;
+    if(idx->persist) return 0;
+    IdTable* t=(IdTable*)malloc(sizeof(IdTable));
+    if(!t) return 0;
+    it_init(t);
+    int ok=1;
+    if(idx->backend==SI_BACKEND_BPTREE){
+        BPNode* leaf= idx->bp ? idx->bp->root : 0;
+        while(leaf && !leaf->is_leaf) leaf=leaf->children[0];
+        for(; leaf && ok; leaf=leaf->leaf.next)
+            for(int i=0;i<leaf->nkeys && ok;i++) ok=it_put(t,leaf->keys[i],leaf->leaf.recs[i]);
+    }
+    else ok=lookup_fill(t,idx->root);
+    if(!ok){ it_clear(t); free(t); return 0; }
+    idx->lookup=t;
+    return 1;
+}
+
+/*
+ * Fonction auxiliaire : attr_drop
+ * Description : Libère les index secondaires (désactivation, ou échec
+ *               d'allocation lors de leur mise à jour)
+ * Complexité temps : O(n) - Complexité espace : O(1)
+ */
+static void attr_drop(StationIndex* idx){
+    if(!idx->attr) return;
+    for(int a=0;a<SI_ATTR_COUNT;a++) ki_clear(&idx->attr[a]);
+    free(idx->attr);
+    idx->attr=0;
+}
+
+/*
+ * Fonction auxiliaire : attr_key
+ * Description : Valeur d'un attribut indexé
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+static int attr_key(const StationInfo* in, int a){
+    return a==SI_ATTR_POWER ? in->power_kW : in->price_cents;
+}
+
+/*
+ * Fonction auxiliaire : attr_change
+ * Description : Répercute la modification d'une station sur les index
+ *               secondaires actifs : couple retiré si la station disparaît ou
+ *               si la valeur change, ajouté si elle apparaît ou change.
+ *               Une mise à jour qui ne touche que les places libres (cas des
+ *               événements) ne coûte qu'une comparaison.
+ * Paramètres :
+ *   - idx : index des stations
+ *   - id : identifiant de la station
+ *   - old : informations avant (NULL : station créée)
+ *   - in : informations après (NULL : station supprimée)
+ * Complexité temps : O(log n) - Complexité espace : O(1)
+ */
+static void attr_change(StationIndex* idx, int id, const StationInfo* old, const StationInfo* in){
+    if(!idx->attr) return;
+    for(int a=0;a<SI_ATTR_COUNT;a++){
+        if(old && in && attr_key(old,a)==attr_key(in,a)) continue;
+        if(old) ki_delete(&idx->attr[a],attr_key(old,a),id);
+        if(in && !ki_insert(&idx->attr[a],attr_key(in,a),id)){ attr_drop(idx); return; }
+    }
+}
+
+/*
+ * Fonction auxiliaire : cols_drop
+ * Description : Libère l'instantané colonnaire
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+static void cols_drop(StationIndex* idx){
+    if(!idx->cols) return;
+    sc_clear(idx->cols);
+    free(idx->cols);
+    idx->cols=0;
+}
+
+/*
+ * Fonction auxiliaire : ver_block
+ * Description : Bloc d'IDs d'un ID (ordre des IDs conservé, négatifs compris)
+ */
+static unsigned ver_block(int id){ return ((unsigned)id^0x80000000u)>>SI_VER_SHIFT; }
+
+/*
+ * Fonction auxiliaire : ver_touch
+ * Description : Date le compteur du bloc de l'ID. range_ver est un arbre des
+ *               maxima (feuilles en [SI_VER_RANGES, 2 * SI_VER_RANGES)) ; la
+ *               version courante dépasse toutes les autres, elle est donc
+ *               écrite telle quelle sur tout le chemin vers la racine.
+ * Complexité temps : O(log SI_VER_RANGES) - Complexité espace : O(1)
+ */
+static void ver_touch(StationIndex* idx, int id){
+    for(unsigned i=SI_VER_RANGES+(ver_block(id)&(SI_VER_RANGES-1)); i>=1; i>>=1) idx->range_ver[i]=idx->version;
+}
+
+/*
+ * Fonction auxiliaire : on_change
+ * Description : Répercute la modification d'une station sur les structures
+ *               annexes actives : index secondaires, vues top-k enregistrées,
+ *               index géographique, abonnements aux règles (notifications)
+ *               et instantané colonnaire (ligne réécrite,
+ *               insérée ou retirée ; rien si l'instantané est déjà à
+ *               reconstruire) ; date l'écriture (version de l'index et de
+ *               la plage d'IDs de la station)
+ * Paramètres : comme attr_change
+ * Complexité temps : O(log n), O(n) pour l'ajout ou le retrait d'une ligne
+ * Complexité espace : O(1)
+ */
+static void on_change(StationIndex* idx, int id, const StationInfo* old, const StationInfo* in){
+    idx->version++;
+    if(idx->range_ver) ver_touch(idx,id);
+    attr_change(idx,id,old,in);
+    for(TopKView* v=idx->views; v; v=v->next) tv_change(v,id,old,in);
+    if(idx->geo) geo_set(idx->geo,id,in);
+    if(idx->subs) rs_change(idx->subs,id,old,in);
+    StationColumns* c=idx->cols;
+    if(!c || c->dirty) return;
+    if(in) sc_set(c,id,in);
+    else sc_remove(c,id);
+}
+
+/*
+ * Fonction : si_enable_columns
+ * Description : Active un instantané colonnaire des champs de score (une
+ *               colonne contiguë par champ, triée par ID), tenu à jour par
+ *               si_add, si_update, si_delete (tous backends) ; un chargement
+ *               en masse le marque à reconstruire (O(n), à la requête suivante).
+ *               si_top_k_idx y calcule les scores par blocs SIMD au lieu de
+ *               parcourir l'arbre. En mode persistant, réservé au thread
+ *               écrivain. si_clear le libère.
+ * Paramètre :
+ *   - idx : index des stations
+ * Retour : 1 si l'instantané est actif, 0 si échec d'allocation
+ * Complexité temps : O(n) - Complexité espace : O(n) - 16 octets par station
+ */
+int si_enable_columns(StationIndex* idx){
+    if(idx->cols) return 1;
+    StationColumns* c=(StationColumns*)malloc(sizeof(StationColumns));
+    if(!c) return 0;
+    sc_init(c);
+    if(!sc_rebuild(c,idx)){ sc_clear(c); free(c); return 0; }
+    idx->cols=c;
+    return 1;
+}
+
+/*
+ * Fonction : si_enable_versions
+ * Description : Alloue les compteurs de version par plage d'IDs, tous datés
+ *               de la version courante (une écriture antérieure ne peut pas
+ *               être attribuée à une plage) ; chaque écriture date ensuite le
+ *               bloc de sa station. si_clear les libère.
+ * Retour : 1 si actives, 0 si échec d'allocation
+ * Complexité temps : O(SI_VER_RANGES) - Complexité espace : 16 Kio
+ */
+int si_enable_versions(StationIndex* idx){
+    if(idx->range_ver) return 1;
+    unsigned long long* t=(unsigned long long*)malloc(sizeof(unsigned long long)*2*SI_VER_RANGES);
+    if(!t) return 0;
+    for(int i=0;i<2*SI_VER_RANGES;i++) t[i]=idx->version;
+    idx->range_ver=t;
+    return 1;
+}
+
+/*
+ * Fonction auxiliaire : ver_max
+ * Description : Maximum des compteurs [a, b] (a <= b) de l'arbre des maxima
+ * Complexité temps : O(log SI_VER_RANGES) - Complexité espace : O(1)
+ */
+static unsigned long long ver_max(const unsigned long long* t, unsigned a, unsigned b){
+    unsigned long long m=0;
+    for(a+=SI_VER_RANGES, b+=SI_VER_RANGES+1; a<b; a>>=1, b>>=1){
+        if(a&1){ if(t[a]>m) m=t[a]; a++; }
+        if(b&1){ b--; if(t[b]>m) m=t[b]; }
+    }
+    return m;
+}
+
+/*
+ * Fonction : si_range_version
+ * Description : Dernière date d'écriture des blocs qui couvrent [lo, hi] ;
+ *               une plage de SI_VER_RANGES blocs ou plus voit tous les
+ *               compteurs, sinon un ou deux intervalles de compteurs (la
+ *               plage peut boucler sur SI_VER_RANGES)
+ * Complexité temps : O(log SI_VER_RANGES) - Complexité espace : O(1)
+ */
+unsigned long long si_range_version(const StationIndex* idx, int lo, int hi){
+    if(!idx->range_ver) return idx->version;
+    if(lo>hi) return 0;
+    unsigned blo=ver_block(lo), bhi=ver_block(hi);
+    if(bhi-blo>=SI_VER_RANGES-1) return idx->range_ver[1];
+    unsigned a=blo&(SI_VER_RANGES-1), b=bhi&(SI_VER_RANGES-1);
+    if(a<=b) return ver_max(idx->range_ver,a,b);
+    unsigned long long x=ver_max(idx->range_ver,a,SI_VER_RANGES-1), y=ver_max(idx->range_ver,0,b);
+    return x>y ? x : y;
+}
+
+/*
+ * Fonction auxiliaire : geo_drop
+ * Description : Libère l'index géographique
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+static void geo_drop(StationIndex* idx){
+    if(!idx->geo) return;
+    geo_clear(idx->geo);
+    free(idx->geo);
+    idx->geo=0;
+}
+
+/*
+ * Fonction : si_enable_geo
+ * Description : Construit l'index géographique (arbre k-d) des positions
+ *               données, avec places libres et puissance lues dans l'index ;
+ *               si_add, si_update, si_delete et si_build_sorted les tiennent
+ *               à jour (tous backends). Les positions sont figées : une
+ *               station sans position n'est pas trouvée par les requêtes
+ *               géographiques, il faut rappeler si_enable_geo pour l'y
+ *               ajouter (la nouvelle construction remplace l'ancienne).
+ *               En mode persistant, réservé au thread écrivain. si_clear le
+ *               libère.
+ * Paramètres :
+ *   - idx : index des stations
+ *   - pts : positions (doublons d'ID : la dernière gagne)
+ *   - n : nombre de positions
+ * Retour : 1 si l'index est actif, 0 si échec d'allocation (index précédent
+ *          conservé)
+ * Complexité temps : O(n log n) - Complexité espace : O(n) - 53 octets par position
+ */
+int si_enable_geo(StationIndex* idx, const GeoPoint* pts, int n){
+    GeoIndex* g=idx->geo;
+    if(!g){
+        g=(GeoIndex*)malloc(sizeof(GeoIndex));
+        if(!g) return 0;
+        geo_init(g);
+    }
+    if(!geo_build(g,pts,n,idx)){
+        if(!idx->geo) free(g);
+        return 0;
+    }
+    idx->geo=g;
+    return 1;
+}
+
+/*
+ * Fonction auxiliaire récursive : attr_fill
+ * Description : Ajoute toutes les stations d'un sous-arbre AVL aux index secondaires
+ * Retour : 1 si réussi, 0 si échec d'allocation
+ * Complexité temps : O(n log n) - Complexité espace : O(log n)
+ */
+static int attr_fill(KeyIndex* ki, StationNode* r){
+    if(!r) return 1;
+    for(int a=0;a<SI_ATTR_COUNT;a++)
+        if(!ki_insert(&ki[a],attr_key(&r->info,a),r->station_id)) return 0;
+    return attr_fill(ki,r->left) && attr_fill(ki,r->right);
+}
+
+/*
+ * Fonction : si_enable_attr_index
+ * Description : Active deux index secondaires ordonnés, (power_kW, ID) et
+ *               (price_cents, ID), remplis avec les stations présentes puis
+ *               tenus à jour par si_add, si_update, si_delete et
+ *               si_build_sorted (tous backends, mode persistant compris).
+ *               Les requêtes par attribut (si_attr_count, si_attr_range_ids,
+ *               si_count_ge_power_idx) les utilisent quand ils sont actifs.
+ *               En cas d'échec d'allocation lors d'une mise à jour, ils sont
+ *               abandonnés (les requêtes repassent par un parcours complet).
+ *               si_clear les libère.
+ * Paramètre :
+ *   - idx : index des stations
+ * Retour : 1 si les index sont actifs, 0 si échec d'allocation
+ * Complexité temps : O(n log n) - Complexité espace : O(n)
+ */
+int si_enable_attr_index(StationIndex* idx){
+    if(idx->attr) return 1;
+    KeyIndex* ki=(KeyIndex*)malloc(sizeof(KeyIndex)*SI_ATTR_COUNT);
+    if(!ki) return 0;
+    for(int a=0;a<SI_ATTR_COUNT;a++) ki_init(&ki[a]);
+    int ok=1;
+    if(idx->backend==SI_BACKEND_BPTREE){
+        BPNode* leaf= idx->bp ? idx->bp->root : 0;
+        while(leaf && !leaf->is_leaf) leaf=leaf->children[0];
+        for(; leaf && ok; leaf=leaf->leaf.next)
+            for(int i=0;i<leaf->nkeys && ok;i++)
+                for(int a=0;a<SI_ATTR_COUNT && ok;a++)
+                    ok=ki_insert(&ki[a],attr_key(&leaf->leaf.recs[i]->info,a),leaf->keys[i]);
+    }
+    else ok=attr_fill(ki,idx->root);
+    idx->attr=ki;
+    if(!ok){ attr_drop(idx); return 0; }
+    return 1;
+}
+
+/*
+ * Fonction auxiliaire récursive : view_fill
+ * Description : Ajoute toutes les stations d'un sous-arbre AVL à une vue
+ * Retour : 1 si réussi, 0 si échec d'allocation
+ * Complexité temps : O(n log n) - Complexité espace : O(log n)
+ */
+static int view_fill(TopKView* v, StationNode* r){
+    if(!r) return 1;
+    return tv_change(v,r->station_id,0,&r->info) && view_fill(v,r->left) && view_fill(v,r->right);
+}
+
+/*
+ * Fonction auxiliaire : view_build
+ * Description : (Re)construit une vue depuis les stations de l'index
+ * Retour : 1 si réussi, 0 si échec d'allocation (vue marquée à reconstruire)
+ * Complexité temps : O(n log n) - Complexité espace : O(log n)
+ */
+static int view_build(const StationIndex* idx, TopKView* v){
+    tv_clear(v);
+    v->dirty=0;
+    if(idx->backend!=SI_BACKEND_BPTREE) return view_fill(v,idx->root);
+    BPNode* leaf= idx->bp ? idx->bp->root : 0;
+    while(leaf && !leaf->is_leaf) leaf=leaf->children[0];
+    for(; leaf; leaf=leaf->leaf.next)
+        for(int i=0;i<leaf->nkeys;i++)
+            if(!tv_change(v,leaf->keys[i],0,&leaf->leaf.recs[i]->info)) return 0;
+    return 1;
+}
+
+/*
+ * Fonction : si_view_register
+ * Description : Enregistre une vue top-k pour des poids fixés : remplie avec
+ *               les stations présentes, puis tenue à jour par si_add,
+ *               si_update, si_delete et si_build_sorted (tous backends) -
+ *               O(log n) par station modifiée. Elle appartient à l'index :
+ *               si_view_unregister ou si_clear la libère.
+ * Paramètres :
+ *   - idx : index des stations
+ *   - k : nombre de stations lues par si_view_read
+ *   - alpha, beta, gamma : poids du score (comme si_top_k_by_score)
+ * Retour : Vue, ou NULL si échec d'allocation
+ * Complexité temps : O(n log n) - Complexité espace : O(n)
+ */
+TopKView* si_view_register(StationIndex* idx, int k, int alpha, int beta, int gamma){
+    TopKView* v=(TopKView*)malloc(sizeof(TopKView));
+    if(!v) return 0;
+    tv_init(v,k,alpha,beta,gamma);
+    if(!view_build(idx,v)){ tv_clear(v); free(v); return 0; }
+    v->next=idx->views;
+    idx->views=v;
+    return v;
+}
+
+/*
+ * Fonction : si_view_read
+ * Description : Top-k courant de la vue (mêmes IDs, même ordre que
+ *               si_top_k_by_score avec ses poids). Une vue abandonnée après un
+ *               échec d'allocation est reconstruite ici.
+ * Retour : Nombre d'IDs écrits (min(k, nb_stations)), 0 si échec d'allocation
+ * Complexité temps : O(log n + k), O(n log n) si reconstruction
+ * Complexité espace : O(log n)
+ */
+int si_view_read(StationIndex* idx, TopKView* v, int* out_ids){
+    if(v->dirty && !view_build(idx,v)) return 0;
+    return tv_read(v,out_ids);
+}
+
+/*
+ * Fonction : si_view_unregister
+ * Description : Retire une vue de l'index et la libère
+ * Complexité temps : O(n + V), V = nombre de vues - Complexité espace : O(log n)
+ */
+void si_view_unregister(StationIndex* idx, TopKView* v){
+    for(TopKView** p=&idx->views; *p; p=&(*p)->next){
+        if(*p!=v) continue;
+        *p=v->next;
+        tv_clear(v);
+        free(v);
+        return;
+    }
+}
+
+/*
+ * Fonction : si_enable_persistent
+ * Description : Active le mode persistant (backend AVL uniquement).
+ *               Les écritures (si_add, si_update, si_delete, si_build_sorted)
+ *               ne modifient plus aucun nœud publié : chaque nœud du chemin
+ *               touché (et les enfants déplacés par une rotation) est recopié
+ *               une fois par version, le reste de l'arbre est partagé.
+ *               idx->root est la version de travail de l'écrivain ;
+ *               si_publish la rend visible aux lecteurs.
+ *               Un seul thread écrit ; les lecteurs (autres threads) passent
+ *               par si_snapshot_acquire / si_snapshot_release.
+ *               La table de recherche (si_enable_lookup) est désactivée.
+ * Paramètre :
+ *   - idx : index des stations (backend AVL, vide ou non)
+ * Retour : 1 si le mode est actif, 0 sinon (backend B+ ou échec d'allocation)
+ * Complexité temps : O(1) - Complexité espace : O(SI_MAX_READERS) lignes de cache
+ */
+int si_enable_persistent(StationIndex* idx){
+    if(idx->persist) return 1;
+    if(idx->backend!=SI_BACKEND_AVL) return 0;
+    struct SiPersist* ps=(struct SiPersist*)aligned_alloc(SI_CACHE_LINE,sizeof(struct SiPersist));
+    if(!ps) return 0;
+    lookup_drop(idx);
+    atomic_init(&ps->root,idx->root);
+    atomic_init(&ps->epoch,1ULL);
+    for(int i=0;i<SI_MAX_READERS;i++) atomic_init(&ps->slots[i].epoch,SLOT_FREE);
+    ps->wver=2;
+    ps->retired=0; ps->nretired=0; ps->cap_retired=0;
+    idx->persist=ps;
+    return 1;
+}
+
+/*
+ * Fonction : si_publish
+ * Description : Publie la version de travail : la racine puis l'époque sont
+ *               écrites atomiquement, les lecteurs qui prennent un snapshot
+ *               ensuite voient toutes les écritures précédentes, d'un bloc.
+ *               Les nœuds en attente dont l'époque de retrait ne dépasse pas
+ *               la plus petite époque annoncée par un lecteur sont ensuite
+ *               recyclés (aucun snapshot ne peut plus les atteindre).
+ *               Publier après un lot d'écritures (ex : chaque lot d'événements)
+ *               amortit les copies : un nœud n'est recopié qu'une fois par version.
+ *               Sans effet hors mode persistant.
+ * Paramètre :
+ *   - idx : index des stations (thread écrivain)
+ * Complexité temps : O(SI_MAX_READERS + R) - R = nœuds en attente
+ * Complexité espace : O(1)
+ */
+void si_publish(StationIndex* idx){
+    struct SiPersist* ps=idx->persist;
+    if(!ps) return;
+    atomic_store(&ps->root,idx->root);
+    atomic_store(&ps->epoch,ps->wver);
+    unsigned long long safe=ps->wver;
+    ps->wver++;
+
+    // Plus petite époque annoncée (une case réservée annoncera au moins safe)
+    for(int i=0;i<SI_MAX_READERS;i++){
+        unsigned long long e=atomic_load(&ps->slots[i].epoch);
+        if(e!=SLOT_FREE && e!=SLOT_CLAIMED && e<safe) safe=e;
+    }
+    int k=0;
+    while(k<ps->nretired && ps->retired[k].epoch<=safe) pool_release(&idx->pool,ps->retired[k++].node);
+    for(int i=k;i<ps->nretired;i++) ps->retired[i-k]=ps->retired[i];
+    ps->nretired-=k;
+}
+
+/*
+ * Fonction : si_snapshot_acquire
+ * Description : Fige la dernière version publiée pour un lecteur : réserve une
+ *               case, y annonce l'époque publiée, puis lit la racine publiée
+ *               (de version au moins égale). Tant que le snapshot est tenu,
+ *               aucun nœud de cette version n'est recyclé ni modifié : les
+ *               requêtes sur la racine (si_top_k_by_score, si_range_ids, ...)
+ *               voient un arbre cohérent, sans bloquer l'écrivain.
+ *               Hors mode persistant, retourne simplement idx->root (lecture
+ *               sur le thread écrivain uniquement).
+ * Paramètres :
+ *   - idx : index des stations
+ *   - snap : snapshot à remplir
+ * Retour : Racine du snapshot (NULL si index vide ou aucune case libre :
+ *          snap->slot vaut alors -1)
+ * Complexité temps : O(SI_MAX_READERS) au pire - Complexité espace : O(1)
+ */
+StationNode* si_snapshot_acquire(StationIndex* idx, SiSnapshot* snap){
+    struct SiPersist* ps=idx->persist;
+    snap->slot=-1;
+    snap->root= ps ? 0 : idx->root;
+    if(!ps) return snap->root;
+    for(int i=0;i<SI_MAX_READERS;i++){
+        unsigned long long expected=SLOT_FREE;
+        if(!atomic_compare_exchange_strong(&ps->slots[i].epoch,&expected,SLOT_CLAIMED)) continue;
+        atomic_store(&ps->slots[i].epoch,atomic_load(&ps->epoch));
+        snap->slot=i;
+        snap->root=atomic_load(&ps->root);
+        break;
+    }
+    return snap->root;
+}
+
+/*
+ * Fonction : si_snapshot_release
+ * Description : Rend la case du lecteur ; les nœuds de la version tenue
+ *               pourront être recyclés à la prochaine publication
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+void si_snapshot_release(StationIndex* idx, SiSnapshot* snap){
+    if(idx->persist && snap->slot>=0) atomic_store(&idx->persist->slots[snap->slot].epoch,SLOT_FREE);
+    snap->slot=-1;
+    snap->root=0;
+}
 
 /*
  * Fonction : si_find
@@ -126,102 +942,570 @@ StationNode* si_find(StationNode* r, int id){
 }
 
 /*
- * Fonction auxiliaire récursive : insert_rec
- * Description : Insère ou met à jour une station dans l'AVL de manière récursive
+ * Fonction : si_find_idx
+ * Description : Recherche une station par son ID, quel que soit le backend
  * Paramètres :
- *   - r : racine du sous-arbre courant
- *   - id : identifiant de la station
- *   - in : informations de la station
- * Retour : Nouvelle racine du sous-arbre après insertion et rééquilibrage
- * Complexité temps : O(log n) - Descente récursive + rééquilibrage O(1) par niveau
- * Complexité espace : O(log n) - Pile de récursion de profondeur log(n)
+ *   - idx : index des stations
+ *   - id : identifiant de la station recherchée
+ * Retour : Pointeur vers le nœud (ou l'enregistrement B+) trouvé, ou NULL
+ * Complexité temps : O(log n) - log2(n) nœuds AVL ou log_32(n) nœuds B+
+ *                    O(1) si la table de recherche est active (si_enable_lookup)
+ * Complexité espace : O(1)
  */
-static StationNode* insert_rec(StationNode* r, int id, StationInfo in){
-    if(!r) return mk(id,in);
-    if(id<r->station_id) r->left=insert_rec(r->left,id,in);
-    else if(id>r->station_id) r->right=insert_rec(r->right,id,in);
-    else { r->info=in; return r; } /* Mise à jour si déjà existant */
-    return rebalance(r);
+StationNode* si_find_idx(const StationIndex* idx, int id){
+    if(idx->lookup) return it_get(idx->lookup,id);
+    if(idx->backend==SI_BACKEND_BPTREE) return idx->bp ? bp_find(idx->bp,id) : 0;
+    return si_find(idx->root,id);
 }
 
 /*
- * Fonction : si_add
+ * Fonction auxiliaire : retrace
+ * Description : Remonte un chemin enregistré lors de la descente et rééquilibre
+ *               chaque ancêtre, du plus profond vers la racine.
+ *               Le chemin contient les adresses des liens (champ left/right du
+ *               parent, ou idx->root) menant à chaque nœud, ce qui permet de
+ *               raccrocher directement la nouvelle racine d'un sous-arbre.
+ *               Le rééquilibrage s'arrête dès qu'un sous-arbre retrouve sa
+ *               hauteur d'avant l'opération : les ancêtres restants ne font
+ *               plus que recalculer leurs champs augmentés (refresh_path).
+ * Paramètres :
+ *   - idx : index (copie des nœuds en mode persistant)
+ *   - path : liens des ancêtres (path[0] = &idx->root), nœuds modifiables
+ *   - depth : nombre de liens dans le chemin
+ * Complexité temps : O(log n) - Rotations en O(1) amorti pour l'insertion
+ * Complexité espace : O(1)
+ */
+static void refresh_path(StationNode** path[], int depth);
+
+static void retrace(StationIndex* idx, StationNode** path[], int depth){
+    while(depth>0){
+        StationNode** link=path[--depth];
+        int old_h=(*link)->height;
+        *link=rebalance(idx,*link);
+        if((*link)->height==old_h) break;
+    }
+    refresh_path(path,depth);
+}
+
+/*
+ * Fonction auxiliaire : refresh_path
+ * Description : Recalcule les champs augmentés des ancêtres d'un chemin, du
+ *               plus profond vers la racine, sans rééquilibrer.
+ *               S'arrête au premier ancêtre inchangé : les agrégats d'un nœud
+ *               ne dépendent que de ses enfants et de sa propre station.
+ * Paramètres :
+ *   - path : liens des ancêtres (path[0] = &idx->root)
+ *   - depth : nombre de liens à traiter
+ * Complexité temps : O(log n) au pire
+ * Complexité espace : O(1)
+ */
+static void refresh_path(StationNode** path[], int depth){
+    while(depth>0)
+        if(!upd_aug(*path[--depth])) return;
+}
+
+/*
+ * Fonction auxiliaire : put_station
  * Description : Ajoute ou met à jour une station dans l'index AVL
+ *               Descente itérative unique en mémorisant le chemin, puis
+ *               rééquilibrage ascendant interrompu dès que les hauteurs
+ *               ne changent plus (même arbre que la version récursive)
  * Paramètres :
  *   - idx : index des stations
  *   - id : identifiant de la station
  *   - in : informations de la station
+ * Retour : 1 si réussi, 0 si échec d'allocation (contenu de l'index inchangé)
  * Complexité temps : O(log n) - Insertion dans un AVL équilibré
- * Complexité espace : O(log n) - Pile de récursion
+ * Complexité espace : O(1) - Chemin de taille bornée SI_MAX_DEPTH, pas de récursion
  */
-void si_add(StationIndex* idx, int id, StationInfo in){
-    idx->root=insert_rec(idx->root,id,in);
+static int put_station(StationIndex* idx, int id, StationInfo in){
+    if(idx->backend==SI_BACKEND_BPTREE){
+        BPTree* t=bp_tree(idx);
+        if(!t) return 0;
+        StationNode* rec= idx->lookup ? it_get(idx->lookup,id) : bp_find(t,id);
+        if(rec){
+            StationInfo old=rec->info;
+            rec->info=in;
+            on_change(idx,id,&old,&in);
+            return 1;
+        }
+        rec=mk(idx,id,in);
+        if(!rec) return 0;
+        if(!bp_insert(t,rec)){ pool_release(&idx->pool,rec); return 0; }
+        lookup_put(idx,rec);
+        on_change(idx,id,0,&in);
+        return 1;
+    }
+    StationNode** path[SI_MAX_DEPTH];
+    int depth=0;
+    StationNode** link=&idx->root;
+    while(*link){
+        StationNode* n=cow_at(idx,link);
+        if(!n) return 0;
+        if(id==n->station_id){ /* Mise à jour si déjà existant */
+            StationInfo old=n->info;
+            n->info=in;
+            if(upd_aug(n)) refresh_path(path,depth);
+            on_change(idx,id,&old,&in);
+            return 1;
+        }
+        path[depth++]=link;
+        link= id<n->station_id ? &n->left : &n->right;
+    }
+    StationNode* n=mk(idx,id,in);
+    if(!n) return 0;
+    *link=n;
+    retrace(idx,path,depth);
+    lookup_put(idx,n);
+    on_change(idx,id,0,&in);
+    return 1;
 }
 
 /*
- * Fonction auxiliaire : min_node
- * Description : Trouve le nœud avec l'ID minimum dans un sous-arbre
- *               (nœud le plus à gauche)
- * Paramètre :
- *   - r : racine du sous-arbre
- * Retour : Nœud avec l'ID minimum
- * Complexité temps : O(log n) - Descente vers la gauche
- * Complexité espace : O(1) - Parcours itératif
+ * Fonction : si_add
+ * Description : put_station, échec d'allocation ignoré
+ * Complexité temps : O(log n) - Complexité espace : O(1)
  */
-static StationNode* min_node(StationNode* r){
-    StationNode* c=r;
-    while(c&&c->left) c=c->left;
-    return c;
+void si_add(StationIndex* idx, int id, StationInfo in){
+    put_station(idx,id,in);
 }
 
 /*
- * Fonction auxiliaire récursive : delete_rec
- * Description : Supprime une station de l'AVL de manière récursive
+ * Fonction : si_update
+ * Description : Met à jour une station en place, en une seule descente.
+ *               Station présente : fn modifie directement les informations du
+ *               nœud, puis seuls les agrégats des ancêtres sont recalculés
+ *               (la clé ne change pas : aucune rotation n'est nécessaire).
+ *               Station absente : créée avec *defaults, fn appliquée avant
+ *               l'accrochage, puis rééquilibrage comme si_add. Si defaults
+ *               est NULL, rien n'est créé.
+ *               Remplace le couple si_find + copie + si_add (double descente
+ *               et rééquilibrage de chaque ancêtre).
  * Paramètres :
- *   - r : racine du sous-arbre courant
- *   - id : identifiant de la station à supprimer
- *   - found : pointeur vers un flag indiquant si la suppression a réussi
- * Retour : Nouvelle racine du sous-arbre après suppression et rééquilibrage
- * Complexité temps : O(log n) - Recherche + suppression + rééquilibrage
- * Complexité espace : O(log n) - Pile de récursion
+ *   - idx : index des stations
+ *   - id : identifiant de la station
+ *   - defaults : informations d'une station créée (NULL : pas de création)
+ *   - fn : fonction de modification (NULL : aucune modification)
+ *   - ctx : contexte transmis à fn (ex : l'événement à appliquer)
+ * Retour : Nœud de la station après mise à jour, ou NULL si absente et non
+ *          créée (defaults NULL ou échec d'allocation)
+ * Complexité temps : O(log n) - Une descente + remontée interrompue dès
+ *                    qu'un agrégat ne change plus
+ * Complexité espace : O(1) - Chemin de taille bornée SI_MAX_DEPTH
+ *
+ * Exemple : décrémenter les places libres de la station 1042
+ *   static void take_slot(StationInfo* in, void* ctx){ (void)ctx; in->slots_free--; }
+ *   si_update(&idx, 1042, &defaults, take_slot, NULL);
  */
-static StationNode* delete_rec(StationNode* r, int id, int* found){
-    if(!r) return 0;
-    if(id<r->station_id) r->left=delete_rec(r->left,id,found);
-    else if(id>r->station_id) r->right=delete_rec(r->right,id,found);
-    else{
-        *found=1;
-        // Cas 1 : Nœud feuille (pas d'enfants)
-        if(!r->left && !r->right){ free(r); return 0; }
-        // Cas 2 : Un seul enfant (droite)
-        else if(!r->left){ StationNode* t=r->right; free(r); return t; }
-        // Cas 3 : Un seul enfant (gauche)
-        else if(!r->right){ StationNode* t=r->left;  free(r); return t; }
-        // Cas 4 : Deux enfants - remplacer par le successeur (min du sous-arbre droit)
-        else {
-            StationNode* s=min_node(r->right);
-            r->station_id=s->station_id;
-            r->info=s->info;
-            r->right=delete_rec(r->right,s->station_id,found);
+StationNode* si_update(StationIndex* idx, int id, const StationInfo* defaults,
+                       SiUpdateFn fn, void* ctx){
+    if(idx->backend==SI_BACKEND_BPTREE){
+        BPTree* t=bp_tree(idx);
+        if(!t) return 0;
+        StationNode* rec= idx->lookup ? it_get(idx->lookup,id) : bp_find(t,id);
+        if(rec){
+            if(fn){
+                StationInfo old=rec->info;
+                fn(&rec->info,ctx);
+                on_change(idx,id,&old,&rec->info);
+            }
+            return rec;
+        }
+        if(!defaults) return 0;
+        rec=mk(idx,id,*defaults);
+        if(!rec) return 0;
+        if(fn) fn(&rec->info,ctx);
+        if(!bp_insert(t,rec)){ pool_release(&idx->pool,rec); return 0; }
+        lookup_put(idx,rec);
+        on_change(idx,id,0,&rec->info);
+        return rec;
+    }
+
+    StationNode** path[SI_MAX_DEPTH];
+    int depth=0;
+    StationNode** link=&idx->root;
+    while(*link){
+        StationNode* n=cow_at(idx,link);
+        if(!n) return 0;
+        if(id==n->station_id){
+            if(fn){
+                StationInfo old=n->info;
+                fn(&n->info,ctx);
+                if(upd_aug(n)) refresh_path(path,depth);
+                on_change(idx,id,&old,&n->info);
+            }
+            return n;
         }
+        path[depth++]=link;
+        link= id<n->station_id ? &n->left : &n->right;
     }
-    return rebalance(r);
+    if(!defaults) return 0;
+    StationNode* n=mk(idx,id,*defaults);
+    if(!n) return 0;
+    if(fn){ fn(&n->info,ctx); upd_aug(n); }
+    *link=n;
+    retrace(idx,path,depth);
+    lookup_put(idx,n);
+    on_change(idx,id,0,&n->info);
+    return n;
 }
 
 /*
  * Fonction : si_delete
  * Description : Supprime une station de l'index AVL
+ *               Descente itérative unique : dans le cas à deux enfants, le
+ *               chemin est prolongé jusqu'au successeur (min du sous-arbre droit)
+ *               qui est décroché puis raccroché à la place du nœud supprimé.
+ *               Les nœuds ne sont jamais recopiés : un StationNode* reste
+ *               valide tant que sa station n'est pas supprimée (hors mode
+ *               persistant, où le chemin modifié est recopié).
+ *               Faute de mémoire en mode persistant, rien n'est supprimé.
  * Paramètres :
  *   - idx : index des stations
  *   - id : identifiant de la station à supprimer
  * Retour : 1 si la station a été trouvée et supprimée, 0 sinon
  * Complexité temps : O(log n) - Suppression dans un AVL équilibré
- * Complexité espace : O(log n) - Pile de récursion
+ * Complexité espace : O(1) - Chemin de taille bornée SI_MAX_DEPTH, pas de récursion
  */
 int si_delete(StationIndex* idx, int id){
-    int f=0;
-    idx->root=delete_rec(idx->root,id,&f);
-    return f;
+    if(idx->backend==SI_BACKEND_BPTREE){
+        StationNode* rec= idx->bp ? bp_delete(idx->bp,id) : 0;
+        if(!rec) return 0;
+        if(idx->lookup) it_remove(idx->lookup,id);
+        on_change(idx,id,&rec->info,0);
+        pool_release(&idx->pool,rec);
+        return 1;
+    }
+    StationNode** path[SI_MAX_DEPTH];
+    int depth=0;
+    StationNode** link=&idx->root;
+    while(*link && (*link)->station_id!=id){
+        if(!cow_at(idx,link)) return 0;
+        path[depth++]=link;
+        link= id<(*link)->station_id ? &(*link)->left : &(*link)->right;
+    }
+    StationNode* n=*link;
+    if(!n) return 0;
+
+    // Cas 1 à 3 : au plus un enfant - l'enfant prend la place du nœud
+    if(!n->left || !n->right){
+        *link= n->left ? n->left : n->right;
+    }
+    // Cas 4 : Deux enfants - le successeur (min du sous-arbre droit) prend la place
+    else {
+        // Mode persistant : n et le chemin vers le successeur sont recopiés
+        if(!(n=cow_at(idx,link))) return 0;
+        int at=depth;
+        path[depth++]=link;
+        StationNode** sl=&n->right;
+        while((*sl)->left){
+            if(!cow_at(idx,sl)) return 0;
+            path[depth++]=sl; sl=&(*sl)->left;
+        }
+        StationNode* s=cow(idx,*sl);
+        if(!s) return 0;
+        *sl=s->right;
+        s->left=n->left; s->right=n->right; s->height=n->height;
+        *link=s;
+        // Le lien vers le sous-arbre droit appartient désormais au successeur
+        if(depth>at+1) path[at+1]=&s->right;
+    }
+    if(idx->lookup) it_remove(idx->lookup,id);
+    on_change(idx,id,&n->info,0);
+    drop(idx,n);
+    retrace(idx,path,depth);
+    return 1;
+}
+
+/*
+ * Fonction auxiliaire : entries_sorted
+ * Description : Vérifie si les entrées sont déjà triées strictement par ID
+ *               (cas courant : FRIZI_1001, FRIZI_1002, ...)
+ * Complexité temps : O(n)
+ * Complexité espace : O(1)
+ */
+static int entries_sorted(const StationEntry* e, int n){
+    for(int i=1;i<n;i++) if(e[i-1].station_id>=e[i].station_id) return 0;
+    return 1;
+}
+
+/*
+ * Fonction auxiliaire récursive : merge_sort_entries
+ * Description : Tri fusion STABLE des entrées par ID (l'ordre relatif des
+ *               doublons est conservé, ce qui permet de garder le dernier)
+ * Paramètres :
+ *   - e : entrées à trier
+ *   - tmp : tampon de même taille
+ *   - n : nombre d'entrées
+ * Complexité temps : O(n log n)
+ * Complexité espace : O(log n) - Pile de récursion (tampon fourni)
+ */
+static void merge_sort_entries(StationEntry* e, StationEntry* tmp, int n){
+    if(n<2) return;
+    int m=n/2;
+    merge_sort_entries(e,tmp,m);
+    merge_sort_entries(e+m,tmp,n-m);
+    if(e[m-1].station_id<=e[m].station_id) return; /* déjà dans l'ordre */
+    int i=0, j=m, k=0;
+    while(i<m && j<n) tmp[k++]= e[j].station_id<e[i].station_id ? e[j++] : e[i++];
+    while(i<m) tmp[k++]=e[i++];
+    while(j<n) tmp[k++]=e[j++];
+    for(k=0;k<n;k++) e[k]=tmp[k];
+}
+
+/*
+ * Fonction auxiliaire : dedup_keep_last
+ * Description : Compacte des entrées triées en ne gardant, pour chaque ID,
+ *               que la dernière occurrence (même résultat que des si_add successifs)
+ * Retour : Nombre d'entrées distinctes
+ * Complexité temps : O(n)
+ * Complexité espace : O(1)
+ */
+static int dedup_keep_last(StationEntry* e, int n){
+    int w=0;
+    for(int i=0;i<n;i++){
+        if(w>0 && e[w-1].station_id==e[i].station_id) e[w-1]=e[i];
+        else e[w++]=e[i];
+    }
+    return w;
+}
+
+/*
+ * Fonction auxiliaire récursive : collect_nodes
+ * Description : Range les nœuds de l'arbre dans un tableau, par ID croissant
+ * Complexité temps : O(n) - Complexité espace : O(log n)
+ */
+static int collect_nodes(StationNode* r, StationNode** out, int w){
+    if(!r) return w;
+    w=collect_nodes(r->left,out,w);
+    out[w++]=r;
+    return collect_nodes(r->right,out,w);
+}
+
+/*
+ * Fonction auxiliaire récursive : link_balanced
+ * Description : Raccroche des nœuds triés en arbre parfaitement équilibré
+ *               (le médian devient la racine). Les tailles des deux
+ *               sous-arbres diffèrent d'au plus 1, donc leurs hauteurs aussi :
+ *               l'arbre obtenu est un AVL valide, avec des hauteurs exactes.
+ * Paramètres :
+ *   - nodes : nœuds triés par ID
+ *   - n : nombre de nœuds
+ * Retour : Racine du sous-arbre construit
+ * Complexité temps : O(n) - Chaque nœud est relié une seule fois
+ * Complexité espace : O(log n) - Pile de récursion
+ */
+static StationNode* link_balanced(StationNode** nodes, int n){
+    if(n<=0) return 0;
+    int m=n/2;
+    StationNode* r=nodes[m];
+    r->left=link_balanced(nodes,m);
+    r->right=link_balanced(nodes+m+1,n-m-1);
+    upd(r);
+    return r;
+}
+
+/*
+ * Fonction auxiliaire : bp_build_entries
+ * Description : Chargement en masse d'entrées triées et distinctes dans le
+ *               backend B+ : construction directe si l'arbre est vide,
+ *               insertions successives (ordonnées, donc locales) sinon
+ * Retour : Nombre de stations de l'index, -1 si échec d'allocation (index
+ *          inchangé s'il était vide, sinon entrées précédant l'échec
+ *          chargées)
+ * Complexité temps : O(n) si vide, O(n log m) sinon
+ * Complexité espace : O(n) - Tableau temporaire d'enregistrements
+ */
+static int bp_build_entries(StationIndex* idx, const StationEntry* e, int n){
+    BPTree* t=bp_tree(idx);
+    if(!t) return -1;
+    if(t->count>0){
+        for(int i=0;i<n;i++)
+            if(!put_station(idx,e[i].station_id,e[i].info)) return -1;
+        return t->count;
+    }
+    StationNode** recs=(StationNode**)malloc(sizeof(StationNode*)*(size_t)n);
+    if(!recs) return -1;
+    int w=0;
+    for(; w<n; w++){
+        recs[w]=mk(idx,e[w].station_id,e[w].info);
+        if(!recs[w]) break;
+    }
+    if(w<n || !bp_build(t,recs,n)){
+        while(w>0) pool_release(&idx->pool,recs[--w]);
+        free(recs);
+        return -1;
+    }
+    for(int i=0;i<n;i++){
+        lookup_put(idx,recs[i]);
+        on_change(idx,recs[i]->station_id,0,&recs[i]->info);
+    }
+    free(recs);
+    return t->count;
+}
+
+/*
+ * Fonction : si_build_sorted
+ * Description : Charge en masse un tableau d'entrées dans l'index
+ *               1) Trie les entrées (tri fusion stable) sauf si elles le sont déjà
+ *               2) Élimine les doublons en gardant la dernière occurrence
+ *               3) Index vide ou petit lot face à un gros index : voir ci-dessous
+ *               4) Sinon fusionne les nœuds existants (parcours in-order) et les
+ *                  nouvelles entrées, puis reconstruit un arbre parfaitement
+ *                  équilibré en O(n + m). Une station déjà présente garde son
+ *                  nœud et reçoit les nouvelles informations.
+ *               Quand le lot est petit (n*log2(m) < m), des si_add successifs
+ *               sont moins coûteux qu'une reconstruction : on les utilise.
+ *               Backend B+ : construction niveau par niveau (bp_build) si
+ *               l'index est vide, insertions successives sinon.
+ * Paramètres :
+ *   - idx : index des stations (vide ou non)
+ *   - entries : entrées à charger (réordonnées sur place)
+ *   - n : nombre d'entrées
+ * Retour : Nombre de stations dans l'index après chargement, -1 si échec
+ *          d'allocation : l'index est alors inchangé, sauf par insertions
+ *          individuelles (petit lot, mode persistant, B+ non vide) où les
+ *          entrées qui précèdent l'échec restent chargées
+ * Complexité temps : O(n + m) si trié, O(n log n + m) sinon (m = taille de l'index)
+ * Complexité espace : O(n + m) - Tableau temporaire de pointeurs de nœuds
+ */
+int si_build_sorted(StationIndex* idx, StationEntry* entries, int n){
+    int bptree=idx->backend==SI_BACKEND_BPTREE;
+    int m= bptree ? (idx->bp ? idx->bp->count : 0) : sz(idx->root);
+    if(!entries || n<=0) return m;
+    if(idx->cols) idx->cols->dirty=1; /* reconstruit en O(n + m) à la prochaine requête */
+    idx->version++; /* chargement daté même sans structure annexe à tenir à jour */
+
+    if(!entries_sorted(entries,n)){
+        StationEntry* tmp=(StationEntry*)malloc(sizeof(StationEntry)*(size_t)n);
+        if(!tmp) return -1;
+        merge_sort_entries(entries,tmp,n);
+        free(tmp);
+        n=dedup_keep_last(entries,n);
+    }
+
+    if(bptree) return bp_build_entries(idx,entries,n);
+
+    // Petit lot dans un gros index : insertions individuelles
+    // (de même en mode persistant : les nœuds publiés ne peuvent pas être re-chaînés)
+    int lg=0;
+    while((1<<lg)<m && lg<30) lg++;
+    if(m>0 && (idx->persist || (long)n*lg<m)){
+        for(int i=0;i<n;i++)
+            if(!put_station(idx,entries[i].station_id,entries[i].info)) return -1;
+        return sz(idx->root);
+    }
+
+    StationNode** old=(StationNode**)malloc(sizeof(StationNode*)*(size_t)(m+1));
+    StationNode** all=(StationNode**)malloc(sizeof(StationNode*)*(size_t)(m+n));
+    if(!old || !all){ free(old); free(all); return -1; }
+    collect_nodes(idx->root,old,0);
+
+    // Fusion des nœuds existants et des nouvelles entrées (triés tous les deux)
+    int i=0, j=0, w=0;
+    while(i<m || j<n){
+        if(j>=n || (i<m && old[i]->station_id<entries[j].station_id)){
+            all[w++]=old[i++];
+        }
+        else if(i<m && old[i]->station_id==entries[j].station_id){
+            all[w++]=old[i++];
+            j++;
+        }
+        else {
+            StationNode* nn=mk(idx,entries[j].station_id,entries[j].info);
+            if(!nn){
+                // Échec : rendre les nœuds déjà créés, l'index reste intact
+                for(int k=0, o=0;k<w;k++){
+                    if(o<m && all[k]==old[o]) o++;
+                    else pool_release(&idx->pool,all[k]);
+                }
+                free(old); free(all);
+                return -1;
+            }
+            all[w++]=nn;
+            j++;
+        }
+    }
+    // Application des mises à jour (après coup : l'échec éventuel ne modifie rien)
+    for(i=0,j=0;i<m && j<n;){
+        if(old[i]->station_id<entries[j].station_id) i++;
+        else if(old[i]->station_id>entries[j].station_id) j++;
+        else {
+            StationInfo prev=old[i]->info;
+            old[i]->info=entries[j].info;
+            on_change(idx,entries[j].station_id,&prev,&entries[j].info);
+            i++; j++;
+        }
+    }
+
+    idx->root=link_balanced(all,w);
+    // Table de recherche, index secondaires, vues, index géographique, abonnements et versions
+    // par plage : seuls les nœuds créés sont nouveaux (les autres gardent leur adresse)
+    for(i=0,j=0;i<w && (idx->lookup || idx->attr || idx->views || idx->geo || idx->subs || idx->range_ver);i++){
+        if(j<m && all[i]==old[j]) j++;
+        else {
+            lookup_put(idx,all[i]);
+            on_change(idx,all[i]->station_id,0,&all[i]->info);
+        }
+    }
+    free(old); free(all);
+    return w;
+}
+
+/*
+ * Fonction : si_iter_seek_root
+ * Description : Descente vers lo : chaque nœud d'ID >= lo rencontré est
+ *               empilé (il vient après son sous-arbre gauche) ; le sommet de
+ *               la pile est la première station d'ID >= lo
+ * Paramètres :
+ *   - it : curseur (aucune allocation, libération inutile)
+ *   - root : racine du sous-arbre parcouru
+ *   - lo, hi : plage d'IDs (bornes incluses)
+ * Complexité temps : O(log n) - Complexité espace : O(1) (pile du curseur)
+ */
+void si_iter_seek_root(SiIter* it, StationNode* root, int lo, int hi){
+    it->top=0; it->leaf=0; it->pos=0; it->hi=hi;
+    for(StationNode* n=root; n; ){
+        if(n->station_id>=lo){ it->stack[it->top++]=n; n=n->left; }
+        else n=n->right;
+    }
+}
+
+/*
+ * Fonction : si_iter_seek
+ * Description : si_iter_seek_root sur la racine (AVL), ou position dans la
+ *               feuille du B+ (le parcours suit alors le chaînage des feuilles)
+ * Complexité temps : O(log n) - Complexité espace : O(1)
+ */
+void si_iter_seek(SiIter* it, const StationIndex* idx, int lo, int hi){
+    if(idx->backend!=SI_BACKEND_BPTREE){ si_iter_seek_root(it,idx->root,lo,hi); return; }
+    it->top=0; it->hi=hi;
+    it->leaf= idx->bp ? bp_seek(idx->bp,lo,&it->pos) : 0;
+}
+
+/*
+ * Fonction : si_iter_next
+ * Description : Dépile le suivant et empile la branche gauche de son
+ *               sous-arbre droit (AVL), ou avance dans la feuille (B+).
+ *               Le nœud rendu donne directement les informations de la
+ *               station : pas de si_find à refaire.
+ * Retour : Station suivante, ou NULL si la plage est épuisée
+ * Complexité temps : O(1) amorti (O(log n) au pire pour un pas)
+ * Complexité espace : O(1)
+ */
+StationNode* si_iter_next(SiIter* it){
+    while(it->leaf && it->pos>=it->leaf->nkeys){ it->leaf=it->leaf->leaf.next; it->pos=0; }
+    if(it->leaf){
+        StationNode* r=it->leaf->leaf.recs[it->pos++];
+        if(r->station_id<=it->hi) return r;
+        it->leaf=0;
+        return 0;
+    }
+    if(it->top==0) return 0;
+    StationNode* n=it->stack[--it->top];
+    if(n->station_id>it->hi){ it->top=0; return 0; }
+    for(StationNode* c=n->right; c; c=c->left) it->stack[it->top++]=c;
+    return n;
 }
 
 /*
@@ -245,30 +1529,62 @@ int si_to_array(StationNode* r, int* ids, int cap){
 }
 
 /*
- * Fonction auxiliaire récursive : free_post
- * Description : Libère récursivement tous les nœuds (parcours post-order)
- * Paramètre :
- *   - r : racine du sous-arbre à libérer
- * Complexité temps : O(n) - Visite chaque nœud pour le libérer
- * Complexité espace : O(log n) - Pile de récursion
+ * Fonction : si_to_array_idx
+ * Description : Export trié des IDs, quel que soit le backend
+ *               (parcours in-order de l'AVL ou lecture des feuilles B+ chaînées)
+ * Paramètres :
+ *   - idx : index des stations
+ *   - ids : tableau destination pour les IDs
+ *   - cap : capacité maximale du tableau
+ * Retour : Nombre d'IDs écrits dans le tableau
+ * Complexité temps : O(n)
+ * Complexité espace : O(log n) pour l'AVL, O(1) pour le B+
  */
-static void free_post(StationNode* r){
-    if(!r) return;
-    free_post(r->left);
-    free_post(r->right);
-    free(r);
+int si_to_array_idx(const StationIndex* idx, int* ids, int cap){
+    if(idx->backend==SI_BACKEND_BPTREE) return idx->bp ? bp_to_array(idx->bp,ids,cap) : 0;
+    return si_to_array(idx->root,ids,cap);
 }
 
 /*
  * Fonction : si_clear
  * Description : Libère toute la mémoire de l'index AVL
+ *               Les nœuds vivant dans les slabs de l'allocateur, il suffit de
+ *               rendre les slabs : aucun parcours de l'arbre n'est nécessaire
  * Paramètre :
  *   - idx : index des stations
- * Complexité temps : O(n) - Libération de tous les nœuds
- * Complexité espace : O(log n) - Pile de récursion
+ *               La table de recherche, les index secondaires, les vues top-k,
+ *               l'instantané colonnaire, l'index géographique et les versions
+ *               par plage éventuels sont libérés (désactivés), de même que le
+ *               mode persistant (aucun lecteur ne doit tenir de snapshot)
+ * Complexité temps : O(S) où S = nombre de slabs (indépendant de n en pratique)
+ *                    + O(n / BP_ORDER) pour les nœuds du backend B+
+ * Complexité espace : O(1)
  */
 void si_clear(StationIndex* idx){
-    free_post(idx->root);
+    lookup_drop(idx);
+    attr_drop(idx);
+    cols_drop(idx);
+    geo_drop(idx);
+    free(idx->range_ver);
+    idx->range_ver=0;
+    idx->version++; /* résultats mis en cache avant le vidage : périmés */
+    while(idx->views) si_view_unregister(idx,idx->views);
+    if(idx->subs){
+        rs_clear(idx->subs);
+        free(idx->subs);
+        idx->subs=0;
+    }
+    if(idx->persist){
+        free(idx->persist->retired);
+        free(idx->persist);
+        idx->persist=0;
+    }
+    if(idx->bp){
+        bp_clear(idx->bp);
+        free(idx->bp);
+        idx->bp=0;
+    }
+    pool_destroy(&idx->pool);
     idx->root=0;
 }
 
@@ -326,4 +1642,23 @@ StationNode* si_max(StationNode* r){
         r = r->right;
     }
     return r;
-}
\ No newline at end of file
+}
+
+/*
+ * Fonctions : si_min_idx / si_max_idx
+ * Description : Stations d'ID minimum / maximum, quel que soit le backend
+ * Paramètre :
+ *   - idx : index des stations
+ * Retour : Nœud (ou enregistrement B+) trouvé, ou NULL si index vide
+ * Complexité temps : O(log n)
+ * Complexité espace : O(1)
+ */
+StationNode* si_min_idx(const StationIndex* idx){
+    if(idx->backend==SI_BACKEND_BPTREE) return idx->bp ? bp_min(idx->bp) : 0;
+    return si_min(idx->root);
+}
+
+StationNode* si_max_idx(const StationIndex* idx){
+    if(idx->backend==SI_BACKEND_BPTREE) return idx->bp ? bp_max(idx->bp) : 0;
+    return si_max(idx->root);
+}
@@ -12,36 +12,235 @@ typedef struct StationInfo {
 /* Nœud de l'arbre AVL représentant une station */
 typedef struct StationNode {
     int station_id;             /* identifiant unique de la station */
+    unsigned version;           /* mode persistant : version qui a créé le nœud */
     StationInfo info;           /* informations de la station */
     struct StationNode* left;   /* sous-arbre gauche */
     struct StationNode* right;  /* sous-arbre droit */
     int height;                 /* hauteur du nœud (pour équilibrage AVL) */
+    int size;                   /* nombre de nœuds du sous-arbre (statistiques d'ordre) */
+    int max_power;              /* agrégat du sous-arbre : puissance maximale (kW) */
+    int min_price;              /* agrégat du sous-arbre : prix minimal (centimes) */
+    int max_slots;              /* agrégat du sous-arbre : places libres maximales */
+    long long sum_slots;        /* agrégat du sous-arbre : total des places libres */
 } StationNode;
 
-/* Index des stations implémenté comme un arbre AVL */
+/*
+ * Profondeur maximale d'un chemin racine → feuille.
+ * Un AVL de n nœuds a une hauteur < 1.44*log2(n+2) : 64 niveaux couvrent
+ * largement tout index adressable par des IDs de type int.
+ */
+#define SI_MAX_DEPTH 64
+
+/* Couple (ID, informations) utilisé pour la construction en masse de l'index */
+typedef struct StationEntry {
+    int station_id;    /* identifiant de la station */
+    StationInfo info;  /* informations de la station */
+} StationEntry;
+
+/* Position d'une station (degrés décimaux), pour l'index géographique */
+typedef struct GeoPoint {
+    int station_id;    /* identifiant de la station */
+    double lat;        /* latitude, [-90, 90] */
+    double lon;        /* longitude, [-180, 180] */
+} GeoPoint;
+
+/* Bloc contigu de nœuds (slab) alloué en une seule fois */
+typedef struct NodeSlab {
+    struct NodeSlab* next;  /* slab suivant (liste des slabs de l'index) */
+    int used;               /* nombre de nœuds déjà distribués */
+    int cap;                /* capacité du slab en nœuds */
+    StationNode nodes[];    /* nœuds contigus */
+} NodeSlab;
+
+/* Allocateur de nœuds par slabs avec liste libre (nœuds rendus par si_delete) */
+typedef struct NodePool {
+    NodeSlab* slabs;         /* slabs alloués (le plus récent en tête) */
+    StationNode* free_list;  /* nœuds libérés, chaînés via ->left */
+    int next_cap;            /* capacité du prochain slab */
+} NodePool;
+
+/* Structure de données utilisée par l'index (choisie à l'initialisation) */
+typedef enum SiBackend {
+    SI_BACKEND_AVL = 0,     /* arbre AVL (défaut) */
+    SI_BACKEND_BPTREE = 1   /* arbre B+ à nœuds larges et feuilles chaînées */
+} SiBackend;
+
+/* Attributs des stations disposant d'un index secondaire (voir si_enable_attr_index) */
+typedef enum SiAttr {
+    SI_ATTR_POWER = 0,      /* couples (power_kW, ID) */
+    SI_ATTR_PRICE = 1,      /* couples (price_cents, ID) */
+    SI_ATTR_COUNT = 2
+} SiAttr;
+
+/* Versions par plage d'IDs (voir si_enable_versions) : les IDs sont groupés
+ * par blocs de 2^SI_VER_SHIFT consécutifs, le bloc b partage le compteur
+ * b mod SI_VER_RANGES (puissance de 2) */
+#define SI_VER_SHIFT 6
+#define SI_VER_RANGES 1024
+
+/* Index des stations implémenté comme un arbre AVL (ou B+, voir SiBackend) */
 typedef struct StationIndex {
-    StationNode* root;  /* racine de l'arbre */
+    StationNode* root;  /* racine de l'arbre AVL (NULL avec le backend B+) */
+    NodePool pool;      /* allocateur des nœuds de l'arbre / enregistrements B+ */
+    SiBackend backend;  /* structure utilisée */
+    struct BPTree* bp;  /* arbre B+ (backend SI_BACKEND_BPTREE, créé à la demande) */
+    struct IdTable* lookup; /* table ID → nœud (NULL = désactivée, voir si_enable_lookup) */
+    struct SiPersist* persist; /* mode persistant (NULL = désactivé, voir si_enable_persistent) */
+    struct KeyIndex* attr;  /* index secondaires [SI_ATTR_COUNT] (NULL = désactivés) */
+    struct StationColumns* cols; /* instantané colonnaire (NULL = désactivé, voir si_enable_columns) */
+    struct TopKView* views; /* vues top-k enregistrées (liste, voir si_view_register) */
+    struct GeoIndex* geo;   /* index géographique (NULL = désactivé, voir si_enable_geo) */
+    struct RuleSubs* subs;  /* abonnements aux règles (NULL = aucun, voir si_sub_register) */
+    unsigned uid;           /* identifiant de l'index, unique dans le processus */
+    unsigned long long version; /* nombre d'écritures de stations depuis si_init */
+    unsigned long long* range_ver; /* versions par plage d'IDs (NULL = désactivées) */
 } StationIndex;
 
-/* Initialisation de l'index - O(1) */
+/* Nombre maximal de lecteurs tenant un snapshot en même temps (mode persistant) */
+#define SI_MAX_READERS 64
+
+/* Vue figée de l'index tenue par un lecteur (voir si_snapshot_acquire) */
+typedef struct SiSnapshot {
+    StationNode* root;  /* racine immuable de la version lue */
+    int slot;           /* case de lecteur occupée (-1 : aucune) */
+} SiSnapshot;
+
+/* Profondeur de la pile d'un curseur : hauteur d'un AVL < 1.44 log2(n + 2) <= 45 */
+#define SI_ITER_DEPTH 48
+
+/* Curseur de parcours par ID croissant (voir si_iter_seek) : pile explicite,
+ * aucune allocation. Invalidé par toute écriture dans l'index. */
+typedef struct SiIter {
+    StationNode* stack[SI_ITER_DEPTH]; /* AVL : prochains nœuds (sommet = suivant) */
+    int top;                           /* AVL : hauteur de la pile */
+    struct BPNode* leaf;               /* B+ : feuille courante (NULL si AVL ou fin) */
+    int pos;                           /* B+ : position dans la feuille */
+    int hi;                            /* dernier ID accepté (inclus) */
+} SiIter;
+
+/* Initialisation de l'index (backend AVL) - O(1) */
 void si_init(StationIndex* idx);
 
+/* Initialisation de l'index avec un backend donné - O(1) */
+void si_init_backend(StationIndex* idx, SiBackend backend);
+
+/* Active la table de recherche directe ID → nœud, tenue à jour par toutes les
+ * opérations de l'index : si_find_idx devient O(1) - O(n) pour la construire.
+ * Retour : 1 si active, 0 si échec d'allocation (recherche par l'arbre) */
+int si_enable_lookup(StationIndex* idx);
+
+/* Active les index secondaires (power_kW, ID) et (price_cents, ID), tenus à
+ * jour par toutes les écritures : les filtres de seuil ou de plage sur ces
+ * attributs passent en O(log n + k) - O(n log n) pour les construire.
+ * Retour : 1 si actifs, 0 si échec d'allocation */
+int si_enable_attr_index(StationIndex* idx);
+
+/* Active l'instantané colonnaire (id, slots, power, price) tenu à jour par
+ * toutes les écritures, utilisé par si_top_k_idx - O(n) pour le construire.
+ * Retour : 1 si actif, 0 si échec d'allocation */
+int si_enable_columns(StationIndex* idx);
+
+/* Active (ou reconstruit) l'index géographique des positions pts, dont
+ * places libres et puissance sont tenues à jour par toutes les écritures ;
+ * utilisé par si_nearest_idx et si_within_radius_idx - O(n log n).
+ * Retour : 1 si actif, 0 si échec d'allocation (index précédent conservé) */
+int si_enable_geo(StationIndex* idx, const GeoPoint* pts, int n);
+
+/* Active les versions par plage d'IDs : chaque écriture date le bloc d'IDs
+ * de la station, si_range_version rend la dernière date d'une plage -
+ * O(SI_VER_RANGES). Retour : 1 si actives, 0 si échec d'allocation */
+int si_enable_versions(StationIndex* idx);
+
+/* Version de la plage d'IDs [lo, hi] : valeur de idx->version lors de la
+ * dernière écriture d'une station de la plage (ou d'un bloc qui partage son
+ * compteur) ; sans versions par plage, idx->version - O(log SI_VER_RANGES) */
+unsigned long long si_range_version(const StationIndex* idx, int lo, int hi);
+
+/* Enregistre une vue top-k pour (k, alpha, beta, gamma), tenue à jour en
+ * O(log n) par écriture et lue en O(log n + k) par si_view_read -
+ * O(n log n) pour la construire. Libérée par si_view_unregister ou si_clear.
+ * Retour : vue, ou NULL si échec d'allocation */
+struct TopKView* si_view_register(StationIndex* idx, int k, int alpha, int beta, int gamma);
+
+/* Top-k courant d'une vue, même résultat que si_top_k_by_score avec ses
+ * poids (out_ids de taille k) - O(log n + k). Retour : nombre d'IDs écrits */
+int si_view_read(StationIndex* idx, struct TopKView* v, int* out_ids);
+
+/* Retire et libère une vue - O(n) */
+void si_view_unregister(StationIndex* idx, struct TopKView* v);
+
+/* Active le mode persistant (backend AVL) : les écritures recopient leur
+ * chemin au lieu de modifier les nœuds publiés, et si_publish rend visible
+ * la nouvelle version d'un coup aux lecteurs d'autres threads - O(1).
+ * Un seul thread écrivain. Retour : 1 si actif, 0 sinon */
+int si_enable_persistent(StationIndex* idx);
+
+/* Publication atomique des écritures faites depuis la dernière publication
+ * et recyclage des nœuds qu'aucun snapshot ne peut plus atteindre
+ * (thread écrivain) - O(R + nœuds recyclés), R = nombre de nœuds en attente */
+void si_publish(StationIndex* idx);
+
+/* Lecteur (tout thread) : fige la dernière version publiée. La racine obtenue
+ * s'utilise avec toutes les fonctions qui prennent un StationNode* et reste
+ * valide jusqu'à si_snapshot_release - O(SI_MAX_READERS).
+ * Retour : racine du snapshot (NULL si index vide ou plus de case libre) */
+StationNode* si_snapshot_acquire(StationIndex* idx, SiSnapshot* snap);
+
+/* Lecteur : rend un snapshot (ses nœuds pourront être recyclés) - O(1) */
+void si_snapshot_release(StationIndex* idx, SiSnapshot* snap);
+
 /* Recherche d'une station par ID - O(log n) */
 StationNode* si_find(StationNode* r, int id);
 
+/* Recherche d'une station par ID, quel que soit le backend - O(log n),
+ * O(1) si la table de recherche est active */
+StationNode* si_find_idx(const StationIndex* idx, int id);
+
 /* Ajout ou mise à jour d'une station - O(log n) */
 void si_add(StationIndex* idx, int id, StationInfo in);
 
+/* Modification en place d'une station (voir si_update) */
+typedef void (*SiUpdateFn)(StationInfo* info, void* ctx);
+
+/* Mise à jour en place en une seule descente : fn modifie les informations de
+ * la station ; si elle est absente, elle est créée avec *defaults (puis fn est
+ * appliquée), ou ignorée si defaults est NULL - O(log n), sans rééquilibrage
+ * quand la station existe. Retour : nœud de la station, ou NULL */
+StationNode* si_update(StationIndex* idx, int id, const StationInfo* defaults,
+                       SiUpdateFn fn, void* ctx);
+
 /* Suppression d'une station - O(log n) */
 int si_delete(StationIndex* idx, int id);
 
+/* Construction en masse depuis un tableau (trié ou non, doublons : le dernier
+ * l'emporte), fusionnée avec le contenu existant - O(n + m) si trié,
+ * O(n log n + m) sinon. Retourne le nombre de stations de l'index, -1 si échec
+ * d'allocation (index inchangé, sauf petit lot inséré un à un : entrées qui
+ * précèdent l'échec chargées) */
+int si_build_sorted(StationIndex* idx, StationEntry* entries, int n);
+
+/* Positionne un curseur sur la première station d'ID >= lo ; si_iter_next
+ * rendra ensuite les stations d'ID dans [lo, hi] par ID croissant - O(log n).
+ * Pagination : garder le curseur entre deux pages, ou, après des écritures,
+ * repositionner un nouveau curseur à (dernier ID rendu + 1) */
+void si_iter_seek(SiIter* it, const StationIndex* idx, int lo, int hi);
+
+/* Idem sur un sous-arbre AVL quelconque (ex. racine d'un snapshot) - O(log n) */
+void si_iter_seek_root(SiIter* it, StationNode* root, int lo, int hi);
+
+/* Station suivante du curseur, ou NULL en fin de plage - O(1) amorti */
+StationNode* si_iter_next(SiIter* it);
+
 /* Conversion en tableau trié (parcours in-order) - O(n) */
 int si_to_array(StationNode* r, int* ids, int cap);
 
+/* Conversion en tableau trié, quel que soit le backend - O(n) */
+int si_to_array_idx(const StationIndex* idx, int* ids, int cap);
+
 /* Affichage visuel de l'arbre (debug) - O(n) */
 void si_print_sideways(StationNode* r);
 
-/* Libération de la mémoire - O(n) */
+/* Libération de la mémoire - O(S), S = nombre de slabs */
 void si_clear(StationIndex* idx);
 
 /* Trouve la station avec l'ID minimum - O(log n) */
@@ -50,4 +249,8 @@ StationNode* si_min(StationNode* r);
 /* Trouve la station avec l'ID maximum - O(log n) */
 StationNode* si_max(StationNode* r);
 
+/* Stations d'ID minimum / maximum, quel que soit le backend - O(log n) */
+StationNode* si_min_idx(const StationIndex* idx);
+StationNode* si_max_idx(const StationIndex* idx);
+
 #endif
\ No newline at end of file
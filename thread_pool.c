@@ -0,0 +1,147 @@
+#include "thread_pool.h"
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+struct ThreadPool {
+    int nworkers;               /* threads créés (nthreads - 1) */
+    pthread_t* th;
+    pthread_mutex_t mu;
+    pthread_cond_t wake;        /* nouveau lot ou arrêt */
+    pthread_cond_t done;        /* tous les threads ont fini le lot */
+    /* Lot courant : écrit sous mu avant gen++, stable jusqu'à la fin du lot */
+    TpTaskFn fn;
+    void* ctx;
+    int ntasks;
+    atomic_int next;            /* prochaine tâche à prendre */
+    unsigned long gen;          /* numéro du lot courant */
+    int finished;               /* threads ayant fini le lot courant */
+    int stop;
+};
+
+/*
+ * Fonction auxiliaire : drain
+ * Description : Prend et exécute des tâches du lot courant jusqu'à épuisement
+ * Complexité temps : O(tâches prises) - Complexité espace : O(1)
+ */
+static void drain(ThreadPool* p){
+    int t;
+    while((t=atomic_fetch_add_explicit(&p->next,1,memory_order_relaxed))<p->ntasks) p->fn(p->ctx,t);
+}
+
+/*
+ * Fonction auxiliaire : worker
+ * Description : Boucle d'un thread du pool : attend un lot, y participe,
+ *               signale sa fin. Chaque thread participe à chaque lot, ce qui
+ *               garantit qu'aucun ne lit encore un lot terminé quand
+ *               l'appelant en publie un nouveau.
+ */
+static void* worker(void* arg){
+    ThreadPool* p=(ThreadPool*)arg;
+    unsigned long seen=0;
+    pthread_mutex_lock(&p->mu);
+    for(;;){
+        while(!p->stop && p->gen==seen) pthread_cond_wait(&p->wake,&p->mu);
+        if(p->stop) break;
+        seen=p->gen;
+        pthread_mutex_unlock(&p->mu);
+        drain(p);
+        pthread_mutex_lock(&p->mu);
+        if(++p->finished==p->nworkers) pthread_cond_signal(&p->done);
+    }
+    pthread_mutex_unlock(&p->mu);
+    return 0;
+}
+
+/*
+ * Fonction auxiliaire : pool_stop
+ * Description : Arrête et attend les n premiers threads
+ */
+static void pool_stop(ThreadPool* p, int n){
+    pthread_mutex_lock(&p->mu);
+    p->stop=1;
+    pthread_cond_broadcast(&p->wake);
+    pthread_mutex_unlock(&p->mu);
+    for(int i=0;i<n;i++) pthread_join(p->th[i],0);
+}
+
+/*
+ * Fonction : tp_create
+ * Description : Crée le pool et ses nthreads - 1 threads (endormis)
+ * Retour : Pool, ou NULL si échec (rien n'est alors conservé)
+ * Complexité temps : O(nthreads) - Complexité espace : O(nthreads)
+ */
+ThreadPool* tp_create(int nthreads){
+    if(nthreads<1) nthreads=1;
+    ThreadPool* p=(ThreadPool*)calloc(1,sizeof(ThreadPool));
+    if(!p) return 0;
+    p->th=(pthread_t*)malloc(sizeof(pthread_t)*(size_t)nthreads);
+    if(!p->th){ free(p); return 0; }
+    pthread_mutex_init(&p->mu,0);
+    pthread_cond_init(&p->wake,0);
+    pthread_cond_init(&p->done,0);
+    atomic_init(&p->next,0);
+    for(int i=0;i<nthreads-1;i++){
+        if(pthread_create(&p->th[i],0,worker,p)!=0){
+            pool_stop(p,i);
+            p->nworkers=0;
+            tp_destroy(p);
+            return 0;
+        }
+        p->nworkers++;
+    }
+    return p;
+}
+
+/*
+ * Fonction : tp_threads
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+int tp_threads(const ThreadPool* p){
+    return p ? p->nworkers+1 : 1;
+}
+
+/*
+ * Fonction : tp_run
+ * Description : Publie le lot, y participe, attend la fin des autres threads
+ * Paramètres :
+ *   - p : pool (NULL : exécution séquentielle)
+ *   - fn, ctx : tâche et son contexte, partagé par toutes les tâches
+ *   - ntasks : nombre de tâches
+ * Complexité temps : O(ntasks / nthreads) tâches par thread si équilibré
+ * Complexité espace : O(1)
+ */
+void tp_run(ThreadPool* p, TpTaskFn fn, void* ctx, int ntasks){
+    if(ntasks<=0) return;
+    if(!p || p->nworkers==0 || ntasks==1){
+        for(int t=0;t<ntasks;t++) fn(ctx,t);
+        return;
+    }
+    pthread_mutex_lock(&p->mu);
+    p->fn=fn; p->ctx=ctx; p->ntasks=ntasks;
+    atomic_store_explicit(&p->next,0,memory_order_relaxed);
+    p->finished=0;
+    p->gen++;
+    pthread_cond_broadcast(&p->wake);
+    pthread_mutex_unlock(&p->mu);
+
+    drain(p);
+
+    pthread_mutex_lock(&p->mu);
+    while(p->finished<p->nworkers) pthread_cond_wait(&p->done,&p->mu);
+    pthread_mutex_unlock(&p->mu);
+}
+
+/*
+ * Fonction : tp_destroy
+ * Complexité temps : O(nthreads) - Complexité espace : O(1)
+ */
+void tp_destroy(ThreadPool* p){
+    if(!p) return;
+    if(p->nworkers>0) pool_stop(p,p->nworkers);
+    pthread_mutex_destroy(&p->mu);
+    pthread_cond_destroy(&p->wake);
+    pthread_cond_destroy(&p->done);
+    free(p->th);
+    free(p);
+}
@@ -0,0 +1,38 @@
+#ifndef DS_THREAD_POOL_H
+#define DS_THREAD_POOL_H
+
+/*
+ * ============================================================================
+ * POOL DE THREADS RÉUTILISABLE
+ * ============================================================================
+ *
+ * Threads créés une fois (tp_create) puis réveillés à chaque lot de tâches
+ * (tp_run) : une requête parallèle ne paie ni création ni destruction de
+ * threads. Un lot = ntasks appels fn(ctx, t), t dans [0, ntasks), distribués
+ * dynamiquement (compteur atomique) entre les threads du pool et l'appelant,
+ * qui participe. tp_run rend la main quand toutes les tâches sont terminées.
+ * Un pool ne sert qu'un appelant à la fois.
+ */
+
+/* Tâche d'un lot : t = numéro de la tâche */
+typedef void (*TpTaskFn)(void* ctx, int t);
+
+/* Pool (structure opaque) */
+typedef struct ThreadPool ThreadPool;
+
+/* Création d'un pool de nthreads threads au total, appelant compris
+ * (nthreads - 1 threads créés) - O(nthreads)
+ * Retour : pool, ou NULL si échec (allocation, création de thread) */
+ThreadPool* tp_create(int nthreads);
+
+/* Nombre de threads du pool, appelant compris (1 si pool NULL) - O(1) */
+int tp_threads(const ThreadPool* p);
+
+/* Exécution d'un lot de ntasks tâches, bloquante - O(ntasks) tâches
+ * Pool NULL : tâches exécutées en séquence par l'appelant */
+void tp_run(ThreadPool* p, TpTaskFn fn, void* ctx, int ntasks);
+
+/* Arrêt des threads et libération du pool (NULL accepté) - O(nthreads) */
+void tp_destroy(ThreadPool* p);
+
+#endif
@@ -0,0 +1,65 @@
+#include "topk_view.h"
+#include <limits.h>
+
+/*
+ * Fonction auxiliaire : view_key
+ * Description : Clé d'une station : ~score (= -score - 1), croissante quand le
+ *               score décroît, définie pour tout score
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+static int view_key(const TopKView* v, const StationInfo* in){
+    return ~(in->slots_free*v->alpha+in->power_kW*v->beta-in->price_cents*v->gamma);
+}
+
+/*
+ * Fonction : tv_init
+ * Complexité temps : O(1) - Complexité espace : O(1)
+ */
+void tv_init(TopKView* v, int k, int alpha, int beta, int gamma){
+    v->k=k; v->alpha=alpha; v->beta=beta; v->gamma=gamma;
+    ki_init(&v->order);
+    v->dirty=0;
+    v->next=0;
+}
+
+/*
+ * Fonction : tv_change
+ * Description : Déplace le couple de la station (ki_move : le nœud est
+ *               réutilisé). Un événement qui ne change pas le score
+ *               (ex. last_ts seul) ne coûte qu'une comparaison.
+ * Retour : 1 si réussi, 0 si échec d'allocation
+ * Complexité temps : O(log n) - Complexité espace : O(log n) (récursion)
+ */
+int tv_change(TopKView* v, int id, const StationInfo* old, const StationInfo* in){
+    if(v->dirty) return 1;
+    int ok=1;
+    if(old && in){
+        int ko=view_key(v,old), kn=view_key(v,in);
+        if(ko!=kn) ok=ki_move(&v->order,ko,kn,id);
+    }
+    else if(old) ki_delete(&v->order,view_key(v,old),id);
+    else if(in) ok=ki_insert(&v->order,view_key(v,in),id);
+    if(!ok){
+        ki_clear(&v->order);
+        v->dirty=1;
+    }
+    return ok;
+}
+
+/*
+ * Fonction : tv_read
+ * Description : Les k premiers couples de l'ordre (~score, ID)
+ * Complexité temps : O(log n + k) - Complexité espace : O(log n)
+ */
+int tv_read(const TopKView* v, int* out_ids){
+    if(v->dirty || v->k<=0 || !out_ids) return 0;
+    return ki_range_ids(&v->order,INT_MIN,INT_MAX,out_ids,v->k);
+}
+
+/*
+ * Fonction : tv_clear
+ * Complexité temps : O(n) - Complexité espace : O(log n)
+ */
+void tv_clear(TopKView* v){
+    ki_clear(&v->order);
+}
@@ -0,0 +1,44 @@
+#ifndef DS_TOPK_VIEW_H
+#define DS_TOPK_VIEW_H
+#include "station_index.h"
+#include "key_index.h"
+
+/*
+ * ============================================================================
+ * VUE TOP-K MAINTENUE (k, alpha, beta, gamma FIXÉS)
+ * ============================================================================
+ *
+ * Toutes les stations rangées par score décroissant puis ID croissant (ordre
+ * de si_top_k_by_score), dans un index ordonné (KeyIndex) de couples
+ * (~score, ID) : le complément à un inverse l'ordre des scores sans
+ * débordement. Un changement de places libres ou de prix déplace un seul
+ * couple (O(log n)) ; la lecture prend les k premiers couples (O(log n + k)),
+ * sans parcours de l'index des stations.
+ * Enregistrée sur un index (si_view_register), qui la tient à jour.
+ */
+
+/* Vue top-k */
+typedef struct TopKView {
+    int k;                      /* nombre de stations lues */
+    int alpha, beta, gamma;     /* poids du score */
+    KeyIndex order;             /* couples (~score, ID) de toutes les stations */
+    int dirty;                  /* 1 : à reconstruire (échec d'allocation) */
+    struct TopKView* next;      /* vue suivante enregistrée sur le même index */
+} TopKView;
+
+/* Initialisation d'une vue vide - O(1) */
+void tv_init(TopKView* v, int k, int alpha, int beta, int gamma);
+
+/* Répercussion d'une modification de station (old NULL : création,
+ * in NULL : suppression) - O(log n), rien si le score ne change pas.
+ * Retour : 1 si réussi, 0 si échec d'allocation (vue vidée et marquée à reconstruire) */
+int tv_change(TopKView* v, int id, const StationInfo* old, const StationInfo* in);
+
+/* Lecture du top-k : IDs par score décroissant puis ID croissant
+ * (out_ids de taille k) - O(log n + k). Retour : nombre d'IDs écrits */
+int tv_read(const TopKView* v, int* out_ids);
+
+/* Libération des couples (vue vide, réutilisable) - O(n) */
+void tv_clear(TopKView* v);
+
+#endif